@@ -0,0 +1,222 @@
+/*
+ * Matching under a time budget. See AnytimeMatching.h.
+ */
+
+#include "AnytimeMatching.h"
+#include <algorithm>
+#include <chrono>
+#include "Arena.h"
+#include "ComponentMatching.h"
+#include "MatchingScore.h"
+#include "SmallGroupMatching.h"
+#include "WeightedBlossomMatching.h"
+using namespace std;
+
+AnytimeResult anytimeMaximumWeightMatchingById(const CompactGraph& graph, const AnytimeOptions& options,
+                                               SolverStats* stats) {
+    auto start = chrono::steady_clock::now();
+    auto elapsed = [&] {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    auto shouldStop = [&] {
+        return (options.cancel != nullptr && options.cancel->load(memory_order_relaxed)) ||
+               (options.maxSeconds > 0 && elapsed() > options.maxSeconds);
+    };
+
+    ApproximateOptions heuristic = options.heuristic;
+    if (options.maxSeconds > 0 && (heuristic.maxSeconds <= 0 || heuristic.maxSeconds > options.maxSeconds)) {
+        heuristic.maxSeconds = options.maxSeconds;
+    }
+    ApproximateResult first = approximateMaximumWeightMatchingById(graph, heuristic, stats);
+
+    AnytimeResult result;
+    result.upperBound = first.upperBound;
+    MatchingScore best(graph);
+    best.assign(first.mates);
+
+    auto report = [&](bool optimal) {
+        result.optimal = optimal;
+        result.weight = best.total();
+        if (optimal) result.upperBound = result.weight;
+        result.seconds = elapsed();
+        if (options.onImprovement) {
+            result.mates = best.mates();
+            options.onImprovement(graph, result);
+        }
+    };
+    report(best.total() == first.upperBound);
+
+    /* Smallest groups first: they finish quickly, so the matching keeps improving. */
+    GraphComponents components(graph);
+    vector<int> order;
+    for (int c = 0; c < components.numComponents() && !result.optimal; c++) {
+        if (components.size(c) > 2) order.push_back(c);
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return components.size(a) < components.size(b);
+    });
+
+    Arena workspace;
+    size_t numSolved = 0;
+    for (int c: order) {
+        if (shouldStop()) break;
+
+        CompactGraph group = components.subgraph(c);
+        vector<int> local;
+        long long weight;
+        bool finished = true;
+        if (int(group.numPeople()) <= kSmallGroupAutoLimit) {
+            SmallGroupMatching engine(group, workspace);
+            engine.setStats(stats);
+            weight = engine.solve();
+            local = engine.mates();
+        } else {
+            WeightedBlossomMatching engine(group, workspace);
+            engine.setStats(stats);
+            engine.setStopCondition(shouldStop);
+            weight = engine.solve();
+            local = engine.mates();
+            finished = engine.finished();
+        }
+        workspace.reset();
+        if (finished) numSolved++;
+
+        /* Everyone in the group is paired within it, so this counts each pair twice. */
+        const uint32_t* members = components.membersBegin(c);
+        long long current = 0;
+        for (size_t i = 0; i < local.size(); i++) {
+            current += best.pairWeight(members[i]);
+        }
+        if (weight <= current / 2) continue;
+
+        for (size_t i = 0; i < local.size(); i++) {
+            best.remove(members[i]);
+        }
+        for (size_t i = 0; i < local.size(); i++) {
+            if (local[i] > int(i)) best.add(members[i], members[local[i]]);
+        }
+        result.improvements++;
+        report(numSolved == order.size());
+    }
+
+    result.optimal = result.optimal || numSolved == order.size();
+    result.weight = best.total();
+    if (result.optimal) result.upperBound = result.weight;
+    result.mates = best.mates();
+    result.seconds = elapsed();
+    return result;
+}
+
+Set<Pair> anytimeMaximumWeightMatching(const Map<string, Map<string, int>>& possibleLinks,
+                                       const AnytimeOptions& options, AnytimeResult* result) {
+    CompactGraph graph = CompactGraph::fromWeightedLinks(possibleLinks);
+    AnytimeResult found = anytimeMaximumWeightMatchingById(graph, options);
+    Set<Pair> pairs = graph.toPairs(found.mates);
+    if (result != nullptr) *result = move(found);
+    return pairs;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "Matchmaker.h"
+#include "GUI/SimpleTest.h"
+
+namespace {
+    /* Several groups, each a random graph, so there is plenty for the exact solvers to fix. */
+    CompactGraph randomGroups(mt19937& generator, int numGroups, int groupSize) {
+        CompactGraphBuilder builder;
+        for (int i = 0; i < numGroups * groupSize; i++) {
+            builder.intern(to_string(1000 + i));
+        }
+        for (int g = 0; g < numGroups; g++) {
+            for (int u = 0; u < groupSize; u++) {
+                for (int v = u + 1; v < groupSize; v++) {
+                    if (generator() % 4 == 0) {
+                        builder.addLink(g * groupSize + u, g * groupSize + v, int(generator() % 30) + 1);
+                    }
+                }
+            }
+        }
+        return builder.build();
+    }
+
+    long long matchingWeight(const CompactGraph& graph, const vector<int>& mate) {
+        MatchingScore score(graph);
+        score.assign(mate);
+        return score.total();
+    }
+}
+
+STUDENT_TEST("With time to spare, the anytime solver proves its matching optimal") {
+    mt19937 generator(17);
+    CompactGraph graph = randomGroups(generator, 6, 40);
+
+    vector<long long> seen;
+    AnytimeOptions options;
+    options.onImprovement = [&](const CompactGraph& g, const AnytimeResult& best) {
+        EXPECT_EQUAL(matchingWeight(g, best.mates), best.weight);
+        seen.push_back(best.weight);
+    };
+    AnytimeResult result = anytimeMaximumWeightMatchingById(graph, options);
+
+    EXPECT(result.optimal);
+    EXPECT_EQUAL(result.weight, matchingWeight(graph, maximumWeightMatchingById(graph)));
+    EXPECT_EQUAL(result.upperBound, result.weight);
+    EXPECT_EQUAL(matchingWeight(graph, result.mates), result.weight);
+
+    /* One report for the heuristic, then one per improvement, each better than the last. */
+    EXPECT_EQUAL(int(seen.size()), result.improvements + 1);
+    EXPECT(is_sorted(seen.begin(), seen.end()));
+    EXPECT(adjacent_find(seen.begin(), seen.end()) == seen.end());
+    EXPECT_EQUAL(seen.back(), result.weight);
+}
+
+STUDENT_TEST("Cancelling the anytime solver still returns a valid matching") {
+    mt19937 generator(19);
+    CompactGraph graph = randomGroups(generator, 6, 40);
+
+    atomic<bool> cancel { true };
+    AnytimeOptions options;
+    options.cancel = &cancel;
+    AnytimeResult result = anytimeMaximumWeightMatchingById(graph, options);
+
+    EXPECT_EQUAL(result.improvements, 0);
+    EXPECT_EQUAL(matchingWeight(graph, result.mates), result.weight);
+    EXPECT(result.weight <= result.upperBound);
+    EXPECT(2 * result.weight >= matchingWeight(graph, maximumWeightMatchingById(graph)));
+    EXPECT_EQUAL(result.optimal, result.weight == result.upperBound);
+}
+
+STUDENT_TEST("A blossom solver told to stop leaves a valid, unfinished matching") {
+    mt19937 generator(23);
+    CompactGraph graph = randomGroups(generator, 1, 60);
+
+    int stagesLeft = 3;
+    WeightedBlossomMatching engine(graph);
+    engine.setStopCondition([&] {
+        return stagesLeft-- == 0;
+    });
+    long long weight = engine.solve();
+    EXPECT(!engine.finished());
+    EXPECT_EQUAL(matchingWeight(graph, engine.mates()), weight);
+
+    WeightedBlossomMatching whole(graph);
+    EXPECT(whole.solve() > weight);
+    EXPECT(whole.finished());
+}
+
+STUDENT_TEST("anytimeMaximumWeightMatching agrees with maximumWeightMatching given time") {
+    Map<string, Map<string, int>> links = {
+        { "A", { { "B", 3 } } },
+        { "B", { { "A", 3 }, { "C", 4 } } },
+        { "C", { { "B", 4 }, { "D", 3 } } },
+        { "D", { { "C", 3 } } },
+        { "E", {} },
+    };
+    AnytimeResult result;
+    EXPECT_EQUAL(anytimeMaximumWeightMatching(links, AnytimeOptions(), &result), maximumWeightMatching(links));
+    EXPECT(result.optimal);
+    EXPECT_EQUAL(anytimeMaximumWeightMatching({}), {});
+}
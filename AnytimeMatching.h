@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ApproximateMatching.h"
+#include "CompactGraph.h"
+#include "SolverStats.h"
+#include "map.h"
+#include "set.h"
+
+/* The best matching found so far by anytimeMaximumWeightMatchingById. */
+struct AnytimeResult {
+    std::vector<int> mates;
+    long long weight = 0;
+    long long upperBound = 0;   // No matching weighs more than this.
+    bool      optimal = false;  // Proven to be a maximum-weight matching.
+    int       improvements = 0; // Times a better matching was found after the first.
+    double    seconds = 0;
+};
+
+/* Called with the graph and the new best matching each time one is found; use
+ * graph.toPairs(best.mates) for names. Runs on the solving thread, so it should be
+ * quick.
+ */
+using ImprovementCallback = std::function<void(const CompactGraph& graph, const AnytimeResult& best)>;
+
+struct AnytimeOptions {
+    /* Give up proving optimality after this long, if positive, and return the best
+     * matching so far. The first matching, from the heuristic, is always finished,
+     * so very short budgets can run over by the time that takes.
+     */
+    double maxSeconds = 0;
+
+    /* Optional. Solving stops soon after another thread sets this to true. */
+    const std::atomic<bool>* cancel = nullptr;
+
+    /* Optional. See ImprovementCallback. */
+    ImprovementCallback onImprovement;
+
+    /* How hard to try for a good first matching. One round of local search is
+     * most of the benefit, and the exact solvers take it from there.
+     */
+    ApproximateOptions heuristic = [] {
+        ApproximateOptions options;
+        options.maxRounds = 1;
+        return options;
+    }();
+};
+
+/* A maximum-weight matching that can be asked to stop at any time, returning the
+ * best matching found so far and whether it is known to be the best possible.
+ *
+ * The first matching comes from approximateMaximumWeightMatchingById, which is
+ * fast. Then each connected group is solved exactly, smallest first so that the
+ * matching keeps improving while time allows, and replaces the heuristic's pairs
+ * for that group whenever it weighs more. A stop is noticed between groups, and by
+ * the blossom solver between stages, whose partial matching is kept if it happens
+ * to be heavier.
+ *
+ * The matching is optimal once every group has been solved to the end.
+ */
+AnytimeResult anytimeMaximumWeightMatchingById(const CompactGraph& graph,
+                                               const AnytimeOptions& options = AnytimeOptions(),
+                                               SolverStats* stats = nullptr);
+
+/* Convenience wrapper for callers holding a preference map. If result is given, it
+ * receives the details, including whether the matching is optimal.
+ */
+Set<Pair> anytimeMaximumWeightMatching(const Map<std::string, Map<std::string, int>>& possibleLinks,
+                                       const AnytimeOptions& options = AnytimeOptions(),
+                                       AnytimeResult* result = nullptr);
@@ -0,0 +1,252 @@
+/*
+ * Greedy matching with local search. See ApproximateMatching.h.
+ */
+
+#include "ApproximateMatching.h"
+#include <algorithm>
+#include <chrono>
+#include "MatchingScore.h"
+using namespace std;
+
+namespace {
+    /* A link u -- neighboursBegin(u)[index], stored once, from its lower id. */
+    struct Candidate {
+        int32_t  weight;
+        uint32_t u;
+        uint32_t index;
+    };
+
+    /* The two heaviest links from someone to people who are free, other than the two
+     * people being paired up.
+     */
+    struct FreeChoices {
+        int32_t  weight[2] = { 0, 0 };
+        uint32_t index[2]  = { 0, 0 };
+        int      person[2] = { -1, -1 };
+    };
+
+    FreeChoices freeChoices(const CompactGraph& graph, const MatchingScore& score,
+                            int p, uint32_t u, uint32_t v) {
+        FreeChoices best;
+        if (p == -1) return best;
+
+        const uint32_t* neighbours = graph.neighboursBegin(p);
+        const int32_t*  weights    = graph.weightsBegin(p);
+        for (uint32_t i = 0; i < graph.degree(p); i++) {
+            uint32_t x = neighbours[i];
+            if (weights[i] <= best.weight[1] || score.mate(x) != -1 || x == u || x == v) continue;
+
+            int slot = weights[i] > best.weight[0] ? 0 : 1;
+            if (slot == 0) {
+                best.weight[1] = best.weight[0];
+                best.index[1]  = best.index[0];
+                best.person[1] = best.person[0];
+            }
+            best.weight[slot] = weights[i];
+            best.index[slot]  = i;
+            best.person[slot] = int(x);
+        }
+        return best;
+    }
+}
+
+ApproximateResult approximateMaximumWeightMatchingById(const CompactGraph& graph,
+                                                       const ApproximateOptions& options,
+                                                       SolverStats* stats) {
+    StatsTimer timer(stats, &SolverStats::secondsSolving);
+    auto start = chrono::steady_clock::now();
+    auto elapsed = [&] {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    uint32_t n = graph.numPeople();
+    vector<Candidate> candidates;
+    candidates.reserve(graph.numLinks());
+    vector<int32_t> heaviest(n, 0);
+    for (uint32_t u = 0; u < n; u++) {
+        const uint32_t* neighbours = graph.neighboursBegin(u);
+        const int32_t*  weights    = graph.weightsBegin(u);
+        for (uint32_t i = 0; i < graph.degree(u); i++) {
+            if (weights[i] <= 0) continue;
+            heaviest[u] = max(heaviest[u], weights[i]);
+            if (u < neighbours[i]) candidates.push_back({ weights[i], u, i });
+        }
+    }
+
+    /* Heaviest first; ties in id order, so the answer doesn't depend on the sort. */
+    sort(candidates.begin(), candidates.end(), [](const Candidate& lhs, const Candidate& rhs) {
+        if (lhs.weight != rhs.weight) return lhs.weight > rhs.weight;
+        if (lhs.u != rhs.u) return lhs.u < rhs.u;
+        return lhs.index < rhs.index;
+    });
+
+    ApproximateResult result;
+    long long halfOfHeaviest = 0;
+    for (int32_t weight: heaviest) {
+        halfOfHeaviest += weight;
+    }
+    long long topLinks = 0;
+    for (size_t i = 0; i < candidates.size() && i < n / 2; i++) {
+        topLinks += candidates[i].weight;
+    }
+    result.upperBound = min(halfOfHeaviest / 2, topLinks);
+
+    MatchingScore score(graph);
+    for (const Candidate& link: candidates) {
+        uint32_t v = graph.neighboursBegin(link.u)[link.index];
+        if (score.mate(link.u) == -1 && score.mate(v) == -1) score.addNeighbour(link.u, link.index);
+    }
+    result.greedyWeight = score.total();
+
+    /* Local search. Pairing u with v leaves their old partners u2 and v2 free; the
+     * move is worth the link, less the two pairs broken, plus the better of pairing
+     * u2 with v2 or each of them with someone who is free now.
+     */
+    bool outOfTime = false;
+    while (result.rounds < options.maxRounds && !outOfTime) {
+        result.rounds++;
+        int moves = 0;
+        for (size_t c = 0; c < candidates.size(); c++) {
+            if (options.maxSeconds > 0 && c % 4096 == 0 && elapsed() > options.maxSeconds) {
+                outOfTime = true;
+                break;
+            }
+
+            const Candidate& link = candidates[c];
+            uint32_t u = link.u;
+            uint32_t v = graph.neighboursBegin(u)[link.index];
+            long long gain = score.pairingGain(u, v, link.weight);
+            int u2 = score.mate(u);
+            int v2 = score.mate(v);
+
+            /* Nothing the old partners do can make up the difference. */
+            long long mostBack = (u2 == -1 ? 0 : heaviest[u2]) + (v2 == -1 ? 0 : heaviest[v2]);
+            if (u2 == int(v) || gain + mostBack <= 0) continue;
+
+            long long swapGain = 0;
+            if (u2 != -1 && v2 != -1) swapGain = max(0, graph.weight(u2, v2));
+
+            FreeChoices fromU = freeChoices(graph, score, u2, u, v);
+            FreeChoices fromV = freeChoices(graph, score, v2, u, v);
+            int pickU = 0, pickV = 0;
+            if (fromU.person[0] != -1 && fromU.person[0] == fromV.person[0]) {
+                /* Both want the same person; one of them settles for their second choice. */
+                if (fromU.weight[0] + fromV.weight[1] >= fromU.weight[1] + fromV.weight[0]) {
+                    pickV = 1;
+                } else {
+                    pickU = 1;
+                }
+            }
+            long long freeGain = (long long)fromU.weight[pickU] + fromV.weight[pickV];
+
+            if (gain + max(swapGain, freeGain) <= 0) continue;
+
+            score.remove(u);
+            score.remove(v);
+            score.addNeighbour(u, link.index);
+            if (swapGain >= freeGain) {
+                if (swapGain > 0) score.add(u2, v2);
+            } else {
+                if (fromU.person[pickU] != -1) score.addNeighbour(u2, fromU.index[pickU]);
+                if (fromV.person[pickV] != -1) score.addNeighbour(v2, fromV.index[pickV]);
+            }
+            moves++;
+        }
+
+        result.improvements += moves;
+        if (moves == 0) break;
+    }
+    MATCHING_STAT_ADD(stats, augmentations, result.improvements);
+
+    result.mates = score.mates();
+    result.weight = score.total();
+    result.seconds = elapsed();
+    return result;
+}
+
+Set<Pair> approximateMaximumWeightMatching(const Map<string, Map<string, int>>& possibleLinks,
+                                           const ApproximateOptions& options,
+                                           ApproximateResult* result) {
+    CompactGraph graph = CompactGraph::fromWeightedLinks(possibleLinks);
+    ApproximateResult found = approximateMaximumWeightMatchingById(graph, options);
+    Set<Pair> pairs = graph.toPairs(found.mates);
+    if (result != nullptr) *result = move(found);
+    return pairs;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "SmallGroupMatching.h"
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("Local search fixes the greedy matching on a path") {
+    /* This world:
+     *
+     *  A --- B --- C --- D
+     *     3     4     3
+     *
+     * Greedy takes B--C for 4; swapping it for the two outer pairs makes 6. Both
+     * bounds say 7: half of 3 + 4 + 4 + 3, and the two heaviest links.
+     */
+    ApproximateResult result;
+    auto pairs = approximateMaximumWeightMatching({
+        { "A", { { "B", 3 } } },
+        { "B", { { "A", 3 }, { "C", 4 } } },
+        { "C", { { "B", 4 }, { "D", 3 } } },
+        { "D", { { "C", 3 } } },
+    }, ApproximateOptions(), &result);
+
+    EXPECT_EQUAL(pairs, { { "A", "B" }, { "C", "D" } });
+    EXPECT_EQUAL(result.greedyWeight, 4);
+    EXPECT_EQUAL(result.weight, 6);
+    EXPECT_EQUAL(result.improvements, 1);
+    EXPECT_EQUAL(result.upperBound, 7);
+    EXPECT(result.ratio() > 0.85);
+}
+
+STUDENT_TEST("Approximate matchings are at least half the best, and never above the bound") {
+    mt19937 generator(13);
+    for (int trial = 0; trial < 60; trial++) {
+        int numPeople = 6 + int(generator() % 12);
+        CompactGraphBuilder builder;
+        for (int i = 0; i < numPeople; i++) {
+            builder.intern(to_string(100 + i));
+        }
+        for (int u = 0; u < numPeople; u++) {
+            for (int v = u + 1; v < numPeople; v++) {
+                if (generator() % 3 == 0) builder.addLink(u, v, int(generator() % 20) - 2);
+            }
+        }
+        CompactGraph graph = builder.build();
+
+        SmallGroupMatching exact(graph);
+        long long best = exact.solve();
+
+        ApproximateResult result = approximateMaximumWeightMatchingById(graph);
+        MatchingScore check(graph);
+        check.assign(result.mates);
+        EXPECT_EQUAL(check.total(), result.weight);
+        EXPECT(result.weight >= result.greedyWeight);
+        EXPECT(2 * result.greedyWeight >= best);
+        EXPECT(result.weight <= best);
+        EXPECT(best <= result.upperBound);
+    }
+}
+
+STUDENT_TEST("Approximate matching stops after the rounds it is given") {
+    ApproximateOptions options;
+    options.maxRounds = 0;
+    ApproximateResult result;
+    approximateMaximumWeightMatching({
+        { "A", { { "B", 3 } } },
+        { "B", { { "A", 3 }, { "C", 4 } } },
+        { "C", { { "B", 4 }, { "D", 3 } } },
+        { "D", { { "C", 3 } } },
+    }, options, &result);
+    EXPECT_EQUAL(result.weight, 4);
+    EXPECT_EQUAL(result.rounds, 0);
+
+    EXPECT_EQUAL(approximateMaximumWeightMatching({}), {});
+}
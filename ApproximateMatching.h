@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "CompactGraph.h"
+#include "SolverStats.h"
+#include "map.h"
+#include "set.h"
+
+struct ApproximateOptions {
+    /* Passes of local search over every link after the greedy matching. Each pass
+     * is O(m) lookups; the search also stops early once a pass changes nothing.
+     */
+    int maxRounds = 4;
+
+    /* Stop improving once this much time has gone by, if positive. The greedy
+     * matching itself always runs to completion.
+     */
+    double maxSeconds = 0;
+};
+
+struct ApproximateResult {
+    std::vector<int> mates;
+    long long weight = 0;
+    long long greedyWeight = 0;   // Before local search.
+    long long upperBound = 0;     // No matching weighs more than this.
+    int       improvements = 0;   // Local search moves applied.
+    int       rounds = 0;
+    double    seconds = 0;
+
+    /* weight / upperBound: how far from optimal the answer could be, at worst. */
+    double ratio() const {
+        return upperBound == 0 ? 1.0 : double(weight) / double(upperBound);
+    }
+};
+
+/* A good maximum-weight matching, fast, without a guarantee that it is the best.
+ *
+ * Links are sorted by weight once and taken greedily, heaviest first, whenever
+ * both people are still free; that alone is always at least half the optimum.
+ * Local search then walks the links looking for a link worth adding even though it
+ * breaks up the pairs its ends are in, counting in what the people left behind can
+ * do: pair with each other (swapping two pairs for two others) or with someone
+ * still free (an augmenting path of up to five links). Each move strictly raises
+ * the weight, so it can't cycle.
+ *
+ * The result carries an upper bound on the optimum: the smaller of half the sum
+ * of everyone's heaviest link and the total of the n / 2 heaviest links.
+ *
+ * Time is O(m log m) for the sort, then each round looks at every link once and,
+ * for the few links that could pay off, at the neighbours of the two people they
+ * would leave behind. Memory is one 12-byte record per link, so it handles graphs
+ * with millions of links.
+ */
+ApproximateResult approximateMaximumWeightMatchingById(const CompactGraph& graph,
+                                                       const ApproximateOptions& options = ApproximateOptions(),
+                                                       SolverStats* stats = nullptr);
+
+/* Convenience wrapper for callers holding a preference map. If result is given, it
+ * receives the details, including the bound.
+ */
+Set<Pair> approximateMaximumWeightMatching(const Map<std::string, Map<std::string, int>>& possibleLinks,
+                                           const ApproximateOptions& options = ApproximateOptions(),
+                                           ApproximateResult* result = nullptr);
@@ -0,0 +1,181 @@
+/*
+ * Bump-allocated solver workspaces. See Arena.h.
+ */
+
+#include "Arena.h"
+#include <cstring>
+#include <new>
+#include "error.h"
+using namespace std;
+
+namespace {
+    size_t roundUp(size_t bytes) {
+        return (bytes + Arena::kAlignment - 1) / Arena::kAlignment * Arena::kAlignment;
+    }
+
+    /* Block headers are padded so the data after them stays aligned. */
+    const size_t kHeaderBytes = Arena::kAlignment;
+}
+
+Arena::Arena(size_t bytes) {
+    reserve(bytes);
+}
+
+Arena::~Arena() {
+    freeBlocks();
+}
+
+void Arena::addBlock(size_t bytes) {
+    bytes = roundUp(bytes);
+    /* Goes through operator new (rather than aligned_alloc) so that tools that
+     * count heap use, like the benchmarks, see arena blocks too.
+     */
+    void* memory = ::operator new(kHeaderBytes + bytes, align_val_t(kAlignment));
+    heapAllocations_++;
+
+    Block* block = static_cast<Block*>(memory);
+    block->next = blocks_;
+    block->size = bytes;
+    blocks_ = block;
+
+    cursor_ = static_cast<char*>(memory) + kHeaderBytes;
+    limit_ = cursor_ + bytes;
+    capacity_ += bytes;
+}
+
+void Arena::freeBlocks() {
+    while (blocks_ != nullptr) {
+        Block* next = blocks_->next;
+        ::operator delete(blocks_, align_val_t(kAlignment));
+        blocks_ = next;
+    }
+    cursor_ = limit_ = nullptr;
+    capacity_ = 0;
+}
+
+void Arena::reserve(size_t bytes) {
+    if (size_t(limit_ - cursor_) < bytes) {
+        addBlock(bytes);
+    }
+}
+
+void* Arena::allocateBytes(size_t bytes) {
+    bytes = roundUp(max<size_t>(bytes, 1));
+    if (size_t(limit_ - cursor_) < bytes) {
+        /* Out of room: grow geometrically so a sequence of allocations needs few blocks. */
+        addBlock(max(bytes, capacity_));
+    }
+
+    void* result = cursor_;
+    cursor_ += bytes;
+    used_ += bytes;
+    peak_ = max(peak_, used_);
+    return result;
+}
+
+void Arena::reset() {
+    if (blocks_ != nullptr && blocks_->next != nullptr) {
+        size_t total = capacity_;
+        freeBlocks();
+        addBlock(total);
+    } else if (blocks_ != nullptr) {
+        cursor_ = reinterpret_cast<char*>(blocks_) + kHeaderBytes;
+    }
+    used_ = 0;
+}
+
+SlicePool::SlicePool(Arena& arena, int numLists, size_t capacity)
+    : storage_(arena, capacity),
+      start_(arena, numLists, 0),
+      length_(arena, numLists, 0),
+      order_(arena, numLists) {
+}
+
+int* SlicePool::allocate(int list, int length) {
+    length_[list] = 0;
+    if (top_ + length > storage_.size()) {
+        compact();
+        if (top_ + length > storage_.size()) {
+            error("SlicePool: out of space (" + to_string(storage_.size()) + " entries)");
+        }
+    }
+
+    start_[list] = top_;
+    length_[list] = length;
+    top_ += length;
+    return data(list);
+}
+
+void SlicePool::compact() {
+    int live = 0;
+    for (int list = 0; list < int(length_.size()); list++) {
+        if (length_[list] > 0) order_[live++] = list;
+    }
+    sort(order_.begin(), order_.begin() + live, [&](int a, int b) {
+        return start_[a] < start_[b];
+    });
+
+    /* Lists only ever move down, and in order, so moving them one by one is safe. */
+    top_ = 0;
+    for (int i = 0; i < live; i++) {
+        int list = order_[i];
+        memmove(storage_.begin() + top_, storage_.begin() + start_[list], length_[list] * sizeof(int));
+        start_[list] = top_;
+        top_ += length_[list];
+    }
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("Arena hands out aligned memory and reuses it after reset") {
+    Arena arena(1024);
+    EXPECT_EQUAL(arena.heapAllocations(), 1);
+
+    int* ints = arena.allocate<int>(10);
+    double* doubles = arena.allocate<double>(3);
+    EXPECT_EQUAL(reinterpret_cast<uintptr_t>(ints) % Arena::kAlignment, 0);
+    EXPECT_EQUAL(reinterpret_cast<uintptr_t>(doubles) % Arena::kAlignment, 0);
+    EXPECT_EQUAL(arena.heapAllocations(), 1);
+
+    arena.reset();
+    EXPECT_EQUAL(arena.bytesUsed(), 0);
+    EXPECT_EQUAL(arena.allocate<int>(10), ints);
+}
+
+STUDENT_TEST("Arena merges its blocks on reset so the same workload fits next time") {
+    Arena arena(128);
+    for (int i = 0; i < 10; i++) {
+        arena.allocate<char>(100);
+    }
+    size_t grown = arena.heapAllocations();
+    EXPECT(grown > 1);
+
+    arena.reset();
+    EXPECT_EQUAL(arena.heapAllocations(), grown + 1);
+    for (int i = 0; i < 10; i++) {
+        arena.allocate<char>(100);
+    }
+    EXPECT_EQUAL(arena.heapAllocations(), grown + 1);
+}
+
+STUDENT_TEST("SlicePool reclaims released lists by compacting") {
+    Arena arena;
+    SlicePool pool(arena, 3, 8);
+
+    int* first = pool.allocate(0, 4);
+    for (int i = 0; i < 4; i++) first[i] = i;
+    pool.allocate(1, 4);
+    pool.release(1);
+
+    /* Only four entries are live, so this fits after compaction. */
+    int* third = pool.allocate(2, 4);
+    third[0] = 42;
+    EXPECT_EQUAL(pool.length(0), 4);
+    EXPECT_EQUAL(pool.data(0)[3], 3);
+    EXPECT_EQUAL(pool.data(2)[0], 42);
+
+    EXPECT_ERROR(pool.allocate(1, 1));
+}
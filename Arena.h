@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/* A bump allocator for solver workspaces.
+ *
+ * A solver carves all of its working arrays out of an Arena when it is set up,
+ * and then only mutates them in place (undoing its own changes where it needs
+ * to), so solving needs no memory of its own. Memory is handed back all at once
+ * with reset(), which keeps the capacity around so the next solver set up on the
+ * same arena doesn't allocate either.
+ *
+ * heapAllocations() counts every block the arena has ever requested from the
+ * heap. Comparing it before and after a solve shows whether the solve grew the
+ * arena; it can't see anything allocated some other way, which only a count of
+ * global operator new (as the benchmarks keep) would catch.
+ */
+class Arena {
+public:
+    /* Every allocation starts on a cache-line boundary. */
+    static const size_t kAlignment = 64;
+
+    Arena() = default;
+    explicit Arena(size_t bytes);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator= (const Arena&) = delete;
+
+    /* Makes sure at least `bytes` more can be allocated without going to the heap again. */
+    void reserve(size_t bytes);
+
+    /* Returns uninitialized space for count Ts. Only for trivial types: nothing is ever destroyed. */
+    template <typename T> T* allocate(size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                      "Arena only holds trivial types");
+        return static_cast<T*>(allocateBytes(count * sizeof(T)));
+    }
+
+    /* Releases everything allocated so far. If the arena had to grow, its blocks are merged
+     * into one so that the same workload fits without growing next time.
+     */
+    void reset();
+
+    size_t bytesUsed() const {
+        return used_;
+    }
+    size_t peakBytes() const {
+        return peak_;
+    }
+    size_t capacity() const {
+        return capacity_;
+    }
+    size_t heapAllocations() const {
+        return heapAllocations_;
+    }
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+    };
+
+    void* allocateBytes(size_t bytes);
+    void  addBlock(size_t bytes);
+    void  freeBlocks();
+
+    Block* blocks_ = nullptr;   // Newest first.
+    char*  cursor_ = nullptr;
+    char*  limit_  = nullptr;
+    size_t used_ = 0;
+    size_t peak_ = 0;
+    size_t capacity_ = 0;
+    size_t heapAllocations_ = 0;
+};
+
+/* A fixed-size array whose storage lives in an Arena. */
+template <typename T> class ArenaArray {
+public:
+    ArenaArray() = default;
+    ArenaArray(Arena& arena, size_t size)
+        : data_(arena.allocate<T>(size)), size_(size) {
+    }
+    ArenaArray(Arena& arena, size_t size, const T& value)
+        : ArenaArray(arena, size) {
+        fill(value);
+    }
+
+    void fill(const T& value) {
+        std::fill(data_, data_ + size_, value);
+    }
+
+    T& operator[] (size_t i) {
+        return data_[i];
+    }
+    const T& operator[] (size_t i) const {
+        return data_[i];
+    }
+    size_t size() const {
+        return size_;
+    }
+    T* begin() {
+        return data_;
+    }
+    T* end() {
+        return data_ + size_;
+    }
+    const T* begin() const {
+        return data_;
+    }
+    const T* end() const {
+        return data_ + size_;
+    }
+
+private:
+    T*     data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/* A stack with a fixed capacity, stored in an Arena. Pushing past the capacity is a bug. */
+template <typename T> class ArenaStack {
+public:
+    ArenaStack() = default;
+    ArenaStack(Arena& arena, size_t capacity)
+        : data_(arena.allocate<T>(capacity)), capacity_(capacity) {
+    }
+
+    void push_back(const T& value) {
+        data_[size_++] = value;
+    }
+    void pop_back() {
+        size_--;
+    }
+    T& back() {
+        return data_[size_ - 1];
+    }
+    void clear() {
+        size_ = 0;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    size_t size() const {
+        return size_;
+    }
+    size_t capacity() const {
+        return capacity_;
+    }
+    T& operator[] (size_t i) {
+        return data_[i];
+    }
+    T* begin() {
+        return data_;
+    }
+    T* end() {
+        return data_ + size_;
+    }
+
+private:
+    T*     data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+/* Numbered variable-length int lists sharing one fixed pool in an Arena.
+ *
+ * Allocating bumps a pointer; releasing just forgets the list. When the pool runs
+ * out, the live lists are slid down over the gaps. Size the pool at twice the most
+ * entries that are ever live at once and it never needs to grow.
+ */
+class SlicePool {
+public:
+    SlicePool() = default;
+    SlicePool(Arena& arena, int numLists, size_t capacity);
+
+    /* Gives list a fresh, uninitialized run of length entries, dropping its old contents.
+     * May move other lists, so pointers from data() don't survive a call to allocate().
+     */
+    int* allocate(int list, int length);
+    void release(int list) {
+        length_[list] = 0;
+    }
+
+    int* data(int list) {
+        return storage_.begin() + start_[list];
+    }
+    const int* data(int list) const {
+        return storage_.begin() + start_[list];
+    }
+    int length(int list) const {
+        return length_[list];
+    }
+
+private:
+    void compact();
+
+    ArenaArray<int>    storage_;
+    ArenaArray<size_t> start_;
+    ArenaArray<int>    length_;
+    ArenaArray<int>    order_;   // Scratch for compact().
+    size_t             top_ = 0;
+};
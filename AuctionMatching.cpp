@@ -0,0 +1,420 @@
+/*
+ * Parallel auction algorithm for two-sided matchings. See AuctionMatching.h.
+ */
+
+#include "AuctionMatching.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "BipartiteMatching.h"
+#include "error.h"
+using namespace std;
+
+namespace {
+    /* Holds threads until all of them have arrived. Reusable. */
+    class Barrier {
+    public:
+        explicit Barrier(int numThreads)
+            : numThreads_(numThreads) {
+        }
+
+        void wait() {
+            if (numThreads_ == 1) return;
+            unique_lock<mutex> lock(mutex_);
+            long long generation = generation_;
+            if (++arrived_ == numThreads_) {
+                arrived_ = 0;
+                generation_++;
+                allArrived_.notify_all();
+            } else {
+                allArrived_.wait(lock, [&] { return generation_ != generation; });
+            }
+        }
+
+    private:
+        int                numThreads_;
+        int                arrived_ = 0;
+        long long          generation_ = 0;
+        mutex              mutex_;
+        condition_variable allArrived_;
+    };
+
+    /* The assignment problem the matching becomes. Everyone is both a bidder and a
+     * thing to bid for: bidder v may take thing u, for each link v -- u, or thing
+     * v, their own "stay unpaired" option, worth 0. Someone on side 0 taking thing u
+     * on side 1 pairs them in the first copy of the matching, and someone on side 1
+     * taking thing u on side 0 pairs them in the second; a perfect assignment always
+     * exists, and is worth the two copies' weights together.
+     */
+    class Auction {
+    public:
+        Auction(const CompactGraph& graph, long long scale)
+            : n_(int(graph.numPeople())),
+              rowStart_(n_ + 1, 0),
+              price_(n_, 0), owner_(n_, -1), taken_(n_, -1),
+              bidThing_(n_, -1), bidAmount_(n_, 0),
+              highestBid_(n_), winner_(n_) {
+            for (int v = 0; v < n_; v++) {
+                rowStart_[v + 1] = rowStart_[v] + 1;
+                for (const int32_t* w = graph.weightsBegin(v); w != graph.weightsBegin(v) + graph.degree(v); w++) {
+                    if (*w > 0) rowStart_[v + 1]++;
+                }
+            }
+            rowThing_.resize(rowStart_[n_]);
+            rowWeight_.resize(rowStart_[n_]);
+            for (int v = 0; v < n_; v++) {
+                size_t k = rowStart_[v];
+                rowThing_[k] = v;
+                rowWeight_[k++] = 0;
+                for (uint32_t i = 0; i < graph.degree(v); i++) {
+                    if (graph.weightsBegin(v)[i] <= 0) continue;
+                    rowThing_[k] = int(graph.neighboursBegin(v)[i]);
+                    rowWeight_[k++] = graph.weightsBegin(v)[i] * scale;
+                    largest_ = max(largest_, rowWeight_[k - 1]);
+                }
+            }
+            for (int v = 0; v < n_; v++) {
+                highestBid_[v] = LLONG_MIN;
+                winner_[v] = INT_MAX;
+            }
+        }
+
+        long long largestWeight() const {
+            return largest_;
+        }
+        int taken(int v) const {
+            return taken_[v];
+        }
+
+        /* Auctions everything off from scratch at the current prices, with bids
+         * raised by at least epsilon. Rounds run on numThreads threads while at least
+         * minBiddersPerThread people per thread are bidding; the long tail of small
+         * rounds at the end runs on one, where there's no waiting on each other.
+         */
+        void runPhase(long long epsilon, int numThreads, size_t minBiddersPerThread) {
+            fill(owner_.begin(), owner_.end(), -1);
+            fill(taken_.begin(), taken_.end(), -1);
+            current_ = 0;
+            bidding_[0].resize(n_);
+            for (int v = 0; v < n_; v++) {
+                bidding_[0][v] = v;
+            }
+
+            if (numThreads > 1) runRounds(epsilon, numThreads, minBiddersPerThread * numThreads);
+            runRounds(epsilon, 1, 0);
+        }
+
+        long long rounds() const {
+            return rounds_;
+        }
+        long long bids() const {
+            return bids_;
+        }
+
+    private:
+        /* Runs bidding rounds until fewer than stopBelow people are left bidding. */
+        void runRounds(long long epsilon, int numThreads, size_t stopBelow) {
+            Barrier barrier(numThreads);
+            vector<vector<int>> outbid(numThreads);
+            vector<long long> workerBids(numThreads, 0);
+            int finalList = current_;
+
+            auto work = [&](int worker) {
+                int current = current_;
+                for (; !bidding_[current].empty() && bidding_[current].size() >= stopBelow; current = 1 - current) {
+                    const vector<int>& bidding = bidding_[current];
+                    size_t begin = bidding.size() * worker / numThreads;
+                    size_t end = bidding.size() * (worker + 1) / numThreads;
+
+                    for (size_t i = begin; i < end; i++) {
+                        placeBid(bidding[i], epsilon);
+                    }
+                    workerBids[worker] += end - begin;
+                    barrier.wait();
+
+                    /* Equal bids go to the lowest id. */
+                    for (size_t i = begin; i < end; i++) {
+                        int v = bidding[i];
+                        if (bidAmount_[v] == highestBid_[bidThing_[v]].load(memory_order_relaxed)) {
+                            atomicMin(winner_[bidThing_[v]], v);
+                        }
+                    }
+                    barrier.wait();
+
+                    for (size_t i = begin; i < end; i++) {
+                        int v = bidding[i];
+                        int thing = bidThing_[v];
+                        if (winner_[thing].load(memory_order_relaxed) != v) {
+                            outbid[worker].push_back(v);
+                            continue;
+                        }
+                        int previous = owner_[thing];
+                        if (previous != -1) {
+                            taken_[previous] = -1;
+                            outbid[worker].push_back(previous);
+                        }
+                        owner_[thing] = v;
+                        taken_[v] = thing;
+                        price_[thing] = bidAmount_[v];
+                    }
+                    barrier.wait();
+
+                    for (size_t i = begin; i < end; i++) {
+                        int thing = bidThing_[bidding[i]];
+                        if (winner_[thing].load(memory_order_relaxed) == bidding[i]) {
+                            highestBid_[thing].store(LLONG_MIN, memory_order_relaxed);
+                            winner_[thing].store(INT_MAX, memory_order_relaxed);
+                        }
+                    }
+                    if (worker == 0) {
+                        vector<int>& next = bidding_[1 - current];
+                        next.clear();
+                        for (vector<int>& part: outbid) {
+                            next.insert(next.end(), part.begin(), part.end());
+                            part.clear();
+                        }
+                        rounds_++;
+                    }
+                    barrier.wait();
+                }
+                if (worker == 0) finalList = current;
+            };
+
+            if (numThreads == 1) {
+                work(0);
+            } else {
+                vector<thread> workers;
+                for (int worker = 0; worker < numThreads; worker++) {
+                    workers.emplace_back(work, worker);
+                }
+                for (thread& worker: workers) {
+                    worker.join();
+                }
+            }
+            current_ = finalList;
+            for (long long count: workerBids) {
+                bids_ += count;
+            }
+        }
+
+        static void atomicMax(atomic<long long>& target, long long value) {
+            long long seen = target.load(memory_order_relaxed);
+            while (seen < value && !target.compare_exchange_weak(seen, value, memory_order_relaxed)) {
+            }
+        }
+        static void atomicMin(atomic<int>& target, int value) {
+            int seen = target.load(memory_order_relaxed);
+            while (seen > value && !target.compare_exchange_weak(seen, value, memory_order_relaxed)) {
+            }
+        }
+
+        /* v bids for the thing worth most to them, by as much as it beats the
+         * runner-up, plus epsilon.
+         *
+         * Among things that tie for best, v takes the first at or after position
+         * v % length of their row. If everyone took the first in row order, then
+         * on tied weights everyone would bid for the same thing, only one bid a
+         * round would win, and a phase would take a round per person.
+         */
+        void placeBid(int v, long long epsilon) {
+            const int*       things  = rowThing_.data() + rowStart_[v];
+            const long long* weights = rowWeight_.data() + rowStart_[v];
+            size_t length = rowStart_[v + 1] - rowStart_[v];
+            size_t start = size_t(v) % length;
+
+            long long best = LLONG_MIN, second = LLONG_MIN;
+            size_t bestAt = 0;
+            auto scan = [&](size_t begin, size_t end) {
+                for (size_t k = begin; k < end; k++) {
+                    long long value = weights[k] - price_[things[k]];
+                    if (value > best) {
+                        second = best;
+                        best = value;
+                        bestAt = k;
+                    } else if (value > second) {
+                        second = value;
+                    }
+                }
+            };
+            scan(start, length);
+            scan(0, start);
+
+            int thing = things[bestAt];
+            long long raise = second == LLONG_MIN ? epsilon : best - second + epsilon;
+            bidThing_[v] = thing;
+            bidAmount_[v] = price_[thing] + raise;
+            atomicMax(highestBid_[thing], bidAmount_[v]);
+        }
+
+        int                       n_;
+        long long                 largest_ = 0;
+        vector<size_t>            rowStart_;   // CSR rows: each person's own option, then their positive links.
+        vector<int>               rowThing_;
+        vector<long long>         rowWeight_;
+        vector<long long>         price_;
+        vector<int>               owner_;      // Who has each thing, or -1.
+        vector<int>               taken_;      // What each person has, or -1.
+        vector<int>               bidThing_;
+        vector<long long>         bidAmount_;
+        vector<atomic<long long>> highestBid_; // This round's, or LLONG_MIN.
+        vector<atomic<int>>       winner_;     // Lowest id among the highest bidders, or INT_MAX.
+        vector<int>               bidding_[2]; // This round's bidders, and the next round's.
+        int                       current_ = 0;
+        long long                 rounds_ = 0;
+        long long                 bids_ = 0;
+    };
+}
+
+AuctionResult auctionMaximumWeightMatchingById(const CompactGraph& graph, const vector<char>& side,
+                                               const AuctionOptions& options, SolverStats* stats) {
+    if (options.epsilon < 0) error("auctionMaximumWeightMatching: epsilon can't be negative");
+    int n = int(graph.numPeople());
+    for (int v = 0; v < n; v++) {
+        for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++) {
+            if (side[v] == side[*u]) error("auctionMaximumWeightMatching: the graph isn't two-sided");
+        }
+    }
+    StatsTimer timer(stats, &SolverStats::secondsSolving);
+
+    /* Weights are scaled by n + 1 so that epsilon can be an integer. A final epsilon
+     * of 1 then leaves the assignment less than n / 2 / (n + 1) < 1 short in the
+     * original units (half because the assignment holds two copies of the
+     * matching), which for integer weights means exact.
+     */
+    long long scale = n + 1;
+    long long finalEpsilon = max(1LL, (long long)(options.epsilon * double(scale)));
+    Auction auction(graph, scale);
+
+    AuctionResult result;
+    result.mates.assign(n, -1);
+    if (auction.largestWeight() == 0) return result;
+
+    int numThreads = options.numThreads > 0 ? options.numThreads : int(thread::hardware_concurrency());
+    numThreads = max(1, min(numThreads, n / max(1, options.minPeoplePerThread)));
+
+    long long epsilon = max(finalEpsilon, auction.largestWeight() / 4);
+    while (true) {
+        auction.runPhase(epsilon, numThreads, size_t(max(1, options.minPeoplePerThread)));
+        result.phases++;
+        if (epsilon == finalEpsilon) break;
+        epsilon = max(finalEpsilon, epsilon / 4);
+    }
+    result.rounds = auction.rounds();
+    result.bids = auction.bids();
+    MATCHING_STAT_ADD(stats, stages, result.phases);
+    MATCHING_STAT_ADD(stats, nodesExpanded, result.bids);
+
+    /* Take the heavier copy of the matching. */
+    long long copyWeight[2] = { 0, 0 };
+    for (int v = 0; v < n; v++) {
+        int u = auction.taken(v);
+        if (u != v) copyWeight[int(side[v])] += graph.weight(v, u);
+    }
+    char copy = copyWeight[1] > copyWeight[0] ? 1 : 0;
+    for (int v = 0; v < n; v++) {
+        int u = auction.taken(v);
+        if (side[v] == copy && u != v) {
+            result.mates[v] = u;
+            result.mates[u] = v;
+        }
+    }
+    result.weight = copyWeight[int(copy)];
+    result.maxShortfall = double(n) * double(finalEpsilon) / (2.0 * double(scale));
+    return result;
+}
+
+Set<Pair> auctionMaximumWeightMatching(const Map<string, Map<string, int>>& possibleLinks,
+                                       const AuctionOptions& options, AuctionResult* result) {
+    CompactGraph graph = CompactGraph::fromWeightedLinks(possibleLinks);
+    vector<char> side;
+    if (!findBipartition(graph, side)) error("auctionMaximumWeightMatching: the links aren't two-sided");
+
+    AuctionResult found = auctionMaximumWeightMatchingById(graph, side, options);
+    Set<Pair> pairs = graph.toPairs(found.mates);
+    if (result != nullptr) *result = move(found);
+    return pairs;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "TestGraphs.h"
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("The auction is exact with epsilon 0, and the same on any number of threads") {
+    mt19937 generator(43);
+    for (int trial = 0; trial < 30; trial++) {
+        CompactGraph graph = randomTwoSidedGraph(generator, 2 + int(generator() % 40), 2 + int(generator() % 40),
+                                                 3, -2, 27);
+        vector<char> side;
+        EXPECT(findBipartition(graph, side));
+
+        BipartiteWeightedMatching reference(graph, side);
+        long long best = reference.solve();
+
+        AuctionOptions options;
+        options.numThreads = 1;
+        AuctionResult one = auctionMaximumWeightMatchingById(graph, side, options);
+        EXPECT_EQUAL(one.weight, best);
+        EXPECT(one.maxShortfall < 1);
+
+        options.numThreads = 3;
+        options.minPeoplePerThread = 1;
+        AuctionResult three = auctionMaximumWeightMatchingById(graph, side, options);
+        EXPECT(three.mates == one.mates);
+        EXPECT_EQUAL(three.rounds, one.rounds);
+    }
+}
+
+STUDENT_TEST("A coarser epsilon stays within n * epsilon of the best") {
+    mt19937 generator(47);
+    for (int trial = 0; trial < 20; trial++) {
+        CompactGraph graph = randomTwoSidedGraph(generator, 30, 30, 4, -2, 997);
+        vector<char> side;
+        findBipartition(graph, side);
+        BipartiteWeightedMatching reference(graph, side);
+        long long best = reference.solve();
+
+        AuctionOptions options;
+        options.epsilon = 2.5;
+        AuctionResult result = auctionMaximumWeightMatchingById(graph, side, options);
+        EXPECT(result.weight <= best);
+        EXPECT(best <= result.weight + result.maxShortfall);
+        EXPECT(result.maxShortfall <= 60 * 2.5);
+    }
+}
+
+STUDENT_TEST("Tied bidders spread out instead of all bidding for the same thing") {
+    mt19937 generator(53);
+    CompactGraph graph = randomTwoSidedGraph(generator, 200, 200, 1, 1, 1);
+    vector<char> side;
+    findBipartition(graph, side);
+
+    AuctionResult result = auctionMaximumWeightMatchingById(graph, side);
+    EXPECT_EQUAL(result.weight, 200);
+    /* Taking the first tied thing in row order took about 100 bids per person per
+     * phase here, against 4 now.
+     */
+    EXPECT(result.bids < 10 * 400 * result.phases);
+}
+
+STUDENT_TEST("auctionMaximumWeightMatching turns down graphs with odd cycles") {
+    Map<string, Map<string, int>> mentoring = {
+        { "Ana", { { "Xi", 3 }, { "Yu", 2 } } },
+        { "Bo", { { "Xi", 2 } } },
+        { "Xi", { { "Ana", 3 }, { "Bo", 2 } } },
+        { "Yu", { { "Ana", 2 } } },
+    };
+    EXPECT_EQUAL(auctionMaximumWeightMatching(mentoring), { { "Ana", "Yu" }, { "Bo", "Xi" } });
+
+    EXPECT_ERROR(auctionMaximumWeightMatching({
+        { "A", { { "B", 1 }, { "C", 1 } } }, { "B", { { "A", 1 }, { "C", 1 } } }, { "C", { { "A", 1 }, { "B", 1 } } },
+    }));
+    AuctionOptions negative;
+    negative.epsilon = -1;
+    EXPECT_ERROR(auctionMaximumWeightMatching(mentoring, negative));
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "CompactGraph.h"
+#include "SolverStats.h"
+#include "map.h"
+#include "set.h"
+
+struct AuctionOptions {
+    /* How far from the best the answer may be: its weight is within n * epsilon of
+     * the heaviest matching's, for n people. 0 means exact, which for integer
+     * weights costs only a few more bidding phases.
+     */
+    double epsilon = 0;
+
+    /* Worker threads. 0 means one per hardware thread. Each round ends with the
+     * threads waiting for each other, so rounds with fewer than minPeoplePerThread
+     * bidders per thread (including the long tail at the end of each phase) run on
+     * one thread instead.
+     */
+    int numThreads = 0;
+    int minPeoplePerThread = 20000;
+};
+
+struct AuctionResult {
+    std::vector<int> mates;
+    long long weight = 0;
+    /* The heaviest matching weighs less than weight + maxShortfall. */
+    double    maxShortfall = 0;
+    int       phases = 0;
+    long long rounds = 0;
+    long long bids = 0;
+};
+
+/* Maximum-weight matching on a two-sided graph (see findBipartition) by Bertsekas'
+ * auction algorithm with epsilon scaling, for very large instances.
+ *
+ * Matchings that may leave people out are turned into an assignment problem in
+ * which everyone must be assigned: each person also bids for a copy of the
+ * problem in which the sides swap roles, and for a zero-weight "stay unpaired"
+ * option, so the assignment is twice a matching. People who have no one bid for
+ * the best value (weight less price) among their links, raising its price by the
+ * gap to their second best plus epsilon. Every round, all bids are worked out in
+ * parallel against the same prices, each taken thing goes to its highest bidder
+ * (lowest id on ties, using atomic maximums), and the losers and those outbid bid
+ * again in the next round. Epsilon starts large and shrinks by a factor of 4 per
+ * phase, with prices kept from one phase to the next, so the last phase starts
+ * close to the answer.
+ *
+ * Bidding walks each person's links as one contiguous row, which the compiler can
+ * vectorize. Each person starts the walk at a different place in their row and
+ * takes the first best thing from there, so that on tied weights bidders spread
+ * out instead of all bidding for the same thing. Results don't depend on the
+ * number of threads.
+ *
+ * maximumWeightMatchingById doesn't use this: on one thread, BipartiteWeightedMatching
+ * was faster on every two-sided family measured.
+ *
+ * Reports an error if side isn't a bipartition of the graph or epsilon is negative.
+ */
+AuctionResult auctionMaximumWeightMatchingById(const CompactGraph& graph, const std::vector<char>& side,
+                                               const AuctionOptions& options = AuctionOptions(),
+                                               SolverStats* stats = nullptr);
+
+/* maximumWeightMatching for two-sided preference maps, solved by auction. Reports
+ * an error if some group of people has an odd cycle of links.
+ */
+Set<Pair> auctionMaximumWeightMatching(const Map<std::string, Map<std::string, int>>& possibleLinks,
+                                       const AuctionOptions& options = AuctionOptions(),
+                                       AuctionResult* result = nullptr);
@@ -0,0 +1,114 @@
+/*
+ * Solving many independent groups at once. See BatchMatching.h.
+ */
+
+#include "BatchMatching.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "Arena.h"
+#include "CompactGraph.h"
+#include "ComponentMatching.h"
+using namespace std;
+
+namespace {
+    void solveOne(const Map<string, Map<string, int>>& group, Arena& workspace, BatchResult& result) {
+        auto start = chrono::steady_clock::now();
+
+        /* The batch already keeps every thread busy, so each group is solved on one. */
+        ComponentOptions oneThread;
+        oneThread.numThreads = 1;
+        CompactGraph graph = CompactGraph::fromWeightedLinks(group);
+        vector<int> mate = maximumWeightMatchingByComponent(graph, workspace, oneThread);
+        workspace.reset();
+
+        result.weight = 0;
+        for (uint32_t v = 0; v < graph.numPeople(); v++) {
+            if (mate[v] > int(v)) {
+                result.weight += graph.weight(v, mate[v]);
+            }
+        }
+        result.matching = graph.toPairs(mate);
+
+        result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+}
+
+vector<BatchResult> maximumWeightMatchingBatch(const vector<Map<string, Map<string, int>>>& groups,
+                                               const BatchOptions& options) {
+    vector<BatchResult> results(groups.size());
+
+    int numThreads = options.numThreads > 0 ? options.numThreads : int(thread::hardware_concurrency());
+    numThreads = max(1, min(numThreads, int(groups.size())));
+
+    atomic<size_t> next { 0 };
+    auto work = [&]() {
+        Arena workspace;
+        for (size_t i = next++; i < groups.size(); i = next++) {
+            solveOne(groups[i], workspace, results[i]);
+        }
+    };
+
+    if (numThreads == 1) {
+        work();
+    } else {
+        vector<thread> workers;
+        for (int i = 0; i < numThreads; i++) {
+            workers.emplace_back(work);
+        }
+        for (thread& worker: workers) {
+            worker.join();
+        }
+    }
+    return results;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("maximumWeightMatchingBatch gives each group's own answer, in input order") {
+    /* Groups of every size from 1 to 59, so both solvers get used. */
+    mt19937 generator(11);
+    vector<Map<string, Map<string, int>>> groups;
+    for (int size = 1; size < 60; size++) {
+        Map<string, Map<string, int>> group;
+        for (int i = 0; i < size; i++) {
+            group[to_string(i)];
+        }
+        for (int i = 0; i < size; i++) {
+            for (int j = i + 1; j < size; j++) {
+                if (generator() % 4 == 0) {
+                    int weight = int(generator() % 10) + 1;
+                    group[to_string(i)][to_string(j)] = weight;
+                    group[to_string(j)][to_string(i)] = weight;
+                }
+            }
+        }
+        groups.push_back(group);
+    }
+
+    BatchOptions options;
+    options.numThreads = 4;
+    vector<BatchResult> results = maximumWeightMatchingBatch(groups, options);
+    EXPECT_EQUAL(results.size(), groups.size());
+
+    for (size_t i = 0; i < groups.size(); i++) {
+        Set<Pair> expected = maximumWeightMatching(groups[i]);
+        EXPECT_EQUAL(results[i].matching, expected);
+
+        long long weight = 0;
+        for (const Pair& pair: expected) {
+            weight += groups[i][pair.first()][pair.second()];
+        }
+        EXPECT_EQUAL(results[i].weight, weight);
+        EXPECT(results[i].seconds >= 0);
+    }
+}
+
+STUDENT_TEST("maximumWeightMatchingBatch handles an empty batch") {
+    EXPECT(maximumWeightMatchingBatch({}).empty());
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Matchmaker.h"
+#include "map.h"
+#include "set.h"
+
+struct BatchOptions {
+    /* Worker threads. 0 means one per hardware thread. Never more than there are groups. */
+    int numThreads = 0;
+};
+
+struct BatchResult {
+    Set<Pair> matching;
+    long long weight = 0;
+    double    seconds = 0;   // Wall time spent on this group, from its map to its pairs.
+};
+
+/* Runs maximumWeightMatching on every group, spread across a pool of threads. Each
+ * group goes through the same steps, maximumWeightMatchingByComponent on one thread,
+ * so the answers are the same as maximumWeightMatching's.
+ *
+ * Groups are handed out one at a time from a shared counter, so a few big groups
+ * don't hold up the rest. Each thread keeps one Arena for its whole run and resets
+ * it between groups, so once it has seen its largest group, setting up a solver no
+ * longer goes to the heap.
+ *
+ * results[i] is the answer for groups[i], whatever order the groups finished in.
+ */
+std::vector<BatchResult> maximumWeightMatchingBatch(const std::vector<Map<std::string, Map<std::string, int>>>& groups,
+                                                    const BatchOptions& options = BatchOptions());
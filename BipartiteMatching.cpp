@@ -0,0 +1,405 @@
+/*
+ * Matching in two-sided graphs: Hopcroft-Karp and the sparse Hungarian method. See
+ * BipartiteMatching.h.
+ */
+
+#include "BipartiteMatching.h"
+#include <algorithm>
+#include <climits>
+using namespace std;
+
+bool findBipartition(const CompactGraph& graph, vector<char>& side) {
+    uint32_t n = graph.numPeople();
+    side.assign(n, -1);
+    vector<uint32_t> queue;
+    queue.reserve(n);
+    for (uint32_t start = 0; start < n; start++) {
+        if (side[start] != -1) continue;
+        side[start] = 0;
+        queue.clear();
+        queue.push_back(start);
+        for (size_t head = 0; head < queue.size(); head++) {
+            uint32_t v = queue[head];
+            for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++) {
+                if (side[*u] == -1) {
+                    side[*u] = char(1 - side[v]);
+                    queue.push_back(*u);
+                } else if (side[*u] == side[v]) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+namespace {
+    const int kUnreached = INT_MAX;
+    const long long kFar = LLONG_MAX;
+}
+
+HopcroftKarpMatching::HopcroftKarpMatching(const CompactGraph& graph, const vector<char>& side, Arena& arena)
+    : arena_(arena),
+      graph_(graph),
+      mate_(arena, graph.numPeople(), -1),
+      layer_(arena, graph.numPeople(), kUnreached),
+      nextLink_(arena, graph.numPeople(), 0),
+      queue_(arena, graph.numPeople()),
+      pathRight_(arena, graph.numPeople(), -1),
+      left_(arena, graph.numPeople()) {
+    for (uint32_t v = 0; v < graph.numPeople(); v++) {
+        if (side[v] == 0) left_.push_back(int(v));
+    }
+}
+
+HopcroftKarpMatching::HopcroftKarpMatching(const CompactGraph& graph, const vector<char>& side)
+    : HopcroftKarpMatching(graph, side, ownArena_) {
+}
+
+void HopcroftKarpMatching::setMates(const vector<int>& mate) {
+    pairs_ = 0;
+    for (size_t v = 0; v < mate_.size(); v++) {
+        mate_[v] = mate[v];
+        if (mate[v] > int(v)) pairs_++;
+    }
+}
+
+bool HopcroftKarpMatching::buildLayers() {
+    queue_.clear();
+    for (int v: left_) {
+        if (mate_[v] == -1) {
+            layer_[v] = 0;
+            queue_.push_back(v);
+        } else {
+            layer_[v] = kUnreached;
+        }
+    }
+
+    /* Stop a layer past the first one with a link to someone free: nothing deeper
+     * can be on a shortest augmenting path.
+     */
+    freeLayer_ = kUnreached;
+    for (size_t head = 0; head < queue_.size(); head++) {
+        int v = queue_[head];
+        if (layer_[v] >= freeLayer_) break;
+        for (const uint32_t* r = graph_.neighboursBegin(v); r != graph_.neighboursEnd(v); r++) {
+            int next = mate_[*r];
+            if (next == -1) {
+                freeLayer_ = layer_[v];
+            } else if (layer_[next] == kUnreached) {
+                layer_[next] = layer_[v] + 1;
+                queue_.push_back(next);
+            }
+        }
+    }
+    return freeLayer_ != kUnreached;
+}
+
+bool HopcroftKarpMatching::augmentFrom(int root) {
+    /* Depth-first along the layers, with an explicit stack. Dead ends are taken out
+     * of the layers so that no later search in this phase tries them again.
+     */
+    queue_.clear();
+    queue_.push_back(root);
+    while (!queue_.empty()) {
+        int v = queue_.back();
+        if (nextLink_[v] == graph_.degree(v)) {
+            layer_[v] = kUnreached;
+            queue_.pop_back();
+            continue;
+        }
+
+        int r = int(graph_.neighboursBegin(v)[nextLink_[v]++]);
+        int next = mate_[r];
+        if (next == -1) {
+            if (layer_[v] != freeLayer_) continue;
+
+            /* Flip the path: each person on it takes the one they stepped through. */
+            pathRight_[v] = r;
+            for (int u: queue_) {
+                mate_[u] = pathRight_[u];
+                mate_[pathRight_[u]] = u;
+            }
+            return true;
+        }
+        if (layer_[v] < freeLayer_ && layer_[next] == layer_[v] + 1) {
+            pathRight_[v] = r;
+            queue_.push_back(next);
+        }
+    }
+    return false;
+}
+
+int HopcroftKarpMatching::maximumMatching() {
+    while (buildLayers()) {
+        MATCHING_STAT_INC(stats_, stages);
+        for (int v: left_) {
+            nextLink_[v] = 0;
+        }
+        for (int v: left_) {
+            if (mate_[v] == -1 && layer_[v] == 0 && augmentFrom(v)) {
+                pairs_++;
+                MATCHING_STAT_INC(stats_, augmentations);
+            }
+        }
+    }
+    return pairs_;
+}
+
+BipartiteWeightedMatching::BipartiteWeightedMatching(const CompactGraph& graph, const vector<char>& side,
+                                                     Arena& arena)
+    : arena_(arena),
+      graph_(graph),
+      side_(arena, graph.numPeople()),
+      mate_(arena, graph.numPeople(), -1),
+      dual_(arena, graph.numPeople(), 0),
+      distance_(arena, graph.numPeople(), kFar),
+      reachedFrom_(arena, graph.numPeople(), -1),
+      settled_(arena, graph.numPeople(), false),
+      heap_(arena, graph.numLinks() + graph.numPeople()),
+      touched_(arena, graph.numPeople()),
+      left_(arena, graph.numPeople()) {
+    /* Add the smaller side one person at a time: fewer searches. */
+    uint32_t onSideZero = uint32_t(count(side.begin(), side.end(), 0));
+    leftSide_ = onSideZero <= graph.numPeople() - onSideZero ? 0 : 1;
+    for (uint32_t v = 0; v < graph.numPeople(); v++) {
+        side_[v] = side[v];
+        if (side[v] == leftSide_) left_.push_back(int(v));
+    }
+}
+
+BipartiteWeightedMatching::BipartiteWeightedMatching(const CompactGraph& graph, const vector<char>& side)
+    : BipartiteWeightedMatching(graph, side, ownArena_) {
+}
+
+void BipartiteWeightedMatching::push(long long key, int node) {
+    heap_.push_back({ key, node });
+    push_heap(heap_.begin(), heap_.end(), [](const HeapEntry& a, const HeapEntry& b) {
+        return a.key != b.key ? a.key > b.key : a.node > b.node;
+    });
+}
+
+BipartiteWeightedMatching::HeapEntry BipartiteWeightedMatching::pop() {
+    pop_heap(heap_.begin(), heap_.end(), [](const HeapEntry& a, const HeapEntry& b) {
+        return a.key != b.key ? a.key > b.key : a.node > b.node;
+    });
+    HeapEntry top = heap_.back();
+    heap_.pop_back();
+    return top;
+}
+
+/* Settles left person v at distance_[v]: offers each of their positive links, at
+ * its slack, and the option of stopping at v, once v's dual has dropped to zero.
+ * Returns an unpaired right person reached with no slack at all, who is as near as
+ * anything left in the heap and so ends the search, or -1.
+ */
+int BipartiteWeightedMatching::scan(int v) {
+    settled_[v] = true;
+    push(distance_[v] + dual_[v], ~v);
+
+    const uint32_t* neighbours = graph_.neighboursBegin(v);
+    const int32_t*  weights    = graph_.weightsBegin(v);
+    for (uint32_t i = 0; i < graph_.degree(v); i++) {
+        int r = int(neighbours[i]);
+        if (weights[i] <= 0 || settled_[r]) continue;
+
+        long long key = distance_[v] + dual_[v] + dual_[r] - weights[i];
+        if (key < distance_[r]) {
+            if (distance_[r] == kFar) touched_.push_back(r);
+            distance_[r] = key;
+            reachedFrom_[r] = v;
+            if (key == distance_[v] && mate_[r] == -1) return r;
+            push(key, r);
+        }
+    }
+    return -1;
+}
+
+/* Pairs right with whoever reached them, who passes their old partner back along
+ * the tree, and so on up to the root.
+ */
+void BipartiteWeightedMatching::flipFrom(int right) {
+    while (right != -1) {
+        int v = reachedFrom_[right];
+        int next = mate_[v];
+        mate_[v] = right;
+        mate_[right] = v;
+        right = next;
+    }
+}
+
+void BipartiteWeightedMatching::addPerson(int root) {
+    /* The smallest dual that covers every link of root's. */
+    long long start = 0;
+    const uint32_t* neighbours = graph_.neighboursBegin(root);
+    const int32_t*  weights    = graph_.weightsBegin(root);
+    for (uint32_t i = 0; i < graph_.degree(root); i++) {
+        start = max(start, weights[i] - dual_[neighbours[i]]);
+    }
+    dual_[root] = start;
+    if (start == 0) return;
+
+    distance_[root] = 0;
+    touched_.push_back(root);
+    int nearest = scan(root);
+
+    long long reach = 0;
+    while (true) {
+        if (nearest != -1) {
+            /* On ties this is usually how a search ends, long before the heap has
+             * been worked through in order.
+             */
+            settled_[nearest] = true;
+            reach = distance_[nearest];
+            flipFrom(nearest);
+            break;
+        }
+
+        HeapEntry top = pop();
+        if (top.node < 0) {
+            /* Someone's dual reached zero: they let go of their partner, who is
+             * passed back along the tree. The root just stays unpaired.
+             */
+            int v = ~top.node;
+            reach = top.key;
+            int right = mate_[v];
+            if (v != root) {
+                mate_[v] = -1;
+                flipFrom(right);
+            }
+            break;
+        }
+
+        int r = top.node;
+        if (settled_[r] || top.key > distance_[r]) continue;
+        settled_[r] = true;
+        MATCHING_STAT_INC(stats_, nodesExpanded);
+        if (mate_[r] == -1) {
+            reach = top.key;
+            flipFrom(r);
+            break;
+        }
+        int v = mate_[r];
+        distance_[v] = top.key;
+        touched_.push_back(v);
+        nearest = scan(v);
+    }
+    MATCHING_STAT_INC(stats_, augmentations);
+    MATCHING_STAT_INC(stats_, dualAdjustments);
+
+    /* Move the duals of everything settled by how far short of reach it was. Left
+     * people go down and right people go up, which keeps the tree's links tight
+     * and every other link covered.
+     */
+    for (int v: touched_) {
+        if (settled_[v] && distance_[v] <= reach) {
+            dual_[v] += side_[v] == leftSide_ ? distance_[v] - reach : reach - distance_[v];
+        }
+        distance_[v] = kFar;
+        settled_[v] = false;
+    }
+    touched_.clear();
+    heap_.clear();
+}
+
+long long BipartiteWeightedMatching::solve() {
+    MATCHING_STAT_MAX(stats_, peakWorkspaceBytes, arena_.peakBytes());
+    for (int v: left_) {
+        addPerson(v);
+    }
+
+    long long total = 0;
+    for (int v: left_) {
+        if (mate_[v] != -1) total += graph_.weight(v, mate_[v]);
+    }
+    return total;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "MatchingScore.h"
+#include "WeightedBlossomMatching.h"
+#include "BlossomMatching.h"
+#include "TestGraphs.h"
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("findBipartition colours two-sided graphs and rejects odd cycles") {
+    vector<char> side;
+    EXPECT(findBipartition(CompactGraph::fromLinks({
+        { "A", { "B" } }, { "B", { "A", "C" } }, { "C", { "B", "D" } }, { "D", { "C" } }, { "E", {} },
+    }), side));
+    EXPECT(side == vector<char>({ 0, 1, 0, 1, 0 }));
+
+    EXPECT(!findBipartition(CompactGraph::fromLinks({
+        { "A", { "B", "C" } }, { "B", { "A", "C" } }, { "C", { "A", "B" } },
+    }), side));
+}
+
+STUDENT_TEST("Hopcroft-Karp finds matchings as large as the blossom algorithm's") {
+    mt19937 generator(37);
+    for (int trial = 0; trial < 40; trial++) {
+        CompactGraph graph = randomTwoSidedGraph(generator, 5 + int(generator() % 30), 5 + int(generator() % 30),
+                                                 6, -2, 2);
+        vector<char> side;
+        EXPECT(findBipartition(graph, side));
+
+        HopcroftKarpMatching matcher(graph, side);
+        int pairs = matcher.maximumMatching();
+        BlossomMatching reference(graph);
+        EXPECT_EQUAL(pairs, reference.maximumMatching());
+
+        for (uint32_t v = 0; v < graph.numPeople(); v++) {
+            int m = matcher.mate(v);
+            if (m != -1) {
+                EXPECT_EQUAL(matcher.mate(m), int(v));
+                EXPECT(find(graph.neighboursBegin(v), graph.neighboursEnd(v), uint32_t(m)) != graph.neighboursEnd(v));
+            }
+        }
+    }
+}
+
+STUDENT_TEST("The Hungarian method matches the blossom algorithm's weight, with duals to prove it") {
+    mt19937 generator(41);
+    for (int trial = 0; trial < 40; trial++) {
+        CompactGraph graph = randomTwoSidedGraph(generator, 3 + int(generator() % 30), 3 + int(generator() % 30),
+                                                 3, -2, 22);
+        vector<char> side;
+        EXPECT(findBipartition(graph, side));
+
+        BipartiteWeightedMatching solver(graph, side);
+        long long weight = solver.solve();
+        WeightedBlossomMatching reference(graph);
+        EXPECT_EQUAL(weight, reference.solve());
+
+        MatchingScore score(graph);
+        score.assign(solver.mates());
+        EXPECT_EQUAL(score.total(), weight);
+
+        long long dualTotal = 0;
+        for (uint32_t v = 0; v < graph.numPeople(); v++) {
+            EXPECT(solver.dual(v) >= 0);
+            if (solver.mate(v) == -1) EXPECT_EQUAL(solver.dual(v), 0);
+            dualTotal += solver.dual(v);
+            for (uint32_t i = 0; i < graph.degree(v); i++) {
+                EXPECT(solver.dual(v) + solver.dual(graph.neighboursBegin(v)[i]) >= graph.weightsBegin(v)[i]);
+            }
+        }
+        EXPECT_EQUAL(dualTotal, weight);
+    }
+}
+
+STUDENT_TEST("The Hungarian method stays exact when many weights tie") {
+    mt19937 generator(43);
+    for (int trial = 0; trial < 40; trial++) {
+        CompactGraph graph = randomTwoSidedGraph(generator, 5 + int(generator() % 40), 5 + int(generator() % 40),
+                                                 1 + int(generator() % 3), 1, 1 + int(generator() % 2), trial % 2 == 1);
+        vector<char> side;
+        EXPECT(findBipartition(graph, side));
+
+        BipartiteWeightedMatching solver(graph, side);
+        WeightedBlossomMatching reference(graph);
+        EXPECT_EQUAL(solver.solve(), reference.solve());
+    }
+}
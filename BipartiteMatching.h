@@ -0,0 +1,151 @@
+#pragma once
+#include <vector>
+#include "Arena.h"
+#include "CompactGraph.h"
+#include "SolverStats.h"
+
+/* Splits everyone into two sides so that every link joins the two sides (mentors and
+ * mentees, reviewers and submissions), if that can be done. side[v] is 0 or 1; each
+ * connected group is coloured by breadth-first search from its lowest id, which goes
+ * on side 0. Returns false, leaving side unspecified, if some group has an odd
+ * cycle. O(n + m).
+ */
+bool findBipartition(const CompactGraph& graph, std::vector<char>& side);
+
+/* Maximum-cardinality matching in a bipartite graph using Hopcroft and Karp's
+ * algorithm: each phase finds the length of the shortest augmenting paths with one
+ * breadth-first search from every unpaired person on side 0, then flips a maximal
+ * set of disjoint paths of that length with depth-first searches that only step to
+ * the next layer. O(m sqrt(n)) in all, with no blossoms to look after.
+ *
+ * All working state is allocated from an Arena when the matcher is constructed,
+ * and matching doesn't grow the arena.
+ */
+class HopcroftKarpMatching {
+public:
+    /* side must be a bipartition of the graph (see findBipartition). The graph and
+     * arena must outlive the matcher; weights are ignored.
+     */
+    HopcroftKarpMatching(const CompactGraph& graph, const std::vector<char>& side, Arena& arena);
+    HopcroftKarpMatching(const CompactGraph& graph, const std::vector<char>& side);
+
+    /* Starts from an existing matching, which must be symmetric and only use links
+     * of the graph. Everyone paired in it stays paired.
+     */
+    void setMates(const std::vector<int>& mate);
+
+    /* Builds a maximum matching. Returns the number of pairs. */
+    int maximumMatching();
+
+    /* Counts what the matcher does into stats from now on (see SolverStats.h).
+     * Pass nullptr to stop.
+     */
+    void setStats(SolverStats* stats) {
+        stats_ = stats;
+    }
+
+    int mate(int v) const {
+        return mate_[v];
+    }
+    std::vector<int> mates() const {
+        return std::vector<int>(mate_.begin(), mate_.end());
+    }
+
+private:
+    bool buildLayers();
+    bool augmentFrom(int root);
+
+    Arena                ownArena_;
+    Arena&               arena_;
+    const CompactGraph&  graph_;
+    SolverStats*         stats_ = nullptr;
+    ArenaArray<int>      mate_;
+    ArenaArray<int>      layer_;       // For side-0 people: BFS depth, or kUnreached.
+    ArenaArray<uint32_t> nextLink_;    // For side-0 people: where their DFS resumes.
+    ArenaStack<int>      queue_;       // Side-0 people, in BFS order; also the DFS path.
+    ArenaArray<int>      pathRight_;   // The side-1 person each DFS step went through.
+    ArenaStack<int>      left_;        // Everyone on side 0.
+    int                  freeLayer_ = 0;
+    int                  pairs_ = 0;
+};
+
+/* Maximum-weight matching in a bipartite graph with the Hungarian method, in its
+ * sparse form (successive shortest paths with Dijkstra over reduced costs).
+ *
+ * People on the smaller side are added one at a time. Each addition runs one
+ * Dijkstra search from the new person over links with zero slack in the LP duals
+ * found so far, and stops at the first of: an unpaired person on the other side
+ * (the matching grows), or someone in the tree whose dual reaches zero (they give up
+ * their partner). The matching stays the heaviest possible among the people added
+ * so far, so after the last addition it is the heaviest overall. An unpaired person
+ * reached with no slack at all ends the search straight away, since nothing in the
+ * heap is nearer; with tied weights, most searches end like that instead of first
+ * settling everyone else at the same distance.
+ *
+ * Searches only touch the part of the graph near the new person and reset only
+ * what they touched, and all state is flat arrays in an Arena, so on sparse graphs
+ * this is much faster than the general blossom algorithm. Links with weight <= 0
+ * are never used; duals are exact integers since nothing has to be halved.
+ */
+class BipartiteWeightedMatching {
+public:
+    /* side must be a bipartition of the graph (see findBipartition). The graph and
+     * arena must outlive the solver.
+     */
+    BipartiteWeightedMatching(const CompactGraph& graph, const std::vector<char>& side, Arena& arena);
+    BipartiteWeightedMatching(const CompactGraph& graph, const std::vector<char>& side);
+
+    /* Runs the algorithm. Returns the total weight of the matching. */
+    long long solve();
+
+    /* Counts what the solver does into stats from now on (see SolverStats.h).
+     * Pass nullptr to stop.
+     */
+    void setStats(SolverStats* stats) {
+        stats_ = stats;
+    }
+
+    int mate(int v) const {
+        return mate_[v];
+    }
+    std::vector<int> mates() const {
+        return std::vector<int>(mate_.begin(), mate_.end());
+    }
+    int size() const {
+        return int(mate_.size());
+    }
+    /* Each person's dual. Every link's weight is at most the sum of its ends' duals,
+     * with equality on paired links, and unpaired people have dual 0, which proves
+     * the matching is the heaviest. The duals add up to its weight.
+     */
+    long long dual(int v) const {
+        return dual_[v];
+    }
+
+private:
+    struct HeapEntry {
+        long long key;
+        int       node;   // A person on the other side, or ~v to stop at v on this side.
+    };
+
+    void addPerson(int root);
+    void push(long long key, int node);
+    HeapEntry pop();
+    int  scan(int v);
+    void flipFrom(int right);
+
+    Arena                 ownArena_;
+    Arena&                arena_;
+    const CompactGraph&   graph_;
+    SolverStats*          stats_ = nullptr;
+    char                  leftSide_ = 0;   // The side people are added from.
+    ArenaArray<char>      side_;
+    ArenaArray<int>       mate_;
+    ArenaArray<long long> dual_;
+    ArenaArray<long long> distance_;   // From the current root, once settled (left) or reached (right).
+    ArenaArray<int>       reachedFrom_;
+    ArenaArray<char>      settled_;
+    ArenaStack<HeapEntry> heap_;
+    ArenaStack<int>       touched_;
+    ArenaStack<int>       left_;
+};
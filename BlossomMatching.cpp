@@ -0,0 +1,240 @@
+/*
+ * Edmonds' blossom algorithm for maximum-cardinality matching. See BlossomMatching.h.
+ */
+
+#include "BlossomMatching.h"
+#include <algorithm>
+using namespace std;
+
+BlossomMatching::BlossomMatching(const CompactGraph& graph, Arena& arena)
+    : arena_(arena),
+      graph_(graph),
+      mate_(arena, graph.numPeople(), -1),
+      parent_(arena, graph.numPeople(), -1),
+      base_(arena, graph.numPeople()),
+      inTree_(arena, graph.numPeople(), false),
+      inBlossom_(arena, graph.numPeople(), false),
+      ancestorStamp_(arena, graph.numPeople(), 0),
+      queue_(arena, graph.numPeople()),
+      touched_(arena, graph.numPeople()),
+      order_(arena, graph.numPeople()) {
+    for (int v = 0; v < size(); v++) {
+        base_[v] = v;
+    }
+}
+
+BlossomMatching::BlossomMatching(const CompactGraph& graph)
+    : BlossomMatching(graph, ownArena_) {
+}
+
+void BlossomMatching::greedyInitialMatching() {
+    /* Sort by degree, ties by id. (stable_sort would allocate a buffer.) */
+    for (int v = 0; v < size(); v++) {
+        order_[v] = v;
+    }
+    sort(order_.begin(), order_.end(), [&](int a, int b) {
+        if (graph_.degree(a) != graph_.degree(b)) return graph_.degree(a) < graph_.degree(b);
+        return a < b;
+    });
+
+    for (int v: order_) {
+        if (mate_[v] != -1) continue;
+
+        /* Prefer the free neighbour with the fewest options of their own. */
+        int best = -1;
+        for (const uint32_t* u = graph_.neighboursBegin(v); u != graph_.neighboursEnd(v); u++) {
+            if (mate_[*u] == -1 && (best == -1 || graph_.degree(*u) < graph_.degree(best))) {
+                best = int(*u);
+            }
+        }
+        if (best != -1) {
+            mate_[v] = best;
+            mate_[best] = v;
+        }
+    }
+}
+
+int BlossomMatching::maximumMatching() {
+    greedyInitialMatching();
+    for (int v = 0; v < size(); v++) {
+        if (mate_[v] == -1) augmentFrom(v);
+    }
+
+    int pairs = 0;
+    for (int v = 0; v < size(); v++) {
+        if (mate_[v] > v) pairs++;
+    }
+    return pairs;
+}
+
+bool BlossomMatching::perfectMatching() {
+    if (size() % 2 != 0) return false;
+
+    greedyInitialMatching();
+    for (int v = 0; v < size(); v++) {
+        /* If there is no augmenting path from v, some maximum matching leaves v
+         * unpaired, so no matching can be perfect.
+         */
+        if (mate_[v] == -1 && !augmentFrom(v)) return false;
+    }
+    return true;
+}
+
+void BlossomMatching::setMates(const vector<int>& mate) {
+    for (int v = 0; v < size(); v++) {
+        mate_[v] = mate[v];
+    }
+}
+
+void BlossomMatching::visit(int v) {
+    if (!inTree_[v] && parent_[v] == -1) touched_.push_back(v);
+}
+
+void BlossomMatching::resetTree() {
+    for (int v: touched_) {
+        parent_[v] = -1;
+        base_[v] = v;
+        inTree_[v] = false;
+        inBlossom_[v] = false;
+    }
+    touched_.clear();
+}
+
+int BlossomMatching::lowestCommonAncestor(int a, int b) {
+    stamp_++;
+
+    /* Walk from a to the root, stamping each blossom base along the way... */
+    while (true) {
+        a = base_[a];
+        ancestorStamp_[a] = stamp_;
+        if (mate_[a] == -1) break;
+        a = parent_[mate_[a]];
+    }
+
+    /* ... then walk from b until we hit one of them. */
+    while (true) {
+        b = base_[b];
+        if (ancestorStamp_[b] == stamp_) return b;
+        b = parent_[mate_[b]];
+    }
+}
+
+void BlossomMatching::markPath(int v, int base, int child) {
+    while (base_[v] != base) {
+        inBlossom_[base_[v]] = inBlossom_[base_[mate_[v]]] = true;
+        parent_[v] = child;
+        child = mate_[v];
+        v = parent_[mate_[v]];
+    }
+}
+
+bool BlossomMatching::augmentFrom(int root) {
+    MATCHING_STAT_MAX(stats_, peakWorkspaceBytes, arena_.peakBytes());
+    queue_.clear();
+    visit(root);
+    inTree_[root] = true;
+    queue_.push_back(root);
+
+    for (size_t head = 0; head < queue_.size(); head++) {
+        int v = queue_[head];
+        for (const uint32_t* next = graph_.neighboursBegin(v); next != graph_.neighboursEnd(v); next++) {
+            int to = int(*next);
+            if (base_[v] == base_[to] || mate_[v] == to) continue;
+
+            if (to == root || (mate_[to] != -1 && parent_[mate_[to]] != -1)) {
+                /* Odd cycle: contract it into a blossom based at the common ancestor. */
+                MATCHING_STAT_INC(stats_, blossomsShrunk);
+                int base = lowestCommonAncestor(v, to);
+                for (int u: touched_) {
+                    inBlossom_[u] = false;
+                }
+                markPath(v, base, to);
+                markPath(to, base, v);
+
+                for (int u: touched_) {
+                    if (inBlossom_[base_[u]]) {
+                        base_[u] = base;
+                        if (!inTree_[u]) {
+                            inTree_[u] = true;
+                            queue_.push_back(u);
+                        }
+                    }
+                }
+            } else if (parent_[to] == -1) {
+                visit(to);
+                parent_[to] = v;
+
+                if (mate_[to] == -1) {
+                    /* Augmenting path found: flip it back to the root. */
+                    int cur = to;
+                    while (cur != -1) {
+                        int prev = parent_[cur];
+                        int next = mate_[prev];
+                        mate_[cur] = prev;
+                        mate_[prev] = cur;
+                        cur = next;
+                    }
+                    MATCHING_STAT_INC(stats_, augmentations);
+                    MATCHING_STAT_ADD(stats_, nodesExpanded, head + 1);
+                    resetTree();
+                    return true;
+                }
+
+                int partner = mate_[to];
+                visit(partner);
+                inTree_[partner] = true;
+                queue_.push_back(partner);
+            }
+        }
+    }
+
+    MATCHING_STAT_ADD(stats_, nodesExpanded, queue_.size());
+    resetTree();
+    return false;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "GUI/SimpleTest.h"
+
+namespace {
+    /* A line of people, each with one extra partner hanging off them. */
+    CompactGraph millipede(int segments) {
+        CompactGraphBuilder builder;
+        for (int i = 0; i < 2 * segments; i++) {
+            builder.intern(to_string(i));
+        }
+        for (int i = 0; i < segments; i++) {
+            if (i + 1 < segments) builder.addLink(i, i + 1, 1);
+            builder.addLink(i, i + segments, 1);
+        }
+        return builder.build();
+    }
+}
+
+STUDENT_TEST("BlossomMatching doesn't grow its arena while searching") {
+    CompactGraph graph = millipede(1000);
+
+    Arena arena;
+    BlossomMatching engine(graph, arena);
+    size_t afterSetup = arena.heapAllocations();
+
+    EXPECT(engine.perfectMatching());
+    EXPECT_EQUAL(arena.heapAllocations(), afterSetup);
+}
+
+STUDENT_TEST("BlossomMatching can reuse an arena without growing it again") {
+    CompactGraph graph = millipede(500);
+    Arena arena;
+    {
+        BlossomMatching first(graph, arena);
+        EXPECT_EQUAL(first.maximumMatching(), 500);
+    }
+    arena.reset();
+    size_t afterReset = arena.heapAllocations();
+
+    BlossomMatching second(graph, arena);
+    EXPECT_EQUAL(second.maximumMatching(), 500);
+    EXPECT_EQUAL(arena.heapAllocations(), afterReset);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include "Arena.h"
+#include "CompactGraph.h"
+#include "SolverStats.h"
+
+/* Maximum-cardinality matching in a general (non-bipartite) graph using Edmonds'
+ * blossom algorithm. People are numbered 0 .. n - 1, and mate(v) is the person v
+ * is paired with, or -1 if v is unpaired.
+ *
+ * Each search grows an alternating tree from one unpaired person, contracting odd
+ * cycles ("blossoms") as it finds them, and flips the first augmenting path it
+ * reaches. Only the part of the graph the tree actually touched is reset between
+ * searches, so a search costs time proportional to the size of its tree.
+ *
+ * All working state is allocated from an Arena when the matcher is constructed,
+ * and searching doesn't grow the arena.
+ */
+class BlossomMatching {
+public:
+    /* Weights in the graph are ignored; every link counts the same. The graph and
+     * arena must outlive the matcher.
+     */
+    BlossomMatching(const CompactGraph& graph, Arena& arena);
+
+    /* Same, with a private arena. */
+    explicit BlossomMatching(const CompactGraph& graph);
+
+    /* Builds a maximum matching. Returns the number of pairs. */
+    int maximumMatching();
+
+    /* Returns whether everyone can be paired. Gives up as soon as one person is
+     * shown to be unpairable, so the matching may be partial if this returns false.
+     */
+    bool perfectMatching();
+
+    /* Starts from an existing matching instead of building one, so that callers
+     * who already have a maximum matching of a nearby graph can repair it with a
+     * few calls to augmentFrom. maximumMatching and perfectMatching also build on
+     * it, keeping everyone paired who already is. mate must be symmetric and only
+     * use links of the graph.
+     */
+    void setMates(const std::vector<int>& mate);
+
+    /* Grows an alternating tree from root, which must be unpaired, and flips the
+     * augmenting path it finds, if any. Returns whether the matching grew.
+     */
+    bool augmentFrom(int root);
+
+    /* Counts what the matcher does into stats from now on (see SolverStats.h).
+     * Pass nullptr to stop.
+     */
+    void setStats(SolverStats* stats) {
+        stats_ = stats;
+    }
+
+    int mate(int v) const {
+        return mate_[v];
+    }
+    std::vector<int> mates() const {
+        return std::vector<int>(mate_.begin(), mate_.end());
+    }
+    int size() const {
+        return int(mate_.size());
+    }
+
+private:
+    /* Pairs people greedily, lowest-degree first, so the blossom searches
+     * only have to fix up what the greedy pass got wrong.
+     */
+    void greedyInitialMatching();
+
+    int  lowestCommonAncestor(int a, int b);
+    void markPath(int v, int base, int child);
+    void visit(int v);
+    void resetTree();
+
+    Arena                ownArena_;
+    Arena&               arena_;
+    const CompactGraph&  graph_;
+    SolverStats*         stats_ = nullptr;
+    ArenaArray<int>      mate_;
+    ArenaArray<int>      parent_;     // Tree parent of each odd (outer-matched) vertex.
+    ArenaArray<int>      base_;       // Base of the blossom containing each vertex.
+    ArenaArray<char>     inTree_;     // Even vertices already queued in the current tree.
+    ArenaArray<char>     inBlossom_;  // Scratch marks while contracting a blossom.
+    ArenaArray<int>      ancestorStamp_;
+    int                  stamp_ = 0;
+    ArenaStack<int>      queue_;
+    ArenaStack<int>      touched_;    // Every vertex whose tree state must be reset.
+    ArenaArray<int>      order_;      // Scratch for greedyInitialMatching.
+};
@@ -0,0 +1,333 @@
+/*
+ * Interned, CSR-form preference graphs. See CompactGraph.h.
+ */
+
+#include "CompactGraph.h"
+#include <algorithm>
+using namespace std;
+
+namespace {
+    const uint32_t kFromHigherId = 1u << 31;
+
+    /* Storage for a graph built in memory. */
+    struct OwnedArrays {
+        vector<char>     names;
+        vector<uint64_t> nameOffsets;
+        vector<uint32_t> byName;
+        vector<uint64_t> offsets;
+        vector<uint32_t> targets;
+        vector<int32_t>  weights;
+    };
+
+    uint32_t slotId(uint64_t slot) {
+        return uint32_t(slot) - 1;
+    }
+    uint64_t makeSlot(uint64_t hash, uint32_t id) {
+        return (hash & 0xFFFFFFFF00000000ull) | (id + 1);
+    }
+}
+
+size_t CompactGraphBuilder::findSlot(string_view name, uint64_t hash) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+        uint64_t entry = slots_[slot];
+        if (entry == 0) return slot;
+        if ((entry >> 32) == (hash >> 32) && nameOf(slotId(entry)) == name) return slot;
+    }
+}
+
+void CompactGraphBuilder::growSlots() {
+    slots_.assign(max<size_t>(16, 2 * slots_.size()), 0);
+    for (uint32_t id = 0; id < numPeople(); id++) {
+        uint64_t hash = hashName(nameOf(id));
+        slots_[findSlot(nameOf(id), hash)] = makeSlot(hash, id);
+    }
+}
+
+uint64_t CompactGraphBuilder::hashName(string_view name) {
+    return hash<string_view>()(name);
+}
+
+void CompactGraphBuilder::prefetch(uint64_t hash) const {
+#if defined(__GNUC__)
+    if (!slots_.empty()) {
+        __builtin_prefetch(&slots_[hash & (slots_.size() - 1)]);
+    }
+#else
+    (void) hash;
+#endif
+}
+
+uint32_t CompactGraphBuilder::intern(string_view name) {
+    return intern(name, hashName(name));
+}
+
+uint32_t CompactGraphBuilder::intern(string_view name, uint64_t hash) {
+    /* Keep the table at most half full. */
+    if (2 * (size_t(numPeople()) + 1) > slots_.size()) growSlots();
+
+    size_t slot = findSlot(name, hash);
+    if (slots_[slot] == 0) {
+        slots_[slot] = makeSlot(hash, numPeople());
+        names_.insert(names_.end(), name.begin(), name.end());
+        nameOffsets_.push_back(names_.size());
+    }
+    return slotId(slots_[slot]);
+}
+
+bool CompactGraphBuilder::lookup(string_view name, uint32_t& id) const {
+    if (slots_.empty()) return false;
+
+    size_t slot = findSlot(name, hashName(name));
+    if (slots_[slot] == 0) return false;
+    id = slotId(slots_[slot]);
+    return true;
+}
+
+void CompactGraphBuilder::reserveLinks(size_t count) {
+    entries_.reserve(entries_.size() + count);
+}
+
+void CompactGraphBuilder::addLink(uint32_t from, uint32_t to, int32_t weight) {
+    if (from == to) return;
+
+    uint32_t order = uint32_t(entries_.size());
+    if (from > to) order |= kFromHigherId;
+    entries_.push_back({ min(from, to), max(from, to), order, weight });
+}
+
+CompactGraph CompactGraphBuilder::build() {
+    uint32_t n = numPeople();
+
+    /* Sort so that each pair's winning entry comes first, then drop the rest. */
+    sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+        if (a.low != b.low) return a.low < b.low;
+        if (a.high != b.high) return a.high < b.high;
+        return a.order < b.order;
+    });
+    auto last = unique(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+        return a.low == b.low && a.high == b.high;
+    });
+    entries_.erase(last, entries_.end());
+
+    /* Count degrees, then place each link in both rows. Because entries are sorted by
+     * (low, high), every row comes out sorted by neighbour id.
+     */
+    auto owned = make_shared<OwnedArrays>();
+    owned->offsets.assign(n + 1, 0);
+    for (const Entry& entry: entries_) {
+        owned->offsets[entry.low + 1]++;
+        owned->offsets[entry.high + 1]++;
+    }
+    for (uint32_t v = 0; v < n; v++) {
+        owned->offsets[v + 1] += owned->offsets[v];
+    }
+
+    owned->targets.resize(2 * entries_.size());
+    owned->weights.resize(2 * entries_.size());
+    vector<uint64_t> next(owned->offsets.begin(), owned->offsets.end() - 1);
+    for (const Entry& entry: entries_) {
+        owned->targets[next[entry.low]] = entry.high;
+        owned->weights[next[entry.low]++] = entry.weight;
+        owned->targets[next[entry.high]] = entry.low;
+        owned->weights[next[entry.high]++] = entry.weight;
+    }
+
+    owned->names = move(names_);
+    owned->nameOffsets = move(nameOffsets_);
+    auto name = [&](uint32_t id) {
+        return string_view(owned->names.data() + owned->nameOffsets[id],
+                           owned->nameOffsets[id + 1] - owned->nameOffsets[id]);
+    };
+    owned->byName.resize(n);
+    for (uint32_t v = 0; v < n; v++) {
+        owned->byName[v] = v;
+    }
+    sort(owned->byName.begin(), owned->byName.end(), [&](uint32_t a, uint32_t b) {
+        return name(a) < name(b);
+    });
+
+    CompactGraph::Arrays arrays;
+    arrays.numPeople = n;
+    arrays.numLinks = entries_.size();
+    arrays.names = owned->names.data();
+    arrays.nameOffsets = owned->nameOffsets.data();
+    arrays.byName = owned->byName.data();
+    arrays.offsets = owned->offsets.data();
+    arrays.targets = owned->targets.data();
+    arrays.weights = owned->weights.data();
+
+    *this = CompactGraphBuilder();
+    return CompactGraph::fromArrays(arrays, move(owned));
+}
+
+CompactGraph CompactGraph::fromArrays(const Arrays& arrays, shared_ptr<const void> owner) {
+    CompactGraph graph;
+    graph.arrays_ = arrays;
+    graph.owner_ = move(owner);
+    return graph;
+}
+
+CompactGraph CompactGraph::fromLinks(const Map<string, Set<string>>& possibleLinks) {
+    CompactGraphBuilder builder;
+    for (const string& person: possibleLinks) {
+        builder.intern(person);
+    }
+
+    uint32_t from = 0;
+    for (const string& person: possibleLinks) {
+        for (const string& other: possibleLinks[person]) {
+            uint32_t to;
+            if (builder.lookup(other, to)) {
+                builder.addLink(from, to, 1);
+            }
+        }
+        from++;
+    }
+    return builder.build();
+}
+
+CompactGraph CompactGraph::fromWeightedLinks(const Map<string, Map<string, int>>& possibleLinks) {
+    CompactGraphBuilder builder;
+    for (const string& person: possibleLinks) {
+        builder.intern(person);
+    }
+
+    uint32_t from = 0;
+    for (const string& person: possibleLinks) {
+        Map<string, int> linked = possibleLinks[person];
+        for (const string& other: linked) {
+            uint32_t to;
+            if (builder.lookup(other, to)) {
+                builder.addLink(from, to, linked[other]);
+            }
+        }
+        from++;
+    }
+    return builder.build();
+}
+
+Map<string, Set<string>> CompactGraph::toLinks() const {
+    Map<string, Set<string>> result;
+    for (uint32_t v = 0; v < numPeople(); v++) {
+        Set<string>& linked = result[string(name(v))];
+        for (const uint32_t* u = neighboursBegin(v); u != neighboursEnd(v); u++) {
+            linked += string(name(*u));
+        }
+    }
+    return result;
+}
+
+Map<string, Map<string, int>> CompactGraph::toWeightedLinks() const {
+    Map<string, Map<string, int>> result;
+    for (uint32_t v = 0; v < numPeople(); v++) {
+        Map<string, int>& linked = result[string(name(v))];
+        const int32_t* w = weightsBegin(v);
+        for (const uint32_t* u = neighboursBegin(v); u != neighboursEnd(v); u++, w++) {
+            linked[string(name(*u))] = *w;
+        }
+    }
+    return result;
+}
+
+Set<Pair> CompactGraph::toPairs(const vector<int>& mate) const {
+    Set<Pair> result;
+    for (int v = 0; v < int(mate.size()); v++) {
+        if (mate[v] > v) {
+            result += Pair(string(name(v)), string(name(mate[v])));
+        }
+    }
+    return result;
+}
+
+bool CompactGraph::findPerson(string_view name, uint32_t& id) const {
+    const uint32_t* end = arrays_.byName + numPeople();
+    const uint32_t* it = lower_bound(arrays_.byName, end, name, [&](uint32_t v, string_view key) {
+        return this->name(v) < key;
+    });
+    if (it == end || this->name(*it) != name) return false;
+    id = *it;
+    return true;
+}
+
+int32_t CompactGraph::weight(uint32_t u, uint32_t v) const {
+    const uint32_t* it = lower_bound(neighboursBegin(u), neighboursEnd(u), v);
+    if (it == neighboursEnd(u) || *it != v) return 0;
+    return weightsBegin(u)[it - neighboursBegin(u)];
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("CompactGraph round-trips a weighted preference map") {
+    Map<string, Map<string, int>> links = {
+        { "A", { { "B", 3 }, { "C", -1 } } },
+        { "B", { { "A", 3 } } },
+        { "C", { { "A", -1 } } },
+        { "D", {} }
+    };
+
+    CompactGraph graph = CompactGraph::fromWeightedLinks(links);
+    EXPECT_EQUAL(graph.numPeople(), 4);
+    EXPECT_EQUAL(graph.numLinks(), 2);
+    EXPECT_EQUAL(graph.toWeightedLinks(), links);
+}
+
+STUDENT_TEST("CompactGraph keeps links only one person lists, with that person's weight") {
+    /* Bo lists Ana but not the other way round; Cy and Di list each other differently. */
+    CompactGraph graph = CompactGraph::fromWeightedLinks({
+        { "Ana", {} },
+        { "Bo",  { { "Ana", 4 } } },
+        { "Cy",  { { "Di", 2 } } },
+        { "Di",  { { "Cy", 7 }, { "Nobody", 9 } } },
+    });
+    EXPECT_EQUAL(graph.numLinks(), 2);
+    EXPECT_EQUAL(graph.weight(0, 1), 4);
+    EXPECT_EQUAL(graph.weight(1, 0), 4);
+    EXPECT_EQUAL(graph.weight(2, 3), 2);
+    EXPECT_EQUAL(graph.weight(3, 2), 2);
+}
+
+STUDENT_TEST("CompactGraph numbers people in sorted order and finds them by name") {
+    CompactGraph graph = CompactGraph::fromLinks({
+        { "Carol", { "Alice" } },
+        { "Alice", { "Bob", "Carol" } },
+        { "Bob",   {} }
+    });
+
+    EXPECT_EQUAL(string(graph.name(0)), "Alice");
+    EXPECT_EQUAL(string(graph.name(2)), "Carol");
+
+    uint32_t id;
+    EXPECT(graph.findPerson("Bob", id));
+    EXPECT_EQUAL(id, 1);
+    EXPECT(!graph.findPerson("Dave", id));
+
+    /* Bob doesn't list Alice, but Alice lists Bob, so they're linked. */
+    EXPECT_EQUAL(graph.degree(1), 1);
+    EXPECT_EQUAL(graph.weight(1, 0), 1);
+    EXPECT_EQUAL(graph.weight(1, 2), 0);
+}
+
+STUDENT_TEST("CompactGraph ignores self-links and names that aren't people") {
+    CompactGraph graph = CompactGraph::fromWeightedLinks({
+        { "A", { { "A", 5 }, { "B", 2 }, { "Nobody", 9 } } },
+        { "B", {} }
+    });
+
+    EXPECT_EQUAL(graph.numPeople(), 2);
+    EXPECT_EQUAL(graph.numLinks(), 1);
+    EXPECT_EQUAL(graph.weight(0, 0), 0);
+}
+
+STUDENT_TEST("CompactGraph resolves conflicting weights in favour of the alphabetically first person") {
+    CompactGraph graph = CompactGraph::fromWeightedLinks({
+        { "A", { { "B", 4 } } },
+        { "B", { { "A", 7 } } }
+    });
+
+    EXPECT_EQUAL(graph.weight(0, 1), 4);
+    EXPECT_EQUAL(graph.weight(1, 0), 4);
+}
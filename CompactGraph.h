@@ -0,0 +1,169 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Matchmaker.h"
+#include "map.h"
+#include "set.h"
+
+/* A preference graph with every name interned once into a dense id 0 .. n - 1.
+ *
+ * Links are undirected and stored in compressed sparse row (CSR) form: the
+ * neighbours of person v are the contiguous range neighboursBegin(v) ..
+ * neighboursEnd(v), sorted by id, with the link weights in a parallel array
+ * starting at weightsBegin(v). Each link is stored once in each direction,
+ * with the same weight both ways.
+ *
+ * A graph never changes once built. Its arrays live either in memory the graph
+ * owns or in someone else's (say, a mapped snapshot file; see GraphSnapshot.h),
+ * and copies share them, so copying a graph is cheap.
+ */
+class CompactGraph {
+public:
+    /* Creates a graph with no people. */
+    CompactGraph() = default;
+
+    /* People are the keys of the map, numbered in the map's (sorted) order. A link
+     * exists if either person lists the other; links to names that aren't keys
+     * are ignored. Unweighted links get weight 1. If both people list each other
+     * with different weights, the alphabetically first person's weight wins.
+     *
+     * For weighted maps this differs from the original recursive search behind
+     * maximumWeightMatching, which only saw a link if the alphabetically first of
+     * the two listed the other: a link only the later person lists used to be
+     * ignored, and now counts with their weight.
+     */
+    static CompactGraph fromLinks(const Map<std::string, Set<std::string>>& possibleLinks);
+    static CompactGraph fromWeightedLinks(const Map<std::string, Map<std::string, int>>& possibleLinks);
+
+    Map<std::string, Set<std::string>> toLinks() const;
+    Map<std::string, Map<std::string, int>> toWeightedLinks() const;
+
+    /* Turns a mate array (mate[v] is v's partner, or -1) back into named pairs. */
+    Set<Pair> toPairs(const std::vector<int>& mate) const;
+
+    /* The arrays behind a graph. */
+    struct Arrays {
+        uint32_t        numPeople = 0;
+        uint64_t        numLinks = 0;      // Undirected; targets and weights hold twice as many.
+        const char*     names = nullptr;   // All names, back to back.
+        const uint64_t* nameOffsets = kNoOffsets;  // numPeople + 1 offsets into names.
+        const uint32_t* byName = nullptr;  // Ids sorted by name, for findPerson.
+        const uint64_t* offsets = kNoOffsets;      // numPeople + 1 offsets into targets.
+        const uint32_t* targets = nullptr;
+        const int32_t*  weights = nullptr;
+    };
+
+    /* Wraps arrays that someone else laid out. They must describe a valid graph (rows
+     * sorted, every link present both ways with one weight, byName sorted), and stay
+     * put for as long as owner, which every copy of the graph keeps alive.
+     */
+    static CompactGraph fromArrays(const Arrays& arrays, std::shared_ptr<const void> owner);
+
+    const Arrays& arrays() const {
+        return arrays_;
+    }
+
+    uint32_t numPeople() const {
+        return arrays_.numPeople;
+    }
+    /* Number of undirected links. */
+    uint64_t numLinks() const {
+        return arrays_.numLinks;
+    }
+
+    std::string_view name(uint32_t id) const {
+        return std::string_view(arrays_.names + arrays_.nameOffsets[id],
+                                arrays_.nameOffsets[id + 1] - arrays_.nameOffsets[id]);
+    }
+    /* Looks up a person's id by name. Returns false if there is no such person. */
+    bool findPerson(std::string_view name, uint32_t& id) const;
+
+    uint64_t offset(uint32_t v) const {
+        return arrays_.offsets[v];
+    }
+    uint32_t degree(uint32_t v) const {
+        return uint32_t(arrays_.offsets[v + 1] - arrays_.offsets[v]);
+    }
+    const uint32_t* neighboursBegin(uint32_t v) const {
+        return arrays_.targets + arrays_.offsets[v];
+    }
+    const uint32_t* neighboursEnd(uint32_t v) const {
+        return arrays_.targets + arrays_.offsets[v + 1];
+    }
+    const int32_t* weightsBegin(uint32_t v) const {
+        return arrays_.weights + arrays_.offsets[v];
+    }
+
+    /* Returns the weight of the link between u and v, or 0 if they aren't linked. */
+    int32_t weight(uint32_t u, uint32_t v) const;
+
+private:
+    /* Offsets for a graph with no people. */
+    static constexpr uint64_t kNoOffsets[1] = { 0 };
+
+    Arrays                      arrays_;
+    std::shared_ptr<const void> owner_;    // Keeps arrays_ alive.
+};
+
+/* Builds a CompactGraph from names and directed preference entries. */
+class CompactGraphBuilder {
+public:
+    /* Returns the id for name, assigning the next free id the first time a name is seen. */
+    uint32_t intern(std::string_view name);
+
+    /* For bulk loaders: the same as intern(name), given hashName(name). Calling
+     * prefetch(hash) some way ahead of intern lets the table lookups of several
+     * names overlap instead of waiting on memory one at a time.
+     */
+    static uint64_t hashName(std::string_view name);
+    void     prefetch(uint64_t hash) const;
+    uint32_t intern(std::string_view name, uint64_t hash);
+
+    /* Looks up an already-interned name without adding it. */
+    bool lookup(std::string_view name, uint32_t& id) const;
+
+    /* Records that `from` listed `to` with the given weight. Self-links are ignored.
+     * If a pair is listed more than once, the first entry made by the lower id wins,
+     * falling back to the first entry made by the higher id.
+     */
+    void addLink(uint32_t from, uint32_t to, int32_t weight);
+
+    uint32_t numPeople() const {
+        return uint32_t(nameOffsets_.size() - 1);
+    }
+
+    /* Makes room for this many more addLink calls without reallocating. */
+    void reserveLinks(size_t count);
+
+    /* Produces the graph. The builder is left empty. */
+    CompactGraph build();
+
+private:
+    struct Entry {
+        uint32_t low;
+        uint32_t high;
+        uint32_t order;  // Entry's sequence number, with the top bit set if made by the higher id.
+        int32_t  weight;
+    };
+
+    std::string_view nameOf(uint32_t id) const {
+        return std::string_view(names_.data() + nameOffsets_[id], nameOffsets_[id + 1] - nameOffsets_[id]);
+    }
+
+    /* Slot where name is, or the empty slot where it would go. */
+    size_t findSlot(std::string_view name, uint64_t hash) const;
+    void   growSlots();
+
+    std::vector<char>     names_;
+    std::vector<uint64_t> nameOffsets_ = { 0 };
+    std::vector<Entry>    entries_;
+
+    /* Open-addressing table from names to ids. Each slot holds the top half of the name's
+     * hash and id + 1, or 0 if it's empty. Probes only compare against names_ when the
+     * hashes agree, and looking a name up never copies it.
+     */
+    std::vector<uint64_t> slots_;
+};
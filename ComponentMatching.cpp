@@ -0,0 +1,332 @@
+/*
+ * Solving each connected group of a graph on its own. See ComponentMatching.h.
+ */
+
+#include "ComponentMatching.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include "Arena.h"
+#include "Matchmaker.h"
+using namespace std;
+
+GraphComponents::GraphComponents(const CompactGraph& graph)
+    : graph_(graph) {
+    uint32_t n = graph.numPeople();
+
+    /* Union-find, by size with path halving. */
+    vector<uint32_t> parent(n);
+    vector<uint32_t> groupSize(n, 1);
+    iota(parent.begin(), parent.end(), 0);
+    auto find = [&](uint32_t v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+    for (uint32_t v = 0; v < n; v++) {
+        for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++) {
+            if (*u < v) continue;
+            uint32_t a = find(v), b = find(*u);
+            if (a == b) continue;
+            if (groupSize[a] < groupSize[b]) swap(a, b);
+            parent[b] = a;
+            groupSize[a] += groupSize[b];
+        }
+    }
+
+    /* Number the groups by their lowest member, then lay the members out group by group. */
+    componentOf_.assign(n, -1);
+    vector<int> numbered(n, -1);
+    int count = 0;
+    for (uint32_t v = 0; v < n; v++) {
+        uint32_t root = find(v);
+        if (numbered[root] == -1) numbered[root] = count++;
+        componentOf_[v] = numbered[root];
+    }
+
+    memberStart_.assign(count + 1, 0);
+    for (uint32_t v = 0; v < n; v++) {
+        memberStart_[componentOf_[v] + 1]++;
+    }
+    partial_sum(memberStart_.begin(), memberStart_.end(), memberStart_.begin());
+
+    members_.resize(n);
+    localId_.resize(n);
+    vector<size_t> next(memberStart_.begin(), memberStart_.end() - 1);
+    for (uint32_t v = 0; v < n; v++) {
+        int c = componentOf_[v];
+        localId_[v] = uint32_t(next[c] - memberStart_[c]);
+        members_[next[c]++] = v;
+    }
+}
+
+CompactGraph GraphComponents::subgraph(int component) const {
+    CompactGraphBuilder builder;
+    size_t numEntries = 0;
+    for (const uint32_t* v = membersBegin(component); v != membersEnd(component); v++) {
+        builder.intern(graph_.name(*v));
+        numEntries += graph_.degree(*v);
+    }
+    builder.reserveLinks(numEntries / 2);
+
+    for (const uint32_t* v = membersBegin(component); v != membersEnd(component); v++) {
+        const uint32_t* neighbours = graph_.neighboursBegin(*v);
+        const int32_t* weights = graph_.weightsBegin(*v);
+        for (uint32_t i = 0; i < graph_.degree(*v); i++) {
+            if (neighbours[i] > *v) {
+                builder.addLink(localId_[*v], localId_[neighbours[i]], weights[i]);
+            }
+        }
+    }
+    return builder.build();
+}
+
+namespace {
+    /* Calls solve(component, workspace, stats) on every group in order, spread over
+     * worker threads that take the next group from a shared counter. Each worker
+     * resets one arena between groups (the first worker uses workspace, if given)
+     * and counts into its own stats, which are merged into stats at the end.
+     */
+    template <typename Solve>
+    void solveComponents(const vector<int>& order, uint32_t numPeople, const ComponentOptions& options,
+                         Arena* workspace, SolverStats* stats, Solve solve) {
+        int numThreads = options.numThreads > 0 ? options.numThreads : int(thread::hardware_concurrency());
+        int affordable = int(numPeople / uint32_t(max(1, options.minPeoplePerThread)));
+        numThreads = max(1, min({ numThreads, affordable, int(order.size()) }));
+
+        vector<SolverStats> workerStats(numThreads);
+        atomic<size_t> next { 0 };
+        auto work = [&](int worker) {
+            Arena ownWorkspace;
+            Arena& arena = worker == 0 && workspace != nullptr ? *workspace : ownWorkspace;
+            SolverStats* counts = stats == nullptr ? nullptr : &workerStats[worker];
+            for (size_t i = next++; i < order.size(); i = next++) {
+                solve(order[i], arena, counts);
+                arena.reset();
+            }
+        };
+
+        if (numThreads == 1) {
+            work(0);
+        } else {
+            vector<thread> workers;
+            for (int worker = 0; worker < numThreads; worker++) {
+                workers.emplace_back(work, worker);
+            }
+            for (thread& worker: workers) {
+                worker.join();
+            }
+        }
+
+        if (stats != nullptr) {
+            for (const SolverStats& counts: workerStats) {
+                stats->merge(counts);
+            }
+        }
+    }
+
+    /* Biggest groups first, so no thread is left with a big one at the end. */
+    void largestFirst(const GraphComponents& components, vector<int>& order) {
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return components.size(a) > components.size(b);
+        });
+    }
+}
+
+vector<int> maximumWeightMatchingByComponent(const CompactGraph& graph, Arena& workspace,
+                                             const ComponentOptions& options, SolverStats* stats) {
+    GraphComponents components(graph);
+    if (components.numComponents() <= 1) {
+        return maximumWeightMatchingById(graph, workspace, stats);
+    }
+
+    vector<int> mate(graph.numPeople(), -1);
+    vector<int> order;
+    for (int c = 0; c < components.numComponents(); c++) {
+        if (components.size(c) == 2) {
+            /* Two people and the one link between them. */
+            uint32_t one = components.membersBegin(c)[0];
+            if (graph.weightsBegin(one)[0] > 0) {
+                uint32_t two = graph.neighboursBegin(one)[0];
+                mate[one] = int(two);
+                mate[two] = int(one);
+            }
+        } else if (components.size(c) > 2) {
+            order.push_back(c);
+        }
+    }
+    largestFirst(components, order);
+
+    /* Groups don't share people, so workers write to disjoint parts of mate. */
+    solveComponents(order, graph.numPeople(), options, &workspace, stats, [&](int c, Arena& arena, SolverStats* counts) {
+        vector<int> local = maximumWeightMatchingById(components.subgraph(c), arena, counts);
+        const uint32_t* members = components.membersBegin(c);
+        for (size_t i = 0; i < local.size(); i++) {
+            if (local[i] != -1) mate[members[i]] = int(members[local[i]]);
+        }
+    });
+    return mate;
+}
+
+vector<int> maximumWeightMatchingByComponent(const CompactGraph& graph, const ComponentOptions& options,
+                                             SolverStats* stats) {
+    Arena workspace;
+    return maximumWeightMatchingByComponent(graph, workspace, options, stats);
+}
+
+bool hasPerfectMatchingByComponent(const CompactGraph& graph, vector<int>& mate, MatchingObstruction& why,
+                                   const ComponentOptions& options, SolverStats* stats) {
+    GraphComponents components(graph);
+    if (components.numComponents() <= 1) {
+        return hasPerfectMatchingById(graph, mate, why, stats);
+    }
+
+    mate.assign(graph.numPeople(), -1);
+    why = MatchingObstruction();
+
+    /* The lowest-numbered group known to fail. Groups after it are skipped. */
+    mutex failureLock;
+    atomic<int> firstFailure { INT_MAX };
+
+    vector<int> order;
+    for (int c = 0; c < components.numComponents() && c < firstFailure; c++) {
+        const uint32_t* members = components.membersBegin(c);
+        if (components.size(c) == 1) {
+            why.kind = MatchingObstruction::kIsolatedPerson;
+            why.people = { int(members[0]) };
+            firstFailure = c;
+        } else if (components.size(c) == 2) {
+            mate[members[0]] = int(members[1]);
+            mate[members[1]] = int(members[0]);
+        } else {
+            order.push_back(c);
+        }
+    }
+    largestFirst(components, order);
+
+    solveComponents(order, graph.numPeople(), options, nullptr, stats, [&](int c, Arena&, SolverStats* counts) {
+        if (c > firstFailure) return;
+
+        vector<int> local;
+        MatchingObstruction localWhy;
+        const uint32_t* members = components.membersBegin(c);
+        if (hasPerfectMatchingById(components.subgraph(c), local, localWhy, counts)) {
+            for (size_t i = 0; i < local.size(); i++) {
+                mate[members[i]] = int(members[local[i]]);
+            }
+            return;
+        }
+
+        lock_guard<mutex> guard(failureLock);
+        if (c < firstFailure) {
+            firstFailure = c;
+            why.kind = localWhy.kind;
+            why.people.clear();
+            for (int person: localWhy.people) {
+                why.people.push_back(int(members[person]));
+            }
+        }
+    });
+
+    if (firstFailure != INT_MAX) {
+        mate.assign(graph.numPeople(), -1);
+        return false;
+    }
+    return true;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "MatchingScore.h"
+#include "GUI/SimpleTest.h"
+
+namespace {
+    /* Many small random groups, none linked to another. */
+    CompactGraph clusters(mt19937& generator, int numGroups, int groupSize) {
+        CompactGraphBuilder builder;
+        for (int i = 0; i < numGroups * groupSize; i++) {
+            builder.intern(to_string(i));
+        }
+        for (int group = 0; group < numGroups; group++) {
+            int first = group * groupSize;
+            for (int u = first; u < first + groupSize; u++) {
+                for (int v = u + 1; v < first + groupSize; v++) {
+                    if (generator() % 3 == 0) builder.addLink(u, v, int(generator() % 9) - 1);
+                }
+            }
+        }
+        return builder.build();
+    }
+}
+
+STUDENT_TEST("GraphComponents splits a graph into its connected groups") {
+    CompactGraph graph = CompactGraph::fromLinks({
+        { "A", { "C" } }, { "B", {} }, { "C", { "E" } }, { "D", { "F" } }, { "E", {} }, { "F", {} },
+    });
+    GraphComponents components(graph);
+    EXPECT_EQUAL(components.numComponents(), 3);
+    EXPECT_EQUAL(components.componentOf(4), 0);
+    EXPECT_EQUAL(components.componentOf(1), 1);
+    EXPECT_EQUAL(components.size(2), 2);
+    EXPECT_EQUAL(components.localId(2), 1);
+
+    CompactGraph group = components.subgraph(0);
+    EXPECT_EQUAL(group.toLinks(), { { "A", { "C" } }, { "C", { "A", "E" } }, { "E", { "C" } } });
+}
+
+STUDENT_TEST("Solving group by group gives the same answers as solving everyone at once") {
+    mt19937 generator(3);
+    CompactGraph graph = clusters(generator, 300, 9);
+
+    MatchingScore expected(graph);
+    expected.assign(maximumWeightMatchingById(graph));
+    MatchingScore score(graph);
+    for (int threads: { 1, 4 }) {
+        ComponentOptions options;
+        options.numThreads = threads;
+        options.minPeoplePerThread = 1;
+        score.assign(maximumWeightMatchingByComponent(graph, options));
+        EXPECT_EQUAL(score.total(), expected.total());
+
+        vector<int> unused;
+        MatchingObstruction why;
+        EXPECT_EQUAL(hasPerfectMatchingByComponent(graph, unused, why, options),
+                     hasPerfectMatchingById(graph, unused));
+    }
+}
+
+STUDENT_TEST("hasPerfectMatchingByComponent blames the first group that fails, on any number of threads") {
+    /* Rings of four, except that groups 41 and 71 are a triangle and someone on their own. */
+    CompactGraphBuilder builder;
+    for (int i = 0; i < 100 * 4; i++) {
+        builder.intern(to_string(i));
+    }
+    for (int group = 0; group < 100; group++) {
+        int first = 4 * group;
+        int ringSize = group == 41 || group == 71 ? 3 : 4;
+        for (int i = 0; i < ringSize; i++) {
+            builder.addLink(first + i, first + (i + 1) % ringSize, 1);
+        }
+    }
+    CompactGraph graph = builder.build();
+
+    for (int threads: { 1, 3 }) {
+        ComponentOptions options;
+        options.numThreads = threads;
+        options.minPeoplePerThread = 1;
+
+        vector<int> mate;
+        MatchingObstruction why;
+        EXPECT(!hasPerfectMatchingByComponent(graph, mate, why, options));
+        EXPECT_EQUAL(why.kind, MatchingObstruction::kOddComponent);
+        EXPECT(why.people == vector<int>({ 164, 165, 166 }));
+        EXPECT_EQUAL(count(mate.begin(), mate.end(), -1), int(mate.size()));
+    }
+}
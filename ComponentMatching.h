@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "CompactGraph.h"
+#include "PerfectMatchingPrecheck.h"
+#include "SolverStats.h"
+
+class Arena;
+
+/* The connected groups of a graph, found with union-find. Groups are numbered in
+ * order of their lowest id, and each group's members are listed in id order.
+ */
+class GraphComponents {
+public:
+    explicit GraphComponents(const CompactGraph& graph);
+
+    int numComponents() const {
+        return int(memberStart_.size()) - 1;
+    }
+    int componentOf(uint32_t v) const {
+        return componentOf_[v];
+    }
+    int size(int component) const {
+        return int(memberStart_[component + 1] - memberStart_[component]);
+    }
+    const uint32_t* membersBegin(int component) const {
+        return members_.data() + memberStart_[component];
+    }
+    const uint32_t* membersEnd(int component) const {
+        return members_.data() + memberStart_[component + 1];
+    }
+    /* v's position among its group's members, which is its id in subgraph(). */
+    uint32_t localId(uint32_t v) const {
+        return localId_[v];
+    }
+
+    /* One group as a graph of its own, with the same names and weights. */
+    CompactGraph subgraph(int component) const;
+
+private:
+    const CompactGraph&   graph_;
+    std::vector<int>      componentOf_;
+    std::vector<uint32_t> localId_;
+    std::vector<size_t>   memberStart_;   // CSR offsets into members_.
+    std::vector<uint32_t> members_;
+};
+
+struct ComponentOptions {
+    /* Worker threads. 0 means one per hardware thread. */
+    int numThreads = 0;
+
+    /* Threads are only started for graphs with at least this many people per thread,
+     * since smaller ones finish before a thread would get going.
+     */
+    int minPeoplePerThread = 20000;
+};
+
+/* maximumWeightMatchingById, one connected group at a time.
+ *
+ * A matching never pairs people from different groups, so each group is solved
+ * on its own and the answers put side by side: the cost is the sum of the groups'
+ * costs rather than that of one search over everyone, which for the blossom
+ * solvers is superlinear. Groups of one or two are settled without a solver, and
+ * groups are handed to worker threads from a shared counter, largest first.
+ */
+std::vector<int> maximumWeightMatchingByComponent(const CompactGraph& graph,
+                                                  const ComponentOptions& options = ComponentOptions(),
+                                                  SolverStats* stats = nullptr);
+
+/* The same, with the calling thread solving its groups in workspace, which is reset
+ * between them, like maximumWeightMatchingById(graph, workspace).
+ */
+std::vector<int> maximumWeightMatchingByComponent(const CompactGraph& graph, Arena& workspace,
+                                                  const ComponentOptions& options = ComponentOptions(),
+                                                  SolverStats* stats = nullptr);
+
+/* hasPerfectMatchingById, one connected group at a time. Stops handing out groups
+ * once one is shown to have no perfect matching. If several don't, why is for the
+ * one with the lowest ids, whatever order they were solved in.
+ */
+bool hasPerfectMatchingByComponent(const CompactGraph& graph, std::vector<int>& mate, MatchingObstruction& why,
+                                   const ComponentOptions& options = ComponentOptions(),
+                                   SolverStats* stats = nullptr);
@@ -0,0 +1,471 @@
+/*
+ * Row loops for dense weight matrices, with AVX-512 and AVX2 versions picked at run
+ * time. See DenseKernels.h.
+ */
+
+#include "DenseKernels.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <vector>
+using namespace std;
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define DENSE_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define DENSE_KERNELS_X86 0
+#endif
+
+namespace {
+    RowMaximum rowMaximumScalar(const int32_t* row, int count) {
+        RowMaximum best = { INT32_MIN, -1 };
+        for (int j = 0; j < count; j++) {
+            if (best.index == -1 || row[j] > best.value) best = { row[j], j };
+        }
+        return best;
+    }
+
+    SlackMinimum relaxRowScalar(const int32_t* row, long long rowDual, const long long* columnDual,
+                                const char* inTree, long long* slack, int32_t* from, int32_t source, int count) {
+        SlackMinimum best = { LLONG_MAX, -1 };
+        for (int j = 0; j < count; j++) {
+            if (inTree[j]) continue;
+            long long reduced = -(long long)max(row[j], 0) - rowDual - columnDual[j];
+            if (reduced < slack[j]) {
+                slack[j] = reduced;
+                from[j] = source;
+            }
+            if (best.index == -1 || slack[j] < best.value) best = { slack[j], j };
+        }
+        return best;
+    }
+
+    void shiftDualsScalar(long long* columnDual, long long* slack, const char* inTree, long long delta, int count) {
+        for (int j = 0; j < count; j++) {
+            if (inTree[j]) {
+                columnDual[j] -= delta;
+            } else {
+                slack[j] -= delta;
+            }
+        }
+    }
+
+    long long matchingWeightScalar(const int32_t* matrix, size_t stride, const int* columnOf, int rows) {
+        long long total = 0;
+        for (int r = 0; r < rows; r++) {
+            if (columnOf[r] >= 0) total += matrix[size_t(r) * stride + size_t(columnOf[r])];
+        }
+        return total;
+    }
+
+#if DENSE_KERNELS_X86
+    /* Folds per-lane bests into one: the smallest value, and the lowest index among lanes
+     * that have it. Lanes that never saw a column have index -1.
+     */
+    SlackMinimum smallestLane(const long long* values, const long long* indices, int lanes) {
+        SlackMinimum best = { LLONG_MAX, -1 };
+        for (int k = 0; k < lanes; k++) {
+            if (indices[k] == -1) continue;
+            if (best.index == -1 || values[k] < best.value || (values[k] == best.value && indices[k] < best.index)) {
+                best = { values[k], int(indices[k]) };
+            }
+        }
+        return best;
+    }
+
+    RowMaximum largestLane(const int32_t* values, const int32_t* indices, int lanes) {
+        RowMaximum best = { values[0], indices[0] };
+        for (int k = 1; k < lanes; k++) {
+            if (values[k] > best.value || (values[k] == best.value && indices[k] < best.index)) {
+                best = { values[k], indices[k] };
+            }
+        }
+        return best;
+    }
+
+    /* Vector loops leave the last few columns to these, which is why each keeps its
+     * running best and only takes strictly better ones: the tail columns come last.
+     */
+    void finishRowMaximum(const int32_t* row, int begin, int count, RowMaximum& best) {
+        for (int j = begin; j < count; j++) {
+            if (row[j] > best.value) best = { row[j], j };
+        }
+    }
+
+    void finishRelaxRow(const int32_t* row, long long rowDual, const long long* columnDual, const char* inTree,
+                        long long* slack, int32_t* from, int32_t source, int begin, int count, SlackMinimum& best) {
+        for (int j = begin; j < count; j++) {
+            if (inTree[j]) continue;
+            long long reduced = -(long long)max(row[j], 0) - rowDual - columnDual[j];
+            if (reduced < slack[j]) {
+                slack[j] = reduced;
+                from[j] = source;
+            }
+            if (best.index == -1 || slack[j] < best.value) best = { slack[j], j };
+        }
+    }
+
+    /* Four bytes of inTree, widened to one 64-bit lane each. */
+    __attribute__((target("avx2"))) __m256i loadTreeFlags4(const char* inTree) {
+        int32_t bytes;
+        memcpy(&bytes, inTree, sizeof(bytes));
+        return _mm256_cvtepi8_epi64(_mm_cvtsi32_si128(bytes));
+    }
+
+    /* The low halves of four 64-bit lane masks, as four 32-bit lane masks. */
+    __attribute__((target("avx2"))) __m128i narrowMask(__m256i mask) {
+        return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(mask, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+    }
+
+    __attribute__((target("avx2")))
+    RowMaximum rowMaximumAvx2(const int32_t* row, int count) {
+        if (count < 8) return rowMaximumScalar(row, count);
+
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i best = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row));
+        __m256i bestIndex = index;
+        const __m256i step = _mm256_set1_epi32(8);
+        int j = 8;
+        for (; j + 8 <= count; j += 8) {
+            index = _mm256_add_epi32(index, step);
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + j));
+            __m256i greater = _mm256_cmpgt_epi32(values, best);
+            best = _mm256_max_epi32(best, values);
+            bestIndex = _mm256_blendv_epi8(bestIndex, index, greater);
+        }
+
+        alignas(32) int32_t values[8];
+        alignas(32) int32_t indices[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values), best);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(indices), bestIndex);
+        RowMaximum result = largestLane(values, indices, 8);
+        finishRowMaximum(row, j, count, result);
+        return result;
+    }
+
+    __attribute__((target("avx2")))
+    SlackMinimum relaxRowAvx2(const int32_t* row, long long rowDual, const long long* columnDual,
+                              const char* inTree, long long* slack, int32_t* from, int32_t source, int count) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i negatedRowDual = _mm256_set1_epi64x(-rowDual);
+        const __m128i sources = _mm_set1_epi32(source);
+        const __m256i step = _mm256_set1_epi64x(4);
+        __m256i index = _mm256_setr_epi64x(0, 1, 2, 3);
+        __m256i bestValue = _mm256_set1_epi64x(LLONG_MAX);
+        __m256i bestIndex = _mm256_set1_epi64x(-1);
+
+        int j = 0;
+        for (; j + 4 <= count; j += 4) {
+            __m128i weights = _mm_max_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j)),
+                                            _mm_setzero_si128());
+            __m256i reduced = _mm256_sub_epi64(_mm256_sub_epi64(negatedRowDual, _mm256_cvtepi32_epi64(weights)),
+                                               _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columnDual + j)));
+            __m256i outside = _mm256_cmpeq_epi64(loadTreeFlags4(inTree + j), zero);
+
+            __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slack + j));
+            __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi64(current, reduced), outside);
+            current = _mm256_blendv_epi8(current, reduced, lower);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(slack + j), current);
+            _mm_maskstore_epi32(from + j, narrowMask(lower), sources);
+
+            /* The first column in the lane wins ties, as in the scalar loop. */
+            __m256i better = _mm256_and_si256(_mm256_or_si256(_mm256_cmpgt_epi64(bestValue, current),
+                                                              _mm256_cmpeq_epi64(bestIndex, _mm256_set1_epi64x(-1))),
+                                              outside);
+            bestValue = _mm256_blendv_epi8(bestValue, current, better);
+            bestIndex = _mm256_blendv_epi8(bestIndex, index, better);
+            index = _mm256_add_epi64(index, step);
+        }
+
+        alignas(32) long long values[4];
+        alignas(32) long long indices[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values), bestValue);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(indices), bestIndex);
+        SlackMinimum result = smallestLane(values, indices, 4);
+        finishRelaxRow(row, rowDual, columnDual, inTree, slack, from, source, j, count, result);
+        return result;
+    }
+
+    __attribute__((target("avx2")))
+    void shiftDualsAvx2(long long* columnDual, long long* slack, const char* inTree, long long delta, int count) {
+        const __m256i deltas = _mm256_set1_epi64x(delta);
+        int j = 0;
+        for (; j + 4 <= count; j += 4) {
+            __m256i outside = _mm256_cmpeq_epi64(loadTreeFlags4(inTree + j), _mm256_setzero_si256());
+            __m256i* duals = reinterpret_cast<__m256i*>(columnDual + j);
+            __m256i* slacks = reinterpret_cast<__m256i*>(slack + j);
+            __m256i dualDeltas = _mm256_andnot_si256(outside, deltas);
+            __m256i slackDeltas = _mm256_and_si256(outside, deltas);
+            _mm256_storeu_si256(duals, _mm256_sub_epi64(_mm256_loadu_si256(duals), dualDeltas));
+            _mm256_storeu_si256(slacks, _mm256_sub_epi64(_mm256_loadu_si256(slacks), slackDeltas));
+        }
+        shiftDualsScalar(columnDual + j, slack + j, inTree + j, delta, count - j);
+    }
+
+    __attribute__((target("avx2")))
+    long long matchingWeightAvx2(const int32_t* matrix, size_t stride, const int* columnOf, int rows) {
+        const __m256i strides = _mm256_set1_epi64x((long long)stride);
+        const __m256i step = _mm256_set1_epi64x(4);
+        __m256i rowIndex = _mm256_setr_epi64x(0, 1, 2, 3);
+        __m256i sum = _mm256_setzero_si256();
+
+        int r = 0;
+        for (; r + 4 <= rows; r += 4) {
+            __m256i columns = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(columnOf + r)));
+            __m256i paired = _mm256_cmpgt_epi64(columns, _mm256_set1_epi64x(-1));
+            __m256i offsets = _mm256_add_epi64(_mm256_mul_epu32(rowIndex, strides), columns);
+            __m128i weights = _mm256_mask_i64gather_epi32(_mm_setzero_si128(), matrix, offsets, narrowMask(paired), 4);
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(weights));
+            rowIndex = _mm256_add_epi64(rowIndex, step);
+        }
+
+        alignas(32) long long lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+        long long total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        for (; r < rows; r++) {
+            if (columnOf[r] >= 0) total += matrix[size_t(r) * stride + size_t(columnOf[r])];
+        }
+        return total;
+    }
+
+    /* The AVX-512 loops use the maskz forms of widening and multiplying with every lane
+     * selected, which are the plain forms without GCC's warnings about their undefined
+     * pass-through operand.
+     */
+    __attribute__((target("avx512f"))) __m512i loadTreeFlags8(const char* inTree) {
+        return _mm512_maskz_cvtepi8_epi64(0xff, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(inTree)));
+    }
+
+    __attribute__((target("avx512f")))
+    RowMaximum rowMaximumAvx512(const int32_t* row, int count) {
+        if (count < 16) return rowMaximumAvx2(row, count);
+
+        __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        __m512i best = _mm512_loadu_si512(row);
+        __m512i bestIndex = index;
+        const __m512i step = _mm512_set1_epi32(16);
+        int j = 16;
+        for (; j + 16 <= count; j += 16) {
+            index = _mm512_add_epi32(index, step);
+            __m512i values = _mm512_loadu_si512(row + j);
+            __mmask16 greater = _mm512_cmpgt_epi32_mask(values, best);
+            best = _mm512_mask_mov_epi32(best, greater, values);
+            bestIndex = _mm512_mask_mov_epi32(bestIndex, greater, index);
+        }
+
+        alignas(64) int32_t values[16];
+        alignas(64) int32_t indices[16];
+        _mm512_store_si512(values, best);
+        _mm512_store_si512(indices, bestIndex);
+        RowMaximum result = largestLane(values, indices, 16);
+        finishRowMaximum(row, j, count, result);
+        return result;
+    }
+
+    __attribute__((target("avx512f")))
+    SlackMinimum relaxRowAvx512(const int32_t* row, long long rowDual, const long long* columnDual,
+                                const char* inTree, long long* slack, int32_t* from, int32_t source, int count) {
+        const __m512i zero = _mm512_setzero_si512();
+        const __m512i negatedRowDual = _mm512_set1_epi64(-rowDual);
+        const __m512i sources = _mm512_set1_epi64(source);
+        const __m512i step = _mm512_set1_epi64(8);
+        __m512i index = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+        __m512i bestValue = _mm512_set1_epi64(LLONG_MAX);
+        __m512i bestIndex = _mm512_set1_epi64(-1);
+        __mmask8 seen = 0;
+
+        int j = 0;
+        for (; j + 8 <= count; j += 8) {
+            __m256i weights = _mm256_max_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + j)),
+                                               _mm256_setzero_si256());
+            __m512i widened = _mm512_maskz_cvtepi32_epi64(0xff, weights);
+            __m512i reduced = _mm512_sub_epi64(_mm512_sub_epi64(negatedRowDual, widened),
+                                               _mm512_loadu_si512(columnDual + j));
+            __mmask8 outside = _mm512_cmpeq_epi64_mask(loadTreeFlags8(inTree + j), zero);
+
+            __m512i current = _mm512_loadu_si512(slack + j);
+            __mmask8 lower = _mm512_mask_cmpgt_epi64_mask(outside, current, reduced);
+            current = _mm512_mask_mov_epi64(current, lower, reduced);
+            _mm512_storeu_si512(slack + j, current);
+            _mm512_mask_cvtepi64_storeu_epi32(from + j, lower, sources);
+
+            __mmask8 better = outside & (_mm512_cmpgt_epi64_mask(bestValue, current) | __mmask8(~seen));
+            bestValue = _mm512_mask_mov_epi64(bestValue, better, current);
+            bestIndex = _mm512_mask_mov_epi64(bestIndex, better, index);
+            seen |= outside;
+            index = _mm512_add_epi64(index, step);
+        }
+
+        alignas(64) long long values[8];
+        alignas(64) long long indices[8];
+        _mm512_store_si512(values, bestValue);
+        _mm512_store_si512(indices, bestIndex);
+        SlackMinimum result = smallestLane(values, indices, 8);
+        finishRelaxRow(row, rowDual, columnDual, inTree, slack, from, source, j, count, result);
+        return result;
+    }
+
+    __attribute__((target("avx512f")))
+    void shiftDualsAvx512(long long* columnDual, long long* slack, const char* inTree, long long delta, int count) {
+        const __m512i deltas = _mm512_set1_epi64(delta);
+        int j = 0;
+        for (; j + 8 <= count; j += 8) {
+            __mmask8 outside = _mm512_cmpeq_epi64_mask(loadTreeFlags8(inTree + j), _mm512_setzero_si512());
+            __m512i duals = _mm512_loadu_si512(columnDual + j);
+            __m512i slacks = _mm512_loadu_si512(slack + j);
+            _mm512_storeu_si512(columnDual + j, _mm512_mask_sub_epi64(duals, __mmask8(~outside), duals, deltas));
+            _mm512_storeu_si512(slack + j, _mm512_mask_sub_epi64(slacks, outside, slacks, deltas));
+        }
+        shiftDualsScalar(columnDual + j, slack + j, inTree + j, delta, count - j);
+    }
+
+    __attribute__((target("avx512f")))
+    long long matchingWeightAvx512(const int32_t* matrix, size_t stride, const int* columnOf, int rows) {
+        const __m512i strides = _mm512_set1_epi64((long long)stride);
+        const __m512i step = _mm512_set1_epi64(8);
+        __m512i rowIndex = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+        __m512i sum = _mm512_setzero_si512();
+
+        int r = 0;
+        for (; r + 8 <= rows; r += 8) {
+            __m256i narrow = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columnOf + r));
+            __m512i columns = _mm512_maskz_cvtepi32_epi64(0xff, narrow);
+            __mmask8 paired = _mm512_cmpge_epi64_mask(columns, _mm512_setzero_si512());
+            __m512i offsets = _mm512_add_epi64(_mm512_maskz_mul_epu32(0xff, rowIndex, strides), columns);
+            __m256i weights = _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), paired, offsets, matrix, 4);
+            sum = _mm512_add_epi64(sum, _mm512_maskz_cvtepi32_epi64(0xff, weights));
+            rowIndex = _mm512_add_epi64(rowIndex, step);
+        }
+
+        alignas(64) long long lanes[8];
+        _mm512_store_si512(lanes, sum);
+        long long total = 0;
+        for (long long lane: lanes) {
+            total += lane;
+        }
+        for (; r < rows; r++) {
+            if (columnOf[r] >= 0) total += matrix[size_t(r) * stride + size_t(columnOf[r])];
+        }
+        return total;
+    }
+#endif
+
+    struct Kernels {
+        const char*  name;
+        RowMaximum   (*rowMaximum)(const int32_t*, int);
+        SlackMinimum (*relaxRow)(const int32_t*, long long, const long long*, const char*, long long*, int32_t*,
+                                 int32_t, int);
+        void         (*shiftDuals)(long long*, long long*, const char*, long long, int);
+        long long    (*matchingWeight)(const int32_t*, size_t, const int*, int);
+    };
+
+    /* Every version this processor can run, slowest first. */
+    vector<Kernels> supportedKernels() {
+        vector<Kernels> result = {
+            { "scalar", rowMaximumScalar, relaxRowScalar, shiftDualsScalar, matchingWeightScalar },
+        };
+#if DENSE_KERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            result.push_back({ "avx2", rowMaximumAvx2, relaxRowAvx2, shiftDualsAvx2, matchingWeightAvx2 });
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("avx512f")) {
+            result.push_back({ "avx512", rowMaximumAvx512, relaxRowAvx512, shiftDualsAvx512, matchingWeightAvx512 });
+        }
+#endif
+        return result;
+    }
+
+    const Kernels& kernels() {
+        static const Kernels chosen = supportedKernels().back();
+        return chosen;
+    }
+}
+
+RowMaximum denseRowMaximum(const int32_t* row, int count) {
+    return kernels().rowMaximum(row, count);
+}
+
+SlackMinimum denseRelaxRow(const int32_t* row, long long rowDual, const long long* columnDual, const char* inTree,
+                           long long* slack, int32_t* from, int32_t source, int count) {
+    return kernels().relaxRow(row, rowDual, columnDual, inTree, slack, from, source, count);
+}
+
+void denseShiftDuals(long long* columnDual, long long* slack, const char* inTree, long long delta, int count) {
+    kernels().shiftDuals(columnDual, slack, inTree, delta, count);
+}
+
+long long denseMatchingWeight(const int32_t* matrix, size_t stride, const int* columnOf, int rows) {
+    return kernels().matchingWeight(matrix, stride, columnOf, rows);
+}
+
+const char* denseKernelName() {
+    return kernels().name;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("Every dense kernel version gives the scalar loops' answers, ties included") {
+    mt19937 generator(23);
+    vector<Kernels> versions = supportedKernels();
+    for (int trial = 0; trial < 200; trial++) {
+        int count = int(generator() % 70);
+        int range = 1 + int(generator() % 8);    // Small ranges make plenty of ties.
+        vector<int32_t> row(count);
+        vector<long long> columnDual(count);
+        vector<char> inTree(count);
+        vector<long long> slack(count);
+        for (int j = 0; j < count; j++) {
+            row[j] = int32_t(generator() % (2 * range)) - range / 2;
+            columnDual[j] = -(long long)(generator() % range);
+            inTree[j] = generator() % 3 == 0;
+            slack[j] = generator() % 4 == 0 ? LLONG_MAX : (long long)(generator() % (2 * range)) - range;
+        }
+        size_t stride = count + int(generator() % 5);
+        vector<int32_t> matrix(count * stride);
+        for (int32_t& weight: matrix) {
+            weight = int32_t(generator() % 100) - 10;
+        }
+        vector<int> columnOf(count);
+        for (int r = 0; r < count; r++) {
+            columnOf[r] = generator() % 4 == 0 ? -1 : int(generator() % count);
+        }
+        long long rowDual = -(long long)(generator() % range);
+        long long delta = generator() % 5;
+
+        RowMaximum expectedMaximum = rowMaximumScalar(row.data(), count);
+        vector<long long> expectedSlack = slack;
+        vector<int32_t> expectedFrom(count, -1);
+        SlackMinimum expectedMinimum = relaxRowScalar(row.data(), rowDual, columnDual.data(), inTree.data(),
+                                                      expectedSlack.data(), expectedFrom.data(), 7, count);
+        vector<long long> expectedDual = columnDual;
+        shiftDualsScalar(expectedDual.data(), expectedSlack.data(), inTree.data(), delta, count);
+        long long expectedWeight = matchingWeightScalar(matrix.data(), stride, columnOf.data(), count);
+
+        for (const Kernels& version: versions) {
+            RowMaximum maximum = version.rowMaximum(row.data(), count);
+            EXPECT_EQUAL(maximum.index, expectedMaximum.index);
+            if (count > 0) EXPECT_EQUAL(maximum.value, expectedMaximum.value);
+
+            vector<long long> newSlack = slack;
+            vector<int32_t> from(count, -1);
+            SlackMinimum minimum = version.relaxRow(row.data(), rowDual, columnDual.data(), inTree.data(),
+                                                    newSlack.data(), from.data(), 7, count);
+            EXPECT_EQUAL(minimum.index, expectedMinimum.index);
+            EXPECT_EQUAL(minimum.value, expectedMinimum.value);
+            EXPECT(from == expectedFrom);
+
+            vector<long long> dual = columnDual;
+            version.shiftDuals(dual.data(), newSlack.data(), inTree.data(), delta, count);
+            EXPECT(dual == expectedDual);
+            EXPECT(newSlack == expectedSlack);
+
+            EXPECT_EQUAL(version.matchingWeight(matrix.data(), stride, columnOf.data(), count), expectedWeight);
+        }
+    }
+}
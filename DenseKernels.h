@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/* Loops over rows of a dense weight matrix (see DenseMatching.h), in AVX-512, AVX2
+ * and plain C++ versions. The fastest one the processor supports is picked the
+ * first time any of them is called; all three give exactly the same answers,
+ * including which index wins a tie (always the first).
+ *
+ * Rows are int32 weights. Arrays need no particular alignment, but the loops run
+ * fastest on rows that start on a cache line, as DenseWeightMatrix's do.
+ */
+
+struct RowMaximum {
+    int32_t value;
+    int     index;   // The first column holding value; -1 if the row is empty.
+};
+
+/* The largest of row[0 .. count - 1], and where it is. */
+RowMaximum denseRowMaximum(const int32_t* row, int count);
+
+struct SlackMinimum {
+    long long value;
+    int       index;   // -1 if every column is in the tree.
+};
+
+/* The reduced-cost update of the Hungarian method, for one row added to the search
+ * tree, in the cost-minimizing form where a link costs -max(weight, 0). For every
+ * column j with inTree[j] == 0:
+ *
+ *     reduced = -max(row[j], 0) - rowDual - columnDual[j]
+ *     if reduced < slack[j]: slack[j] = reduced, from[j] = source
+ *
+ * Returns the smallest slack[j] over those columns afterwards, and the first
+ * column that has it.
+ */
+SlackMinimum denseRelaxRow(const int32_t* row, long long rowDual, const long long* columnDual, const char* inTree,
+                           long long* slack, int32_t* from, int32_t source, int count);
+
+/* The dual change that goes with it: columns in the tree have their dual lowered by
+ * delta, and every other column's slack is lowered by delta.
+ */
+void denseShiftDuals(long long* columnDual, long long* slack, const char* inTree, long long delta, int count);
+
+/* Total weight of a matching of rows to columns: the sum of matrix[r * stride + columnOf[r]]
+ * over rows with columnOf[r] != -1.
+ */
+long long denseMatchingWeight(const int32_t* matrix, size_t stride, const int* columnOf, int rows);
+
+/* "avx512", "avx2" or "scalar": which versions the functions above use. */
+const char* denseKernelName();
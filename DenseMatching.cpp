@@ -0,0 +1,283 @@
+/*
+ * The Hungarian method on a dense weight matrix. See DenseMatching.h.
+ */
+
+#include "DenseMatching.h"
+#include <algorithm>
+#include <climits>
+#include "DenseKernels.h"
+using namespace std;
+
+namespace {
+    /* Weights per cache line. */
+    const size_t kRowAlignment = Arena::kAlignment / sizeof(int32_t);
+
+    /* The side with fewer people, which gets the rows; side 0 on ties. */
+    char rowSide(const vector<char>& side) {
+        size_t ones = count(side.begin(), side.end(), char(1));
+        return ones < side.size() - ones ? 1 : 0;
+    }
+}
+
+DenseWeightMatrix::DenseWeightMatrix(const CompactGraph& graph, const vector<char>& side, Arena& arena) {
+    uint32_t n = graph.numPeople();
+    char rowsSide = rowSide(side);
+    for (uint32_t v = 0; v < n; v++) {
+        if (side[v] == rowsSide) {
+            rows_++;
+        } else {
+            columns_++;
+        }
+    }
+    stride_ = (size_t(columns_) + kRowAlignment - 1) / kRowAlignment * kRowAlignment;
+
+    rowPerson_ = ArenaArray<int>(arena, rows_);
+    columnPerson_ = ArenaArray<int>(arena, columns_);
+    indexOf_ = ArenaArray<int>(arena, n);
+    hasRow_ = ArenaArray<char>(arena, n);
+    int nextRow = 0;
+    int nextColumn = 0;
+    for (uint32_t v = 0; v < n; v++) {
+        hasRow_[v] = side[v] == rowsSide;
+        if (hasRow_[v]) {
+            rowPerson_[nextRow] = int(v);
+            indexOf_[v] = nextRow++;
+        } else {
+            columnPerson_[nextColumn] = int(v);
+            indexOf_[v] = nextColumn++;
+        }
+    }
+
+    weights_ = ArenaArray<int32_t>(arena, size_t(rows_) * stride_, 0);
+    for (int r = 0; r < rows_; r++) {
+        int v = rowPerson_[r];
+        int32_t* row = weights_.begin() + size_t(r) * stride_;
+        const int32_t* weight = graph.weightsBegin(v);
+        for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++, weight++) {
+            if (!hasRow_[*u]) row[indexOf_[*u]] = *weight;
+        }
+    }
+}
+
+bool preferDenseMatching(const CompactGraph& graph, const vector<char>& side) {
+    uint64_t ones = count(side.begin(), side.end(), char(1));
+    uint64_t pairs = ones * (side.size() - ones);
+    return pairs > 0 && 3 * graph.numLinks() >= pairs;
+}
+
+DenseMatching::DenseMatching(const CompactGraph& graph, const vector<char>& side, Arena& arena)
+    : arena_(arena),
+      graph_(graph),
+      matrix_(graph, side, arena),
+      columnOf_(arena, matrix_.rows(), -1),
+      rowOf_(arena, matrix_.columns() + 1, -1),
+      rowDual_(arena, matrix_.rows(), 0),
+      columnDual_(arena, matrix_.columns(), 0),
+      slack_(arena, matrix_.columns()),
+      from_(arena, matrix_.columns()),
+      inTree_(arena, matrix_.columns() + 1, 0),
+      treeRows_(arena, matrix_.rows()),
+      freeColumns_(arena, matrix_.columns()) {
+}
+
+DenseMatching::DenseMatching(const CompactGraph& graph, const vector<char>& side)
+    : DenseMatching(graph, side, ownArena_) {
+}
+
+long long DenseMatching::solve() {
+    int rows = matrix_.rows();
+    int columns = matrix_.columns();
+
+    /* Every row's heaviest link costs exactly its dual, so it can have that column
+     * outright if no earlier row took it. Duals start at 0 for columns.
+     */
+    for (int r = 0; r < rows; r++) {
+        RowMaximum best = denseRowMaximum(matrix_.row(r), columns);
+        rowDual_[r] = -max(best.value, 0);
+        if (rowOf_[best.index] == -1) {
+            rowOf_[best.index] = r;
+            columnOf_[r] = best.index;
+        }
+    }
+    for (int c = 0; c < columns; c++) {
+        if (rowOf_[c] == -1) freeColumns_.push_back(c);
+    }
+    for (int r = 0; r < rows; r++) {
+        if (columnOf_[r] == -1) addRow(r);
+    }
+
+    /* Pairs that were only there to complete the assignment. */
+    for (int r = 0; r < rows; r++) {
+        if (matrix_.weight(r, columnOf_[r]) <= 0) {
+            rowOf_[columnOf_[r]] = -1;
+            columnOf_[r] = -1;
+        }
+    }
+    return denseMatchingWeight(matrix_.data(), matrix_.stride(), columnOf_.begin(), rows);
+}
+
+/* One shortest augmenting path search, from an extra column whose row is root. Each
+ * step adds the row of the last column reached to the tree, then moves the duals by
+ * the smallest slack left, which makes the column with that slack tight. The search
+ * ends at a free column, and the path back to root is flipped.
+ */
+void DenseMatching::addRow(int root) {
+    int columns = matrix_.columns();
+    int rootColumn = columns;
+    rowOf_[rootColumn] = root;
+    slack_.fill(LLONG_MAX);
+    inTree_.fill(0);
+    treeRows_.clear();
+
+    int column = rootColumn;
+    do {
+        inTree_[column] = 1;
+        int row = rowOf_[column];
+        treeRows_.push_back(row);
+        SlackMinimum next = denseRelaxRow(matrix_.row(row), rowDual_[row], columnDual_.begin(), inTree_.begin(),
+                                          slack_.begin(), from_.begin(), column, columns);
+        for (int r: treeRows_) {
+            rowDual_[r] += next.value;
+        }
+        denseShiftDuals(columnDual_.begin(), slack_.begin(), inTree_.begin(), next.value, columns);
+        column = next.index;
+        if (rowOf_[column] != -1) column = tightFreeColumn(column);
+        MATCHING_STAT_INC(stats_, nodesExpanded);
+        MATCHING_STAT_INC(stats_, dualAdjustments);
+    } while (rowOf_[column] != -1);
+
+    for (size_t i = 0; i < freeColumns_.size(); i++) {
+        if (freeColumns_[i] == column) {
+            freeColumns_[i] = freeColumns_.back();
+            freeColumns_.pop_back();
+            break;
+        }
+    }
+    while (column != rootColumn) {
+        int previous = from_[column];
+        rowOf_[column] = rowOf_[previous];
+        columnOf_[rowOf_[column]] = column;
+        column = previous;
+    }
+    rowOf_[rootColumn] = -1;
+    MATCHING_STAT_INC(stats_, augmentations);
+}
+
+/* Where several columns share the smallest slack, a free one among them ends the
+ * search at once. With many tied weights this saves most of the steps, each of
+ * which costs a pass over a whole row. Returns column if no free column is tight.
+ */
+int DenseMatching::tightFreeColumn(int column) {
+    for (int c: freeColumns_) {
+        if (slack_[c] == 0 && !inTree_[c]) return c;
+    }
+    return column;
+}
+
+int DenseMatching::mate(int v) const {
+    int index = matrix_.indexOf(v);
+    if (matrix_.hasRow(v)) {
+        return columnOf_[index] == -1 ? -1 : matrix_.columnPerson(columnOf_[index]);
+    } else {
+        return rowOf_[index] == -1 ? -1 : matrix_.rowPerson(rowOf_[index]);
+    }
+}
+
+vector<int> DenseMatching::mates() const {
+    vector<int> result(graph_.numPeople());
+    for (uint32_t v = 0; v < graph_.numPeople(); v++) {
+        result[v] = mate(int(v));
+    }
+    return result;
+}
+
+long long DenseMatching::weightOf(const vector<int>& mate) const {
+    vector<int> columnOf(matrix_.rows(), -1);
+    for (int r = 0; r < matrix_.rows(); r++) {
+        int partner = mate[matrix_.rowPerson(r)];
+        if (partner != -1) columnOf[r] = matrix_.indexOf(partner);
+    }
+    return denseMatchingWeight(matrix_.data(), matrix_.stride(), columnOf.data(), matrix_.rows());
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "BipartiteMatching.h"
+#include "Matchmaker.h"
+#include "TestGraphs.h"
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("DenseWeightMatrix lays rows out on cache lines, with 0 for missing links") {
+    CompactGraph graph = CompactGraph::fromWeightedLinks({
+        { "Ana", { { "Bo", 4 }, { "Cy", -2 } } },
+        { "Bo",  { { "Ana", 4 }, { "Di", 7 } } },
+        { "Cy",  { { "Ana", -2 } } },
+        { "Di",  { { "Bo", 7 } } },
+        { "Ed",  { } },
+    });
+    vector<char> side;
+    EXPECT(findBipartition(graph, side));
+
+    Arena arena;
+    DenseWeightMatrix matrix(graph, side, arena);
+    EXPECT_EQUAL(matrix.rows(), 2);       // Bo and Cy; Ana, Di and Ed are columns.
+    EXPECT_EQUAL(matrix.columns(), 3);
+    EXPECT_EQUAL(matrix.stride(), size_t(16));
+    EXPECT_EQUAL(reinterpret_cast<uintptr_t>(matrix.row(1)) % Arena::kAlignment, uintptr_t(0));
+
+    uint32_t bo, di, ana, cy, ed;
+    EXPECT(graph.findPerson("Bo", bo) && graph.findPerson("Di", di) && graph.findPerson("Ana", ana));
+    EXPECT(graph.findPerson("Cy", cy) && graph.findPerson("Ed", ed));
+    EXPECT(matrix.hasRow(bo) && matrix.hasRow(cy) && !matrix.hasRow(di));
+    EXPECT_EQUAL(matrix.weight(matrix.indexOf(bo), matrix.indexOf(ana)), 4);
+    EXPECT_EQUAL(matrix.weight(matrix.indexOf(cy), matrix.indexOf(ana)), -2);
+    EXPECT_EQUAL(matrix.weight(matrix.indexOf(bo), matrix.indexOf(ed)), 0);
+    EXPECT_EQUAL(matrix.weight(matrix.indexOf(cy), matrix.indexOf(di)), 0);
+    EXPECT_EQUAL(matrix.columnPerson(matrix.indexOf(di)), int(di));
+}
+
+STUDENT_TEST("DenseMatching matches the sparse Hungarian method's weight") {
+    mt19937 generator(41);
+    for (int trial = 0; trial < 60; trial++) {
+        int numOne = 1 + int(generator() % 30);
+        int numTwo = 1 + int(generator() % 30);
+        CompactGraph graph = randomTwoSidedGraph(generator, numOne, numTwo, 1 + int(generator() % 3),
+                                                 -3, int(generator() % 12) - 3, true);
+        vector<char> side;
+        EXPECT(findBipartition(graph, side));
+
+        DenseMatching dense(graph, side);
+        long long weight = dense.solve();
+        BipartiteWeightedMatching reference(graph, side);
+        EXPECT_EQUAL(weight, reference.solve());
+
+        vector<int> mate = dense.mates();
+        EXPECT_EQUAL(dense.weightOf(mate), weight);
+        long long total = 0;
+        for (uint32_t v = 0; v < graph.numPeople(); v++) {
+            if (mate[v] == -1) continue;
+            EXPECT_EQUAL(mate[mate[v]], int(v));
+            EXPECT(graph.weight(v, mate[v]) > 0);
+            if (mate[v] > int(v)) total += graph.weight(v, mate[v]);
+        }
+        EXPECT_EQUAL(total, weight);
+    }
+}
+
+STUDENT_TEST("maximumWeightMatchingById hands dense two-sided graphs to DenseMatching") {
+    mt19937 generator(5);
+    CompactGraph graph = randomTwoSidedGraph(generator, 40, 50, 1, -3, 16, true);
+    vector<char> side;
+    EXPECT(findBipartition(graph, side));
+    EXPECT(preferDenseMatching(graph, side));
+
+    vector<int> mate = maximumWeightMatchingById(graph);
+    DenseMatching dense(graph, side);
+    EXPECT_EQUAL(dense.weightOf(mate), dense.solve());
+
+    CompactGraph sparse = randomTwoSidedGraph(generator, 40, 50, 8, -3, 16, true);
+    EXPECT(findBipartition(sparse, side));
+    EXPECT(!preferDenseMatching(sparse, side));
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Arena.h"
+#include "CompactGraph.h"
+#include "SolverStats.h"
+
+/* The weights of a two-sided graph as a dense row-major int32 matrix: one row per
+ * person on the smaller side, one column per person on the other, 0 where there is
+ * no link. Every row starts on a cache line (rows are padded to a multiple of 16
+ * weights), so the kernels in DenseKernels.h can stream through it.
+ *
+ * Looking a weight up is one multiply and one load, against a binary search of a
+ * CSR row in CompactGraph::weight. The matrix costs 4 bytes per possible pair
+ * rather than 16 per actual link, so it only pays off when most people have
+ * rated most of the other side (see preferDenseMatching).
+ */
+class DenseWeightMatrix {
+public:
+    /* side must be a bipartition of the graph (see findBipartition). The arena must
+     * outlive the matrix.
+     */
+    DenseWeightMatrix(const CompactGraph& graph, const std::vector<char>& side, Arena& arena);
+
+    int rows() const {
+        return rows_;
+    }
+    int columns() const {
+        return columns_;
+    }
+    size_t stride() const {
+        return stride_;
+    }
+    const int32_t* data() const {
+        return weights_.begin();
+    }
+    const int32_t* row(int r) const {
+        return weights_.begin() + size_t(r) * stride_;
+    }
+    int32_t weight(int r, int c) const {
+        return row(r)[c];
+    }
+
+    /* Who each row and column is in the graph, and back. */
+    int rowPerson(int r) const {
+        return rowPerson_[r];
+    }
+    int columnPerson(int c) const {
+        return columnPerson_[c];
+    }
+    /* Whether person v has a row (or else a column), and which. */
+    bool hasRow(int v) const {
+        return hasRow_[v];
+    }
+    int indexOf(int v) const {
+        return indexOf_[v];
+    }
+
+private:
+    int                  rows_ = 0;
+    int                  columns_ = 0;
+    size_t               stride_ = 0;
+    ArenaArray<int>      rowPerson_;
+    ArenaArray<int>      columnPerson_;
+    ArenaArray<int>      indexOf_;
+    ArenaArray<char>     hasRow_;
+    ArenaArray<int32_t>  weights_;
+};
+
+/* Whether the graph has enough of its possible pairs linked that DenseMatching is
+ * the better solver for it: at least a third of them. That is where it overtook
+ * BipartiteWeightedMatching on random two-sided graphs of 1000 to 6000 people,
+ * with weights from 1 to 100 and from 1 to 1,000,000.
+ */
+bool preferDenseMatching(const CompactGraph& graph, const std::vector<char>& side);
+
+/* Maximum-weight matching in a two-sided graph by the Hungarian method on a dense
+ * weight matrix, in its O(rows^2 columns) form.
+ *
+ * Links with weight <= 0 count as 0, which turns the matching into an assignment
+ * of every row to a different column; pairs of weight 0 are dropped at the end.
+ * Rows start with their heaviest column where no earlier row has claimed it
+ * (denseRowMaximum), and the rest are added one at a time with shortest-path
+ * searches whose every step is one denseRelaxRow over a whole matrix row and one
+ * denseShiftDuals, so the time goes into streaming rows rather than into lookups.
+ * Where several columns tie for the smallest slack and one of them is free, the
+ * search takes that one and ends, which on tied weights saves most of the steps.
+ *
+ * All working state, the matrix included, is allocated from an Arena when the
+ * solver is constructed.
+ */
+class DenseMatching {
+public:
+    /* side must be a bipartition of the graph (see findBipartition). The graph and
+     * arena must outlive the solver.
+     */
+    DenseMatching(const CompactGraph& graph, const std::vector<char>& side, Arena& arena);
+    DenseMatching(const CompactGraph& graph, const std::vector<char>& side);
+
+    /* Runs the algorithm. Returns the total weight of the matching. */
+    long long solve();
+
+    /* Counts what the solver does into stats from now on (see SolverStats.h).
+     * Pass nullptr to stop.
+     */
+    void setStats(SolverStats* stats) {
+        stats_ = stats;
+    }
+
+    const DenseWeightMatrix& matrix() const {
+        return matrix_;
+    }
+
+    int mate(int v) const;
+    std::vector<int> mates() const;
+
+    /* Total weight of a mate array whose pairs are all between rows and columns of
+     * the matrix, scored with denseMatchingWeight.
+     */
+    long long weightOf(const std::vector<int>& mate) const;
+
+private:
+    void addRow(int row);
+    int  tightFreeColumn(int column);
+
+    Arena                 ownArena_;
+    Arena&                arena_;
+    const CompactGraph&   graph_;
+    SolverStats*          stats_ = nullptr;
+    DenseWeightMatrix     matrix_;
+    ArenaArray<int>       columnOf_;      // Each row's column, or -1.
+    ArenaArray<int>       rowOf_;         // Each column's row, or -1; one extra column for the search root.
+    ArenaArray<long long> rowDual_;       // Duals are for the cost form, where a link costs -max(weight, 0).
+    ArenaArray<long long> columnDual_;
+    ArenaArray<long long> slack_;
+    ArenaArray<int32_t>   from_;          // The column each column's slack was last lowered from.
+    ArenaArray<char>      inTree_;        // One extra, for the search root.
+    ArenaStack<int>       treeRows_;
+    ArenaStack<int>       freeColumns_;   // Columns no row has, in no particular order.
+};
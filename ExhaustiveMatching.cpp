@@ -0,0 +1,373 @@
+/*
+ * Parallel branch and bound for exact maximum-weight matching. See ExhaustiveMatching.h.
+ */
+
+#include "ExhaustiveMatching.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+using namespace std;
+
+/* Shared state for one call to solve(): a queue of task ids per worker, the global
+ * best weight used for pruning, and each task's result.
+ */
+class ExhaustiveMatching::Pool {
+public:
+    struct Queue {
+        mutex      lock;
+        deque<int> tasks;
+    };
+    struct Result {
+        long long   weight = -1;  // -1 if the whole task was pruned.
+        vector<int> mates;
+    };
+
+    Pool(int numWorkers, int numTasks)
+        : queues(numWorkers), results(numTasks), workerStats(numWorkers) {
+        /* Hand out contiguous runs of tasks, so each worker starts on its own part of the tree. */
+        for (int task = 0; task < numTasks; task++) {
+            queues[size_t(task) * numWorkers / numTasks].tasks.push_back(task);
+        }
+    }
+
+    /* Takes the next task from this worker's own queue, or steals the last task
+     * from someone else's. Returns false once every queue is empty.
+     */
+    bool take(int worker, int& task) {
+        {
+            lock_guard<mutex> guard(queues[worker].lock);
+            if (!queues[worker].tasks.empty()) {
+                task = queues[worker].tasks.front();
+                queues[worker].tasks.pop_front();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); i++) {
+            Queue& victim = queues[(worker + i) % queues.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Raises the global best to weight if it is higher. Lock-free. */
+    void offer(long long weight) {
+        long long current = best.load(memory_order_relaxed);
+        while (weight > current && !best.compare_exchange_weak(current, weight, memory_order_relaxed)) {
+        }
+    }
+
+    vector<Queue>       queues;
+    vector<Result>      results;
+    vector<SolverStats> workerStats;  // Merged once the workers are done, so they never share a counter.
+    atomic<long long>   best { -1 };
+    atomic<uint64_t>    nodes { 0 };
+};
+
+namespace {
+    /* One worker's depth-first search. All state is mutated in place and undone on the way back up. */
+    class Searcher {
+    public:
+        Searcher(const CompactGraph& graph, const vector<long long>& heaviest, const PairConstraint& constraint,
+                 SolverStats* stats)
+            : graph_(graph), heaviest_(heaviest), constraint_(constraint), stats_(stats),
+              decided_(graph.numPeople(), false), score_(graph) {
+        }
+
+        /* Searches the subtree below the given decisions. Returns the best weight found,
+         * or -1 if everything was pruned; bestMates is set when a matching is found.
+         */
+        template <typename Decisions, typename OfferBest, typename GlobalBest>
+        long long run(const Decisions& decisions, vector<int>& bestMates, OfferBest offer, GlobalBest global) {
+            fill(decided_.begin(), decided_.end(), false);
+            score_.clear();
+            remaining_ = 0;
+            for (long long weight: heaviest_) {
+                remaining_ += weight;
+            }
+            for (const auto& decision: decisions) {
+                decide(decision.person);
+                if (decision.partner != -1) {
+                    decide(decision.partner);
+                    score_.add(decision.person, decision.partner);
+                }
+            }
+
+            localBest_ = -1;
+            bestMates_ = &bestMates;
+            search(0, offer, global);
+            return localBest_;
+        }
+
+        uint64_t nodes() const {
+            return nodes_;
+        }
+
+    private:
+        void decide(int v) {
+            decided_[v] = true;
+            remaining_ -= heaviest_[v];
+        }
+        void undecide(int v) {
+            decided_[v] = false;
+            remaining_ += heaviest_[v];
+        }
+
+        template <typename OfferBest, typename GlobalBest>
+        void search(int from, OfferBest& offer, GlobalBest& global) {
+            nodes_++;
+            while (from < int(decided_.size()) && decided_[from]) from++;
+
+            if (from == int(decided_.size())) {
+                if (score_.total() > localBest_) {
+                    localBest_ = score_.total();
+                    *bestMates_ = score_.mates();
+                    offer(localBest_);
+                }
+                return;
+            }
+
+            /* Nothing below here can beat what this task already has, or can even tie
+             * what some task has found. (Ties with other tasks must still be explored,
+             * or the result would depend on which task finished first.)
+             */
+            long long bound = score_.total() + remaining_ / 2;
+            if (bound <= localBest_ || bound < global()) {
+                MATCHING_STAT_INC(stats_, prunes);
+                return;
+            }
+
+            int v = from;
+            decide(v);
+            search(from + 1, offer, global);
+
+            const uint32_t* neighbours = graph_.neighboursBegin(v);
+            const int32_t* weights = graph_.weightsBegin(v);
+            for (uint32_t i = 0; i < graph_.degree(v); i++) {
+                int u = int(neighbours[i]);
+                if (u < v || decided_[u] || weights[i] <= 0) continue;
+                if (constraint_ && !constraint_(score_, v, u)) continue;
+
+                decide(u);
+                score_.addNeighbour(v, i);
+                search(from + 1, offer, global);
+                score_.remove(v);
+                undecide(u);
+            }
+            undecide(v);
+        }
+
+        const CompactGraph&      graph_;
+        const vector<long long>& heaviest_;
+        const PairConstraint&    constraint_;
+        SolverStats*             stats_;
+        vector<char>             decided_;
+        MatchingScore            score_;
+        long long                remaining_ = 0;   // Sum of heaviest_ over undecided people.
+        long long                localBest_ = -1;
+        vector<int>*             bestMates_ = nullptr;
+        uint64_t                 nodes_ = 0;
+    };
+}
+
+ExhaustiveMatching::ExhaustiveMatching(const CompactGraph& graph, const ExhaustiveOptions& options)
+    : graph_(graph), options_(options), heaviest_(graph.numPeople(), 0) {
+    if (options_.numThreads <= 0) {
+        options_.numThreads = max(1, int(thread::hardware_concurrency()));
+    }
+
+    for (uint32_t v = 0; v < graph.numPeople(); v++) {
+        const int32_t* w = graph.weightsBegin(v);
+        for (uint32_t i = 0; i < graph.degree(v); i++) {
+            heaviest_[v] = max(heaviest_[v], (long long) w[i]);
+        }
+    }
+}
+
+void ExhaustiveMatching::expandPrefix(vector<char>& decided, MatchingScore& score,
+                                      vector<Decision>& prefix, int from) {
+    while (from < int(decided.size()) && decided[from]) from++;
+
+    if (from == int(decided.size()) || int(prefix.size()) == options_.splitDepth) {
+        tasks_.push_back({ taskDecisions_.size(), prefix.size() });
+        taskDecisions_.insert(taskDecisions_.end(), prefix.begin(), prefix.end());
+        return;
+    }
+
+    /* Same branch order as the search itself, so tasks come out in sequential search order. */
+    int v = from;
+    decided[v] = true;
+    prefix.push_back({ v, -1 });
+    expandPrefix(decided, score, prefix, from + 1);
+    prefix.pop_back();
+
+    const uint32_t* neighbours = graph_.neighboursBegin(v);
+    const int32_t* weights = graph_.weightsBegin(v);
+    for (uint32_t i = 0; i < graph_.degree(v); i++) {
+        int u = int(neighbours[i]);
+        if (u < v || decided[u] || weights[i] <= 0) continue;
+        if (options_.constraint && !options_.constraint(score, v, u)) continue;
+
+        decided[u] = true;
+        score.addNeighbour(v, i);
+        prefix.push_back({ v, u });
+        expandPrefix(decided, score, prefix, from + 1);
+        prefix.pop_back();
+        score.remove(v);
+        decided[u] = false;
+    }
+    decided[v] = false;
+}
+
+void ExhaustiveMatching::buildTasks() {
+    tasks_.clear();
+    taskDecisions_.clear();
+
+    vector<char> decided(graph_.numPeople(), false);
+    MatchingScore score(graph_);
+    vector<Decision> prefix;
+    expandPrefix(decided, score, prefix, 0);
+}
+
+void ExhaustiveMatching::runWorker(int worker) {
+    Searcher searcher(graph_, heaviest_, options_.constraint,
+                      stats_ == nullptr ? nullptr : &pool_->workerStats[worker]);
+    auto offer = [&](long long weight) { pool_->offer(weight); };
+    auto global = [&]() { return pool_->best.load(memory_order_relaxed); };
+
+    int task;
+    while (pool_->take(worker, task)) {
+        struct Range {
+            const Decision* first;
+            const Decision* last;
+            const Decision* begin() const { return first; }
+            const Decision* end() const { return last; }
+        } decisions = { taskDecisions_.data() + tasks_[task].first,
+                        taskDecisions_.data() + tasks_[task].first + tasks_[task].count };
+
+        auto& result = pool_->results[task];
+        result.weight = searcher.run(decisions, result.mates, offer, global);
+    }
+    pool_->nodes += searcher.nodes();
+}
+
+long long ExhaustiveMatching::solve() {
+    buildTasks();
+
+    Pool pool(options_.numThreads, int(tasks_.size()));
+    pool_ = &pool;
+    if (options_.numThreads == 1) {
+        runWorker(0);
+    } else {
+        vector<thread> workers;
+        for (int worker = 0; worker < options_.numThreads; worker++) {
+            workers.emplace_back(&ExhaustiveMatching::runWorker, this, worker);
+        }
+        for (thread& worker: workers) {
+            worker.join();
+        }
+    }
+    pool_ = nullptr;
+
+    /* Earliest task wins ties: that's the matching the sequential search finds first. */
+    int winner = -1;
+    for (int task = 0; task < int(tasks_.size()); task++) {
+        if (winner == -1 || pool.results[task].weight > pool.results[winner].weight) {
+            winner = task;
+        }
+    }
+    bestMates_ = pool.results[winner].mates;
+    nodesExpanded_ = pool.nodes;
+    if (stats_ != nullptr) {
+        for (const SolverStats& counts: pool.workerStats) {
+            stats_->merge(counts);
+        }
+        MATCHING_STAT_ADD(stats_, nodesExpanded, nodesExpanded_);
+    }
+    return pool.results[winner].weight;
+}
+
+Set<Pair> exhaustiveMaximumWeightMatching(const Map<string, Map<string, int>>& possibleLinks,
+                                          const ExhaustiveOptions& options) {
+    CompactGraph graph = CompactGraph::fromWeightedLinks(possibleLinks);
+    ExhaustiveMatching solver(graph, options);
+    solver.solve();
+    return graph.toPairs(solver.mates());
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "SmallGroupMatching.h"
+#include "TestGraphs.h"
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("ExhaustiveMatching finds the same matching as SmallGroupMatching, on any number of threads") {
+    mt19937 generator(7);
+    for (int trial = 0; trial < 40; trial++) {
+        /* Weights from a tiny range make lots of ties. */
+        CompactGraph graph = randomGraph(generator, 14, 3, 1, 3);
+
+        SmallGroupMatching reference(graph);
+        long long expected = reference.solve();
+
+        for (int threads: { 1, 4 }) {
+            ExhaustiveOptions options;
+            options.numThreads = threads;
+            options.splitDepth = 4;
+            ExhaustiveMatching solver(graph, options);
+            EXPECT_EQUAL(solver.solve(), expected);
+            EXPECT(solver.mates() == reference.mates());
+        }
+    }
+}
+
+STUDENT_TEST("ExhaustiveMatching honours constraints on the whole matching") {
+    /* This world:
+     *
+     *  A --- B --- C --- D
+     *     3     5     3
+     *
+     * With at most one pair allowed, the best choice is B--C.
+     */
+    ExhaustiveOptions options;
+    options.numThreads = 2;
+    options.constraint = [](const MatchingScore& partial, uint32_t, uint32_t) {
+        return partial.total() == 0;
+    };
+
+    auto result = exhaustiveMaximumWeightMatching({
+        { "A", { { "B", 3 } } },
+        { "B", { { "A", 3 }, { "C", 5 } } },
+        { "C", { { "B", 5 }, { "D", 3 } } },
+        { "D", { { "C", 3 } } },
+    }, options);
+    EXPECT_EQUAL(result, { { "B", "C" } });
+}
+
+STUDENT_TEST("ExhaustiveMatching adds every worker's counts to its stats") {
+    mt19937 generator(11);
+    CompactGraph graph = randomGraph(generator, 16, 2, 1, 5);
+
+    ExhaustiveOptions options;
+    options.numThreads = 3;
+    ExhaustiveMatching solver(graph, options);
+    SolverStats stats;
+    solver.setStats(&stats);
+    solver.solve();
+
+    EXPECT_EQUAL(stats.nodesExpanded, SolverStats::kEnabled ? solver.nodesExpanded() : 0);
+    EXPECT_EQUAL(stats.prunes > 0, SolverStats::kEnabled);
+}
+
+STUDENT_TEST("ExhaustiveMatching handles empty and link-free groups") {
+    EXPECT_EQUAL(exhaustiveMaximumWeightMatching({}), {});
+    EXPECT_EQUAL(exhaustiveMaximumWeightMatching({ { "A", {} }, { "B", {} } }), {});
+}
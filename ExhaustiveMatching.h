@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "CompactGraph.h"
+#include "MatchingScore.h"
+#include "SolverStats.h"
+
+/* Decides whether u and v may be paired, given the pairs chosen so far. Lets the
+ * exhaustive search honour rules that depend on the whole matching (quotas, "no
+ * more than two cross-team pairs", ...), which a polynomial algorithm can't express.
+ */
+using PairConstraint = std::function<bool(const MatchingScore& partial, uint32_t u, uint32_t v)>;
+
+struct ExhaustiveOptions {
+    /* Worker threads. 0 means one per hardware thread. */
+    int numThreads = 0;
+
+    /* The first splitDepth decisions of the search tree are enumerated up front,
+     * and every resulting subtree becomes a task.
+     */
+    int splitDepth = 8;
+
+    /* Optional. If set, a pair is only considered when this returns true. */
+    PairConstraint constraint;
+};
+
+/* Exact maximum-weight matching by branch and bound over every matching, run in
+ * parallel.
+ *
+ * The search decides people in id order: each person is first left unpaired, then
+ * paired with each later, still-undecided neighbour in id order. The top of that
+ * tree is cut into tasks, which worker threads take from their own queues and steal
+ * from each other's when they run dry. All workers prune against one shared best
+ * weight, kept in an atomic.
+ *
+ * The answer doesn't depend on the number of threads or on scheduling: subtrees
+ * are only pruned when they are strictly worse than something already found, and
+ * among equally good matchings the one the sequential search would reach first
+ * wins. That is the same tie-breaking SmallGroupMatching uses.
+ */
+class ExhaustiveMatching {
+public:
+    ExhaustiveMatching(const CompactGraph& graph, const ExhaustiveOptions& options = ExhaustiveOptions());
+
+    /* Runs the search. Returns the total weight of the best matching. */
+    long long solve();
+
+    /* Counts what the search does into stats from now on (see SolverStats.h).
+     * Each worker counts on its own and the totals are added in when solve() ends.
+     * Pass nullptr to stop.
+     */
+    void setStats(SolverStats* stats) {
+        stats_ = stats;
+    }
+
+    std::vector<int> mates() const {
+        return bestMates_;
+    }
+    /* Search tree nodes visited by all workers together. */
+    uint64_t nodesExpanded() const {
+        return nodesExpanded_;
+    }
+    int numTasks() const {
+        return int(tasks_.size());
+    }
+
+private:
+    struct Decision {
+        int person;
+        int partner;  // -1 to leave the person unpaired.
+    };
+    struct Task {
+        size_t first;  // Range of decisions in taskDecisions_.
+        size_t count;
+    };
+
+    void buildTasks();
+    void expandPrefix(std::vector<char>& decided, MatchingScore& score, std::vector<Decision>& prefix, int from);
+    void runWorker(int worker);
+
+    const CompactGraph&    graph_;
+    ExhaustiveOptions      options_;
+    std::vector<long long> heaviest_;   // Each person's heaviest positive link.
+    std::vector<Decision>  taskDecisions_;
+    std::vector<Task>      tasks_;
+
+    std::vector<int>       bestMates_;
+    uint64_t               nodesExpanded_ = 0;
+    SolverStats*           stats_ = nullptr;
+
+    class Pool;
+    Pool* pool_ = nullptr;  // Only set while solve() runs.
+};
+
+/* Convenience wrapper for callers holding a preference map. */
+Set<Pair> exhaustiveMaximumWeightMatching(const Map<std::string, Map<std::string, int>>& possibleLinks,
+                                          const ExhaustiveOptions& options = ExhaustiveOptions());
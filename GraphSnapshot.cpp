@@ -0,0 +1,238 @@
+/*
+ * Memory-mappable graph snapshots. See GraphSnapshot.h.
+ */
+
+#include "GraphSnapshot.h"
+#include <cstring>
+#include <fstream>
+#include "error.h"
+using namespace std;
+
+namespace {
+    const char     kMagic[8] = { 'G', 'R', 'P', 'S', 'N', 'A', 'P', '\0' };
+    const uint32_t kByteOrderMark = 0x01020304;
+    const size_t   kSectionAlignment = 64;
+
+    enum Section {
+        kNames,
+        kNameOffsets,
+        kByName,
+        kOffsets,
+        kTargets,
+        kWeights,
+        kMates,
+        kNumSections
+    };
+
+    struct Header {
+        char     magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t fileSize;
+        uint64_t numPeople;
+        uint64_t numLinks;
+        uint64_t hasMatching;
+        uint64_t sectionStart[kNumSections];   // Byte offsets from the start of the file.
+        uint64_t sectionBytes[kNumSections];
+    };
+
+    size_t roundUp(size_t bytes) {
+        return (bytes + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+    }
+
+    /* Byte sizes of each section for a graph of this shape. */
+    void sectionSizes(Header& header, uint64_t namesBytes) {
+        uint64_t n = header.numPeople;
+        header.sectionBytes[kNames] = namesBytes;
+        header.sectionBytes[kNameOffsets] = (n + 1) * sizeof(uint64_t);
+        header.sectionBytes[kByName] = n * sizeof(uint32_t);
+        header.sectionBytes[kOffsets] = (n + 1) * sizeof(uint64_t);
+        header.sectionBytes[kTargets] = 2 * header.numLinks * sizeof(uint32_t);
+        header.sectionBytes[kWeights] = 2 * header.numLinks * sizeof(int32_t);
+        header.sectionBytes[kMates] = header.hasMatching ? n * sizeof(int32_t) : 0;
+    }
+}
+
+void saveSnapshot(const string& path, const CompactGraph& graph, const vector<int>& mate) {
+    if (!mate.empty() && mate.size() != graph.numPeople()) {
+        error("saveSnapshot: the matching doesn't fit the graph");
+    }
+    const CompactGraph::Arrays& arrays = graph.arrays();
+
+    Header header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = GraphSnapshot::kVersion;
+    header.byteOrder = kByteOrderMark;
+    header.numPeople = arrays.numPeople;
+    header.numLinks = arrays.numLinks;
+    header.hasMatching = !mate.empty();
+    sectionSizes(header, arrays.nameOffsets[arrays.numPeople]);
+
+    uint64_t position = roundUp(sizeof(Header));
+    for (int section = 0; section < kNumSections; section++) {
+        header.sectionStart[section] = position;
+        position = roundUp(position + header.sectionBytes[section]);
+    }
+    header.fileSize = position;
+
+    vector<int32_t> mates(mate.begin(), mate.end());
+    const void* contents[kNumSections] = {
+        arrays.names, arrays.nameOffsets, arrays.byName, arrays.offsets,
+        arrays.targets, arrays.weights, mates.data()
+    };
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) error("Can't write " + path);
+
+    const char padding[kSectionAlignment] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    uint64_t written = sizeof(Header);
+    for (int section = 0; section < kNumSections; section++) {
+        out.write(padding, header.sectionStart[section] - written);
+        out.write(static_cast<const char*>(contents[section]), header.sectionBytes[section]);
+        written = header.sectionStart[section] + header.sectionBytes[section];
+    }
+    out.write(padding, header.fileSize - written);
+
+    if (!out) error("Can't write " + path);
+}
+
+void saveSnapshot(const string& path, const CompactGraph& graph, const Set<Pair>& matching) {
+    vector<int> mate(graph.numPeople(), -1);
+    for (const Pair& pair: matching) {
+        uint32_t one, two;
+        if (!graph.findPerson(pair.first(), one) || !graph.findPerson(pair.second(), two)) {
+            error("saveSnapshot: " + pair.first() + " or " + pair.second() + " isn't in the graph");
+        }
+        mate[one] = two;
+        mate[two] = one;
+    }
+    saveSnapshot(path, graph, mate);
+}
+
+GraphSnapshot::GraphSnapshot(const string& path)
+    : file_(make_shared<MappedFile>(path)) {
+    auto fail = [&](const string& why) {
+        error("Snapshot " + path + ": " + why);
+    };
+
+    if (file_->size() < sizeof(Header)) fail("too short to be a snapshot");
+    const Header& header = *reinterpret_cast<const Header*>(file_->data());
+
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) fail("not a snapshot");
+    if (header.byteOrder != kByteOrderMark) fail("written on a machine with a different byte order");
+    if (header.version != kVersion) {
+        fail("version " + to_string(header.version) + ", but only version " + to_string(kVersion) + " can be read");
+    }
+    if (header.fileSize != file_->size()) fail("truncated");
+    if (header.numPeople >= UINT32_MAX) fail("too many people");
+
+    /* Check the layout, but not the contents. */
+    Header expected = header;
+    sectionSizes(expected, header.sectionBytes[kNames]);
+    for (int section = 0; section < kNumSections; section++) {
+        if (header.sectionBytes[section] != expected.sectionBytes[section] ||
+            header.sectionStart[section] % kSectionAlignment != 0 ||
+            header.sectionStart[section] > header.fileSize ||
+            header.sectionBytes[section] > header.fileSize - header.sectionStart[section]) {
+            fail("corrupt section table");
+        }
+    }
+
+    auto section = [&](int which) {
+        return file_->data() + header.sectionStart[which];
+    };
+
+    CompactGraph::Arrays arrays;
+    arrays.numPeople = uint32_t(header.numPeople);
+    arrays.numLinks = header.numLinks;
+    arrays.names = section(kNames);
+    arrays.nameOffsets = reinterpret_cast<const uint64_t*>(section(kNameOffsets));
+    arrays.byName = reinterpret_cast<const uint32_t*>(section(kByName));
+    arrays.offsets = reinterpret_cast<const uint64_t*>(section(kOffsets));
+    arrays.targets = reinterpret_cast<const uint32_t*>(section(kTargets));
+    arrays.weights = reinterpret_cast<const int32_t*>(section(kWeights));
+
+    if (arrays.nameOffsets[arrays.numPeople] != header.sectionBytes[kNames] ||
+        arrays.offsets[arrays.numPeople] != 2 * header.numLinks) {
+        fail("corrupt offsets");
+    }
+
+    graph_ = CompactGraph::fromArrays(arrays, file_);
+    if (header.hasMatching) {
+        mates_ = reinterpret_cast<const int32_t*>(section(kMates));
+    }
+}
+
+vector<int> GraphSnapshot::mates() const {
+    if (mates_ == nullptr) return vector<int>(graph_.numPeople(), -1);
+    return vector<int>(mates_, mates_ + graph_.numPeople());
+}
+
+Set<Pair> GraphSnapshot::matching() const {
+    return graph_.toPairs(mates());
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <cstdio>
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("GraphSnapshot round-trips a graph and its matching") {
+    Map<string, Map<string, int>> links = {
+        { "A", { { "B", 3 }, { "C", 1 } } },
+        { "B", { { "A", 3 }, { "C", 5 } } },
+        { "C", { { "A", 1 }, { "B", 5 }, { "D", 2 } } },
+        { "D", { { "C", 2 } } },
+        { "E", {} },
+    };
+    CompactGraph graph = CompactGraph::fromWeightedLinks(links);
+    Set<Pair> matching = maximumWeightMatching(links);
+
+    const string path = "graph-snapshot-test.bin";
+    saveSnapshot(path, graph, matching);
+    {
+        GraphSnapshot snapshot(path);
+        EXPECT(snapshot.hasMatching());
+        EXPECT_EQUAL(snapshot.matching(), matching);
+        EXPECT_EQUAL(snapshot.graph().toWeightedLinks(), graph.toWeightedLinks());
+
+        uint32_t id;
+        EXPECT(snapshot.graph().findPerson("D", id));
+        EXPECT_EQUAL(id, 3);
+
+        /* The graph can be solved straight off the mapping, and outlive the snapshot. */
+        CompactGraph copy = snapshot.graph();
+        EXPECT_EQUAL(copy.toPairs(maximumWeightMatchingById(copy)), matching);
+    }
+
+    saveSnapshot(path, graph);
+    EXPECT(!GraphSnapshot(path).hasMatching());
+    remove(path.c_str());
+}
+
+STUDENT_TEST("GraphSnapshot handles empty graphs and rejects damaged files") {
+    const string path = "graph-snapshot-test.bin";
+    saveSnapshot(path, CompactGraph());
+    EXPECT_EQUAL(GraphSnapshot(path).graph().numPeople(), 0);
+
+    /* Lop off the last byte. */
+    string contents;
+    {
+        ifstream in(path, ios::binary);
+        contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        out.write(contents.data(), contents.size() - 1);
+    }
+    EXPECT_ERROR(GraphSnapshot{path});
+
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        out << "from,to,weight\nA,B,1\n" << string(200, '\n');
+    }
+    EXPECT_ERROR(GraphSnapshot{path});
+    remove(path.c_str());
+}
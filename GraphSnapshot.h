@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CompactGraph.h"
+#include "MappedFile.h"
+
+/* Binary snapshots of a CompactGraph, optionally with a solved matching.
+ *
+ * A snapshot is the graph's arrays written out as they sit in memory (names,
+ * CSR offsets, neighbours, weights), each section aligned to 64 bytes, behind a
+ * small versioned header. Opening one maps the file and points a CompactGraph
+ * straight at the mapping, so loading costs a few checks on the header no matter
+ * how big the graph is, and nothing is allocated per person or per link.
+ *
+ * Snapshots use the byte order of the machine that wrote them; opening one on a
+ * machine with the other byte order is reported as an error, as is a wrong
+ * version or a truncated file. The arrays themselves are trusted, so only open
+ * snapshots that saveSnapshot wrote.
+ */
+
+/* Writes graph to path. If mate isn't empty, it is stored too: mate[v] is v's partner, or -1. */
+void saveSnapshot(const std::string& path, const CompactGraph& graph, const std::vector<int>& mate = {});
+
+/* Same, with the matching given by name. Reports an error if a pair names someone not in the graph. */
+void saveSnapshot(const std::string& path, const CompactGraph& graph, const Set<Pair>& matching);
+
+class GraphSnapshot {
+public:
+    /* Bumped whenever the layout changes. */
+    static const uint32_t kVersion = 1;
+
+    /* Maps the snapshot at path. Reports an error if it isn't a valid snapshot. */
+    explicit GraphSnapshot(const std::string& path);
+
+    /* Valid for as long as the snapshot, or any copy of the graph, is around. */
+    const CompactGraph& graph() const {
+        return graph_;
+    }
+
+    bool hasMatching() const {
+        return mates_ != nullptr;
+    }
+    /* The stored matching, or everyone unpaired if there isn't one. */
+    std::vector<int> mates() const;
+    Set<Pair> matching() const;
+
+private:
+    std::shared_ptr<MappedFile> file_;
+    CompactGraph                graph_;
+    const int32_t*              mates_ = nullptr;
+};
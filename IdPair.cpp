@@ -0,0 +1,123 @@
+/*
+ * Id-based pairs and the sets built on them. See IdPair.h.
+ */
+
+#include "IdPair.h"
+#include <algorithm>
+using namespace std;
+
+size_t IdPairHashSet::home(uint64_t key) const {
+    return IdPairHash()(IdPair(uint32_t(key >> 32), uint32_t(key))) & (slots_.size() - 1);
+}
+
+size_t IdPairHashSet::findSlot(uint64_t key) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = home(key); ; slot = (slot + 1) & mask) {
+        if (slots_[slot] == key || slots_[slot] == kEmpty) return slot;
+    }
+}
+
+void IdPairHashSet::grow(size_t capacity) {
+    vector<uint64_t> old(capacity, kEmpty);
+    old.swap(slots_);
+    for (uint64_t key: old) {
+        if (key != kEmpty) slots_[findSlot(key)] = key;
+    }
+}
+
+void IdPairHashSet::reserve(size_t count) {
+    /* Keep the table at most half full. */
+    size_t capacity = 16;
+    while (capacity < 2 * count) capacity *= 2;
+    if (capacity > slots_.size()) grow(capacity);
+}
+
+bool IdPairHashSet::insert(IdPair pair) {
+    reserve(size_ + 1);
+    size_t slot = findSlot(pair.key());
+    if (slots_[slot] != kEmpty) return false;
+    slots_[slot] = pair.key();
+    size_++;
+    return true;
+}
+
+bool IdPairHashSet::contains(IdPair pair) const {
+    return !slots_.empty() && slots_[findSlot(pair.key())] != kEmpty;
+}
+
+bool IdPairHashSet::erase(IdPair pair) {
+    if (slots_.empty()) return false;
+    size_t hole = findSlot(pair.key());
+    if (slots_[hole] == kEmpty) return false;
+
+    /* Pull back any later entry in the run that could have lived in the hole, so that
+     * no lookup ever stops at the hole before reaching what it is after.
+     */
+    size_t mask = slots_.size() - 1;
+    for (size_t next = (hole + 1) & mask; slots_[next] != kEmpty; next = (next + 1) & mask) {
+        size_t wanted = home(slots_[next]);
+        bool reachesHole = hole <= next ? (wanted <= hole || wanted > next)
+                                        : (wanted <= hole && wanted > next);
+        if (reachesHole) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole] = kEmpty;
+    size_--;
+    return true;
+}
+
+void IdPairHashSet::clear() {
+    fill(slots_.begin(), slots_.end(), kEmpty);
+    size_ = 0;
+}
+
+vector<IdPair> IdPairHashSet::sorted() const {
+    vector<IdPair> result;
+    result.reserve(size_);
+    for (IdPair pair: *this) {
+        result.push_back(pair);
+    }
+    sort(result.begin(), result.end());
+    return result;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include <unordered_set>
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("IdPair is eight bytes and sorts its ids") {
+    static_assert(sizeof(IdPair) == 8, "IdPair should be two uint32_ts");
+    EXPECT(IdPair(7, 3) == IdPair(3, 7));
+    EXPECT_EQUAL(IdPair(7, 3).first, 3);
+    EXPECT(IdPair(1, 9) < IdPair(2, 3));
+}
+
+STUDENT_TEST("IdPairHashSet agrees with a standard set through many inserts and erases") {
+    mt19937 generator(5);
+    IdPairHashSet pairs;
+    unordered_set<uint64_t> reference;
+    for (int step = 0; step < 20000; step++) {
+        IdPair pair(generator() % 60, generator() % 60);
+        if (generator() % 3 == 0) {
+            EXPECT_EQUAL(pairs.erase(pair), reference.erase(pair.key()) == 1);
+        } else {
+            EXPECT_EQUAL(pairs.insert(pair), reference.insert(pair.key()).second);
+        }
+    }
+    EXPECT_EQUAL(pairs.size(), reference.size());
+    for (IdPair pair: pairs) {
+        EXPECT(reference.count(pair.key()) == 1);
+    }
+    for (uint64_t key: reference) {
+        EXPECT(pairs.contains(IdPair(uint32_t(key >> 32), uint32_t(key))));
+    }
+
+    pairs.clear();
+    EXPECT(pairs.isEmpty());
+    EXPECT(!pairs.contains(IdPair(1, 2)));
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* An unordered pair of people by id: the 8-byte counterpart of Pair.
+ *
+ * Pair holds two strings and compares them character by character, so every
+ * insert into a Set<Pair> compares strings and copying one may allocate. An
+ * IdPair is two uint32_ts, smaller first, compared as one 64-bit key. Use it
+ * while solving and turn the result back into Pairs at the end.
+ */
+struct IdPair {
+    uint32_t first = 0;
+    uint32_t second = 0;
+
+    IdPair() = default;
+    IdPair(uint32_t one, uint32_t two)
+        : first(one < two ? one : two), second(one < two ? two : one) {
+    }
+
+    /* Both ids in one word, ordered the same way as the pairs. */
+    uint64_t key() const {
+        return (uint64_t(first) << 32) | second;
+    }
+
+    bool operator== (IdPair rhs) const {
+        return key() == rhs.key();
+    }
+    bool operator!= (IdPair rhs) const {
+        return key() != rhs.key();
+    }
+    bool operator< (IdPair rhs) const {
+        return key() < rhs.key();
+    }
+};
+
+/* Mixes all 64 bits of the key into every bit of the result, so that the low bits
+ * used to pick a slot don't just repeat the second id.
+ */
+struct IdPairHash {
+    size_t operator() (IdPair pair) const {
+        uint64_t h = pair.key();
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return size_t(h);
+    }
+};
+
+/* A hash set of IdPairs in one flat array, with linear probing. Removing a pair
+ * shifts later entries back rather than leaving a tombstone, so lookups never slow
+ * down after many removals. Iteration order is unspecified.
+ */
+class IdPairHashSet {
+public:
+    IdPairHashSet() = default;
+
+    /* Makes room for count pairs without growing. */
+    void reserve(size_t count);
+
+    /* Returns whether the pair was new. */
+    bool insert(IdPair pair);
+    /* Returns whether the pair was there. */
+    bool erase(IdPair pair);
+    bool contains(IdPair pair) const;
+
+    size_t size() const {
+        return size_;
+    }
+    bool isEmpty() const {
+        return size_ == 0;
+    }
+    void clear();
+
+    /* The pairs in sorted order. */
+    std::vector<IdPair> sorted() const;
+
+    class const_iterator {
+    public:
+        IdPair operator* () const {
+            return IdPair(uint32_t(*slot_ >> 32), uint32_t(*slot_));
+        }
+        const_iterator& operator++ () {
+            ++slot_;
+            skipEmpty();
+            return *this;
+        }
+        bool operator!= (const const_iterator& rhs) const {
+            return slot_ != rhs.slot_;
+        }
+        bool operator== (const const_iterator& rhs) const {
+            return slot_ == rhs.slot_;
+        }
+
+    private:
+        friend class IdPairHashSet;
+        const_iterator(const uint64_t* slot, const uint64_t* end)
+            : slot_(slot), end_(end) {
+            skipEmpty();
+        }
+        void skipEmpty() {
+            while (slot_ != end_ && *slot_ == kEmpty) ++slot_;
+        }
+
+        const uint64_t* slot_;
+        const uint64_t* end_;
+    };
+
+    const_iterator begin() const {
+        return const_iterator(slots_.data(), slots_.data() + slots_.size());
+    }
+    const_iterator end() const {
+        return const_iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size());
+    }
+
+private:
+    /* Ids are always below UINT32_MAX, so no real pair has this key. */
+    static constexpr uint64_t kEmpty = ~uint64_t(0);
+
+    size_t home(uint64_t key) const;
+    size_t findSlot(uint64_t key) const;
+    void   grow(size_t capacity);
+
+    std::vector<uint64_t> slots_;   // Pair keys, or kEmpty. The size is a power of two.
+    size_t                size_ = 0;
+};
@@ -0,0 +1,235 @@
+/*
+ * Undirected link storage and preference map validation. See LinkStore.h.
+ */
+
+#include "LinkStore.h"
+#include "ComponentMatching.h"
+#include "error.h"
+using namespace std;
+
+string LinkIssue::describe() const {
+    switch (kind) {
+    case kSelfLink:
+        return from + " lists themselves.";
+    case kUnknownPerson:
+        return from + " lists " + to + ", who isn't in the group.";
+    case kOneSided:
+        return from + " lists " + to + " (weight " + to_string(weight) + "), but " + to + " doesn't list " + from + ".";
+    case kMismatchedWeights:
+        return from + " gives " + to + " weight " + to_string(weight) + ", but " + to + " gives " + from +
+               " weight " + to_string(otherWeight) + ".";
+    }
+    return "";
+}
+
+LinkStore LinkStore::fromWeightedLinks(const Map<string, Map<string, int>>& possibleLinks, vector<LinkIssue>* issues) {
+    auto report = [&](LinkIssue::Kind kind, const string& from, const string& to, int weight, int otherWeight) {
+        if (issues != nullptr) issues->push_back({ kind, from, to, weight, otherWeight });
+    };
+
+    LinkStore store;
+    for (const string& person: possibleLinks) {
+        store.ids_.emplace_hint(store.ids_.end(), person, uint32_t(store.ids_.size()));
+    }
+
+    /* People come in sorted order, and so do their ids, so a link is first seen
+     * from its lower id if they list it. These are the links only seen from that
+     * side so far; whatever is left at the end was never listed back.
+     */
+    IdPairHashSet firstSideOnly;
+    uint32_t from = 0;
+    for (const string& person: possibleLinks) {
+        Map<string, int> linked = possibleLinks[person];
+        for (const string& other: linked) {
+            int weight = linked[other];
+            uint32_t to;
+            if (other == person) {
+                report(LinkIssue::kSelfLink, person, other, weight, 0);
+                continue;
+            }
+            if (!store.findId(other, to)) {
+                report(LinkIssue::kUnknownPerson, person, other, weight, 0);
+                continue;
+            }
+
+            IdPair pair(from, to);
+            if (from < to) {
+                store.links_.emplace(pair, weight);
+                firstSideOnly.insert(pair);
+            } else if (firstSideOnly.erase(pair)) {
+                int kept = store.links_[pair];
+                if (kept != weight) report(LinkIssue::kMismatchedWeights, other, person, kept, weight);
+            } else {
+                store.links_[pair] = weight;
+                report(LinkIssue::kOneSided, person, other, weight, 0);
+            }
+        }
+        from++;
+    }
+
+    if (!firstSideOnly.isEmpty()) {
+        vector<const string*> names = store.namesById();
+        for (IdPair pair: firstSideOnly.sorted()) {
+            report(LinkIssue::kOneSided, *names[pair.first], *names[pair.second], store.links_[pair], 0);
+        }
+    }
+    return store;
+}
+
+uint32_t LinkStore::idOf(const string& person) {
+    return ids_.emplace(person, uint32_t(ids_.size())).first->second;
+}
+
+bool LinkStore::findId(const string& person, uint32_t& id) const {
+    auto found = ids_.find(person);
+    if (found == ids_.end()) return false;
+    id = found->second;
+    return true;
+}
+
+vector<const string*> LinkStore::namesById() const {
+    vector<const string*> names(ids_.size());
+    for (const auto& entry: ids_) {
+        names[entry.second] = &entry.first;
+    }
+    return names;
+}
+
+void LinkStore::addPerson(const string& person) {
+    idOf(person);
+}
+
+void LinkStore::setWeight(const string& one, const string& two, int weight) {
+    if (one == two) error("LinkStore: " + one + " can't be linked to themselves");
+    uint32_t first = idOf(one);
+    links_[IdPair(first, idOf(two))] = weight;
+}
+
+void LinkStore::removeLink(const string& one, const string& two) {
+    uint32_t first, second;
+    if (findId(one, first) && findId(two, second)) links_.erase(IdPair(first, second));
+}
+
+bool LinkStore::containsLink(const string& one, const string& two) const {
+    uint32_t first, second;
+    return findId(one, first) && findId(two, second) && links_.count(IdPair(first, second)) != 0;
+}
+
+int LinkStore::weight(const string& one, const string& two) const {
+    uint32_t first, second;
+    if (!findId(one, first) || !findId(two, second)) return 0;
+    auto found = links_.find(IdPair(first, second));
+    return found == links_.end() ? 0 : found->second;
+}
+
+CompactGraph LinkStore::toGraph() const {
+    /* The graph numbers people in sorted order, which ids only follow if nobody was
+     * added out of order.
+     */
+    CompactGraphBuilder builder;
+    vector<uint32_t> graphId(ids_.size());
+    for (const auto& entry: ids_) {
+        graphId[entry.second] = builder.intern(entry.first);
+    }
+    builder.reserveLinks(links_.size());
+
+    for (const auto& link: links_) {
+        builder.addLink(graphId[link.first.first], graphId[link.first.second], link.second);
+    }
+    return builder.build();
+}
+
+Map<string, Map<string, int>> LinkStore::toWeightedLinks() const {
+    Map<string, Map<string, int>> result;
+    for (const auto& entry: ids_) {
+        result[entry.first];
+    }
+    vector<const string*> names = namesById();
+    for (const auto& link: links_) {
+        const string& one = *names[link.first.first];
+        const string& two = *names[link.first.second];
+        result[one][two] = link.second;
+        result[two][one] = link.second;
+    }
+    return result;
+}
+
+vector<LinkIssue> validateWeightedLinks(const Map<string, Map<string, int>>& possibleLinks) {
+    vector<LinkIssue> issues;
+    LinkStore::fromWeightedLinks(possibleLinks, &issues);
+    return issues;
+}
+
+Set<Pair> maximumWeightMatching(const LinkStore& links, SolverStats* stats) {
+    CompactGraph graph;
+    {
+        StatsTimer timer(stats, &SolverStats::secondsConverting);
+        graph = links.toGraph();
+        MATCHING_STAT_INC(stats, mapConversions);
+    }
+
+    vector<int> mate = maximumWeightMatchingByComponent(graph, ComponentOptions(), stats);
+
+    StatsTimer timer(stats, &SolverStats::secondsConverting);
+    MATCHING_STAT_INC(stats, mapConversions);
+    return graph.toPairs(mate);
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("LinkStore keeps each link once and reports what's odd about a preference map") {
+    Map<string, Map<string, int>> links = {
+        { "A", { { "A", 4 }, { "B", 3 }, { "C", 1 }, { "Zed", 2 } } },
+        { "B", { { "A", 3 }, { "C", 5 } } },
+        { "C", { { "A", 7 }, { "D", 2 } } },
+        { "D", {} },
+        { "E", {} },
+    };
+
+    vector<LinkIssue> issues;
+    LinkStore store = LinkStore::fromWeightedLinks(links, &issues);
+    EXPECT_EQUAL(store.numPeople(), 5);
+    EXPECT_EQUAL(store.numLinks(), 4);
+    EXPECT_EQUAL(store.weight("C", "A"), 1);
+    EXPECT_EQUAL(store.weight("B", "C"), 5);
+    EXPECT_EQUAL(store.weight("D", "C"), 2);
+    EXPECT(!store.containsLink("A", "D"));
+
+    Vector<string> found;
+    for (const LinkIssue& issue: issues) {
+        found.add(issue.describe());
+    }
+    EXPECT_EQUAL(found, {
+        "A lists themselves.",
+        "A lists Zed, who isn't in the group.",
+        "A gives C weight 1, but C gives A weight 7.",
+        "B lists C (weight 5), but C doesn't list B.",
+        "C lists D (weight 2), but D doesn't list C.",
+    });
+    EXPECT_EQUAL(validateWeightedLinks(links).size(), issues.size());
+
+    /* The same links CompactGraph would read, and the same matching. */
+    EXPECT_EQUAL(store.toGraph().toWeightedLinks(), CompactGraph::fromWeightedLinks(links).toWeightedLinks());
+    EXPECT_EQUAL(maximumWeightMatching(store), maximumWeightMatching(links));
+    EXPECT(validateWeightedLinks(store.toWeightedLinks()).empty());
+}
+
+STUDENT_TEST("LinkStore can be edited by name") {
+    LinkStore store;
+    store.setWeight("B", "A", 2);
+    store.setWeight("A", "B", 6);
+    store.setWeight("C", "D", 1);
+    store.addPerson("E");
+    EXPECT_EQUAL(store.numLinks(), 2);
+    EXPECT_EQUAL(store.weight("B", "A"), 6);
+    EXPECT_EQUAL(maximumWeightMatching(store), { { "A", "B" }, { "C", "D" } });
+    EXPECT_EQUAL(string(store.toGraph().name(0)), "A");   // Sorted, though B was added first.
+
+    store.removeLink("D", "C");
+    EXPECT_EQUAL(store.numLinks(), 1);
+    EXPECT_EQUAL(store.numPeople(), 5);
+    EXPECT_ERROR(store.setWeight("A", "A", 1));
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CompactGraph.h"
+#include "IdPair.h"
+#include "Matchmaker.h"
+#include "SolverStats.h"
+#include "map.h"
+#include "set.h"
+
+/* Something wrong with a preference map, as found by LinkStore::fromWeightedLinks. */
+struct LinkIssue {
+    enum Kind {
+        kSelfLink,           // from lists themselves. Dropped.
+        kUnknownPerson,      // from lists to, who isn't in the map. Dropped.
+        kOneSided,           // from lists to, but not the other way round. Kept.
+        kMismatchedWeights   // Both list each other, with different weights. from's weight (the
+                             // alphabetically first) is kept; otherWeight is to's.
+    };
+
+    Kind        kind;
+    std::string from;
+    std::string to;
+    int         weight = 0;
+    int         otherWeight = 0;
+
+    std::string describe() const;
+};
+
+/* Weighted links between people, with each undirected link stored once, keyed by
+ * the IdPair of its people's ids.
+ *
+ * The usual Map<string, Map<string, int>> keeps every weight twice, once in each
+ * person's map, each time under a copy of a name, and nothing makes the two agree.
+ * Here each name is kept once, with an id, and a link is just an 8-byte id pair
+ * and a weight, so it can't disagree with itself and costs a fraction of the
+ * memory. A graph can be built by walking the links once without looking anything
+ * up by name.
+ */
+class LinkStore {
+public:
+    LinkStore() = default;
+
+    /* Reads a map in the usual format in one pass over its entries. Links are kept
+     * under the same rules CompactGraph::fromWeightedLinks uses, and anything odd
+     * along the way is appended to issues, if given.
+     */
+    static LinkStore fromWeightedLinks(const Map<std::string, Map<std::string, int>>& possibleLinks,
+                                       std::vector<LinkIssue>* issues = nullptr);
+
+    /* Adds someone with no links yet. Does nothing if they are already here. */
+    void addPerson(const std::string& person);
+
+    /* Links one and two with the given weight, adding either of them if needed,
+     * or changes the weight if they are already linked. Reports an error if one
+     * and two are the same person.
+     */
+    void setWeight(const std::string& one, const std::string& two, int weight);
+
+    /* Unlinks one and two, if they are linked. Both stay in the store. */
+    void removeLink(const std::string& one, const std::string& two);
+
+    bool containsLink(const std::string& one, const std::string& two) const;
+    /* The weight of the link between one and two, or 0 if they aren't linked. */
+    int weight(const std::string& one, const std::string& two) const;
+
+    int numPeople() const {
+        return int(ids_.size());
+    }
+    int numLinks() const {
+        return int(links_.size());
+    }
+
+    /* People are numbered in sorted order, as CompactGraph::fromWeightedLinks does. */
+    CompactGraph toGraph() const;
+
+    /* Back to the usual format, with every weight written in both directions. */
+    Map<std::string, Map<std::string, int>> toWeightedLinks() const;
+
+private:
+    /* person's id, adding them if they're new. */
+    uint32_t idOf(const std::string& person);
+    bool findId(const std::string& person, uint32_t& id) const;
+    /* Everyone's name, by id. */
+    std::vector<const std::string*> namesById() const;
+
+    std::map<std::string, uint32_t>              ids_;     // Ids go up in the order people were added.
+    std::unordered_map<IdPair, int, IdPairHash>  links_;
+};
+
+/* Every problem fromWeightedLinks would find in possibleLinks. */
+std::vector<LinkIssue> validateWeightedLinks(const Map<std::string, Map<std::string, int>>& possibleLinks);
+
+/* maximumWeightMatching, for links already in a LinkStore. */
+Set<Pair> maximumWeightMatching(const LinkStore& links, SolverStats* stats = nullptr);
@@ -0,0 +1,56 @@
+/*
+ * Read-only file mappings. See MappedFile.h.
+ */
+
+#include "MappedFile.h"
+#include "error.h"
+#if defined(_WIN32)
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+MappedFile::MappedFile(const string& path) {
+#if defined(_WIN32)
+    ifstream input(path, ios::binary);
+    if (!input) error("Can't open " + path);
+    ostringstream contents;
+    contents << input.rdbuf();
+    copy_ = contents.str();
+    text_ = copy_;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) error("Can't open " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        error("Can't read " + path);
+    }
+    size_t size = size_t(info.st_size);
+
+    /* mmap refuses empty files, and there's nothing to read anyway. */
+    if (size > 0) {
+        mapping_ = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping_ == MAP_FAILED) {
+            mapping_ = nullptr;
+            close(fd);
+            error("Can't map " + path);
+        }
+        madvise(mapping_, size, MADV_SEQUENTIAL);
+        text_ = string_view(static_cast<const char*>(mapping_), size);
+    }
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+    if (mapping_ != nullptr) munmap(mapping_, text_.size());
+#endif
+}
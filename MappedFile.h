@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+/* A read-only view of a whole file, memory-mapped where the platform allows it
+ * (and read into memory otherwise). The contents stay valid until the object is
+ * destroyed. Reports an error if the file can't be opened.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    std::string_view text() const {
+        return text_;
+    }
+    const char* data() const {
+        return text_.data();
+    }
+    size_t size() const {
+        return text_.size();
+    }
+
+private:
+    std::string_view text_;
+#if defined(_WIN32)
+    std::string      copy_;
+#else
+    void*            mapping_ = nullptr;
+#endif
+};
@@ -0,0 +1,389 @@
+/*
+ * A matching maintained under updates to the preference graph. See Matcher.h.
+ */
+
+#include "Matcher.h"
+#include <algorithm>
+#include "BlossomMatching.h"
+#include "error.h"
+using namespace std;
+
+Matcher::Matcher(MatchObjective objective)
+    : objective_(objective) {
+}
+
+int Matcher::idOf(const string& name) const {
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        error("Matcher: no one named " + name);
+    }
+    return it->second;
+}
+
+int Matcher::findOrAdd(const string& name) {
+    auto it = ids_.find(name);
+    if (it != ids_.end()) return it->second;
+
+    int id;
+    if (!freeIds_.empty()) {
+        id = freeIds_.back();
+        freeIds_.pop_back();
+        names_[id] = name;
+    } else {
+        id = int(names_.size());
+        names_.push_back(name);
+        links_.emplace_back();
+        mate_.push_back(-1);
+        localId_.push_back(-1);
+    }
+    ids_[name] = id;
+    numPeople_++;
+    return id;
+}
+
+Matcher::Link* Matcher::findLink(int u, int v) {
+    for (Link& link: links_[u]) {
+        if (link.to == v) return &link;
+    }
+    return nullptr;
+}
+
+void Matcher::eraseLink(int u, int v) {
+    auto& links = links_[u];
+    links.erase(find_if(links.begin(), links.end(), [&](const Link& link) {
+        return link.to == v;
+    }));
+}
+
+bool Matcher::usable(int weight) const {
+    return objective_ == MatchObjective::MaxCardinality || weight > 0;
+}
+
+void Matcher::pair(int u, int v) {
+    mate_[u] = v;
+    mate_[v] = u;
+    numPairs_++;
+    weight_ += findLink(u, v)->weight;
+}
+
+void Matcher::unpair(int u) {
+    int v = mate_[u];
+    weight_ -= findLink(u, v)->weight;
+    numPairs_--;
+    mate_[u] = mate_[v] = -1;
+}
+
+void Matcher::addPerson(const string& name) {
+    findOrAdd(name);
+}
+
+void Matcher::removePerson(const string& name) {
+    int x = idOf(name);
+    int partner = mate_[x];
+    if (partner != -1) unpair(x);
+
+    for (const Link& link: links_[x]) {
+        eraseLink(link.to, x);
+    }
+    links_[x].clear();
+    ids_.erase(name);
+    freeIds_.push_back(x);
+    numPeople_--;
+
+    /* Only the old partner can have lost out. */
+    if (partner != -1) {
+        if (objective_ == MatchObjective::MaxCardinality) {
+            augment({ partner }, { partner });
+        } else {
+            resolve({ partner });
+        }
+    }
+}
+
+void Matcher::addLink(const string& one, const string& two, int weight) {
+    if (one == two) return;
+    int u = findOrAdd(one);
+    int v = findOrAdd(two);
+    if (findLink(u, v) != nullptr) {
+        setWeight(one, two, weight);
+        return;
+    }
+
+    links_[u].push_back({ v, weight });
+    links_[v].push_back({ u, weight });
+
+    if (objective_ == MatchObjective::MaxCardinality) {
+        if (mate_[u] == -1 && mate_[v] == -1) {
+            pair(u, v);
+        } else if (mate_[u] == -1 || mate_[v] == -1) {
+            /* Any new augmenting path uses the new link, so it ends at whichever of them is free. */
+            int root = mate_[u] == -1 ? u : v;
+            augment({ root }, { root });
+        } else {
+            /* The new link may be the middle of a path between two unpaired people elsewhere. */
+            augment({ u }, {});
+        }
+    } else if (weight > 0) {
+        resolve({ u });
+    }
+}
+
+void Matcher::removeLink(const string& one, const string& two) {
+    int u = idOf(one);
+    int v = idOf(two);
+    if (findLink(u, v) == nullptr) {
+        error("Matcher: " + one + " and " + two + " aren't linked");
+    }
+
+    bool used = mate_[u] == v;
+    if (used) unpair(u);
+    eraseLink(u, v);
+    eraseLink(v, u);
+
+    /* Dropping a link the matching didn't use can't make it any worse. */
+    if (used) {
+        if (objective_ == MatchObjective::MaxCardinality) {
+            augment({ u, v }, { u, v });
+        } else {
+            resolve({ u, v });
+        }
+    }
+}
+
+void Matcher::setWeight(const string& one, const string& two, int weight) {
+    int u = idOf(one);
+    int v = idOf(two);
+    Link* link = findLink(u, v);
+    if (link == nullptr) {
+        error("Matcher: " + one + " and " + two + " aren't linked");
+    }
+
+    int old = link->weight;
+    bool used = mate_[u] == v;
+    if (used) weight_ += weight - old;
+    link->weight = weight;
+    findLink(v, u)->weight = weight;
+
+    /* Cardinality doesn't care about weights, and a link getting better where it's
+     * already used, or worse where it isn't, leaves the matching optimal.
+     */
+    if (objective_ == MatchObjective::MaxCardinality) return;
+    if (used ? weight >= old : weight <= old) return;
+
+    if (used && !usable(weight)) unpair(u);
+    resolve({ u, v });
+}
+
+CompactGraph Matcher::collectComponent(const vector<int>& seeds) {
+    for (int v: component_) {
+        localId_[v] = -1;
+    }
+    component_.clear();
+
+    for (int seed: seeds) {
+        if (localId_[seed] != -1) continue;
+        localId_[seed] = int(component_.size());
+        component_.push_back(seed);
+
+        for (size_t head = component_.size() - 1; head < component_.size(); head++) {
+            for (const Link& link: links_[component_[head]]) {
+                if (usable(link.weight) && localId_[link.to] == -1) {
+                    localId_[link.to] = int(component_.size());
+                    component_.push_back(link.to);
+                }
+            }
+        }
+    }
+
+    CompactGraphBuilder builder;
+    for (int v: component_) {
+        builder.intern(names_[v]);
+    }
+    for (int v: component_) {
+        for (const Link& link: links_[v]) {
+            if (link.to > v && usable(link.weight)) {
+                builder.addLink(localId_[v], localId_[link.to], link.weight);
+            }
+        }
+    }
+    return builder.build();
+}
+
+void Matcher::writeBack(const vector<int>& localMates) {
+    for (int v: component_) {
+        if (mate_[v] != -1) unpair(v);
+    }
+    for (size_t i = 0; i < component_.size(); i++) {
+        if (localMates[i] > int(i)) {
+            pair(component_[i], component_[localMates[i]]);
+        }
+    }
+}
+
+void Matcher::augment(const vector<int>& seeds, const vector<int>& roots) {
+    CompactGraph graph = collectComponent(seeds);
+    {
+        BlossomMatching engine(graph, workspace_);
+
+        vector<int> mate(component_.size());
+        for (size_t i = 0; i < component_.size(); i++) {
+            int partner = mate_[component_[i]];
+            mate[i] = partner == -1 ? -1 : localId_[partner];
+        }
+        engine.setMates(mate);
+
+        /* No roots means try everyone unpaired in the component. */
+        const vector<int>& candidates = roots.empty() ? component_ : roots;
+        for (int root: candidates) {
+            if (mate_[root] == -1 && engine.augmentFrom(localId_[root])) {
+                writeBack(engine.mates());
+                break;
+            }
+        }
+    }
+    workspace_.reset();
+}
+
+void Matcher::resolve(const vector<int>& seeds) {
+    CompactGraph graph = collectComponent(seeds);
+    writeBack(maximumWeightMatchingById(graph, workspace_));
+    workspace_.reset();
+}
+
+Set<Pair> Matcher::matching() const {
+    Set<Pair> result;
+    for (const auto& entry: ids_) {
+        int partner = mate_[entry.second];
+        if (partner > entry.second) {
+            result += Pair(entry.first, names_[partner]);
+        }
+    }
+    return result;
+}
+
+string Matcher::partnerOf(const string& name) const {
+    int partner = mate_[idOf(name)];
+    return partner == -1 ? "" : names_[partner];
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "GUI/SimpleTest.h"
+
+namespace {
+    /* Replays random updates on a Matcher and a plain map side by side. */
+    struct UpdateFuzzer {
+        mt19937 generator;
+        Map<string, Map<string, int>> links;
+
+        explicit UpdateFuzzer(int seed) : generator(seed) {
+        }
+
+        string person() {
+            return string(1, char('A' + generator() % 16));
+        }
+
+        void step(Matcher& matcher) {
+            string one = person(), two = person();
+            int weight = int(generator() % 7) - 1;
+            switch (generator() % 6) {
+                case 0:
+                    matcher.addPerson(one);
+                    links[one];
+                    break;
+                case 1:
+                    if (links.containsKey(one)) {
+                        matcher.removePerson(one);
+                        for (const string& other: links[one]) {
+                            links[other].remove(one);
+                        }
+                        links.remove(one);
+                    }
+                    break;
+                case 2:
+                case 3:
+                    if (one != two) {
+                        matcher.addLink(one, two, weight);
+                        links[one][two] = links[two][one] = weight;
+                    }
+                    break;
+                case 4:
+                    if (links.containsKey(one) && links[one].containsKey(two)) {
+                        matcher.removeLink(one, two);
+                        links[one].remove(two);
+                        links[two].remove(one);
+                    }
+                    break;
+                case 5:
+                    if (links.containsKey(one) && links[one].containsKey(two)) {
+                        matcher.setWeight(one, two, weight);
+                        links[one][two] = links[two][one] = weight;
+                    }
+                    break;
+            }
+        }
+    };
+}
+
+STUDENT_TEST("Matcher keeps a maximum-weight matching through random updates") {
+    for (int seed = 0; seed < 20; seed++) {
+        UpdateFuzzer fuzzer(seed);
+        Matcher matcher(MatchObjective::MaxWeight);
+        for (int i = 0; i < 200; i++) {
+            fuzzer.step(matcher);
+
+            long long expected = 0;
+            for (const Pair& pair: maximumWeightMatching(fuzzer.links)) {
+                expected += fuzzer.links[pair.first()][pair.second()];
+            }
+            EXPECT_EQUAL(matcher.weight(), expected);
+            EXPECT_EQUAL(matcher.numPeople(), fuzzer.links.size());
+        }
+    }
+}
+
+STUDENT_TEST("Matcher keeps a maximum-cardinality matching through random updates") {
+    for (int seed = 0; seed < 20; seed++) {
+        UpdateFuzzer fuzzer(seed);
+        Matcher matcher(MatchObjective::MaxCardinality);
+        for (int i = 0; i < 200; i++) {
+            fuzzer.step(matcher);
+
+            CompactGraph graph = CompactGraph::fromWeightedLinks(fuzzer.links);
+            BlossomMatching reference(graph);
+            EXPECT_EQUAL(matcher.numPairs(), reference.maximumMatching());
+            EXPECT_EQUAL(matcher.matching().size(), matcher.numPairs());
+        }
+    }
+}
+
+STUDENT_TEST("Matcher repairs the matching when a used link goes away") {
+    /* This world:
+     *
+     *  A --- B --- C --- D
+     *
+     * A--B and C--D are the only perfect matching. Removing C--D leaves D alone.
+     * Adding A--C and B--D then lets everyone pair up again, but only by moving
+     * both of the other pairs.
+     */
+    Matcher matcher(MatchObjective::MaxCardinality);
+    matcher.addLink("A", "B");
+    matcher.addLink("B", "C");
+    matcher.addLink("C", "D");
+    EXPECT(matcher.isPerfect());
+    EXPECT_EQUAL(matcher.partnerOf("D"), "C");
+
+    matcher.removeLink("C", "D");
+    EXPECT(!matcher.isPerfect());
+    EXPECT_EQUAL(matcher.partnerOf("D"), "");
+
+    matcher.addLink("A", "C");
+    matcher.addLink("B", "D");
+    EXPECT(matcher.isPerfect());
+    EXPECT_EQUAL(matcher.matching(), { { "A", "C" }, { "B", "D" } });
+
+    EXPECT_ERROR(matcher.removeLink("A", "D"));
+    EXPECT_ERROR(matcher.removePerson("E"));
+}
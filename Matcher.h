@@ -0,0 +1,113 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Arena.h"
+#include "CompactGraph.h"
+#include "Matchmaker.h"
+#include "map.h"
+#include "set.h"
+
+enum class MatchObjective {
+    MaxCardinality,   // Pair up as many people as possible; weights are ignored.
+    MaxWeight         // Maximize the total weight; links with weight <= 0 are never used.
+};
+
+/* A matching that is kept optimal while the preference graph changes underneath it.
+ *
+ * Every update only repairs the part of the matching it can affect:
+ *
+ *  - For MaxCardinality, one update changes the size of a maximum matching by at
+ *    most one pair, so the repair is a single augmenting-path search (Edmonds'
+ *    blossom algorithm) from the people the update left unpaired, run on the
+ *    connected component they are in.
+ *  - For MaxWeight, the matching outside the affected components stays optimal,
+ *    so only the components containing the changed people are solved again.
+ *    Updates that can't make the current matching worse than optimal (dropping or
+ *    lowering an unused link, raising a used one) don't trigger any solving.
+ *
+ * Either way, an update costs time in proportion to the component it touches
+ * rather than the whole graph.
+ */
+class Matcher {
+public:
+    explicit Matcher(MatchObjective objective = MatchObjective::MaxWeight);
+
+    /* Adds someone with no links. Does nothing if they are already here. */
+    void addPerson(const std::string& name);
+
+    /* Removes someone and all their links. Reports an error if they aren't here. */
+    void removePerson(const std::string& name);
+
+    /* Links two people, adding either of them if needed. Linking people who are already
+     * linked just changes the weight. Linking someone to themselves does nothing.
+     */
+    void addLink(const std::string& one, const std::string& two, int weight = 1);
+
+    /* These report an error if the two people aren't linked. */
+    void removeLink(const std::string& one, const std::string& two);
+    void setWeight(const std::string& one, const std::string& two, int weight);
+
+    Set<Pair> matching() const;
+
+    /* Who name is paired with, or the empty string if they are unpaired. */
+    std::string partnerOf(const std::string& name) const;
+
+    int numPeople() const {
+        return numPeople_;
+    }
+    int numPairs() const {
+        return numPairs_;
+    }
+    /* Total weight of the links used by the matching. */
+    long long weight() const {
+        return weight_;
+    }
+    bool isPerfect() const {
+        return 2 * numPairs_ == numPeople_;
+    }
+
+private:
+    struct Link {
+        int to;
+        int weight;
+    };
+
+    int   idOf(const std::string& name) const;
+    int   findOrAdd(const std::string& name);
+    Link* findLink(int u, int v);
+    void  eraseLink(int u, int v);
+
+    /* Whether the objective can use a link of this weight. */
+    bool usable(int weight) const;
+
+    void pair(int u, int v);
+    void unpair(int u);
+
+    /* Gathers the connected components containing the seeds into component_,
+     * numbering them in localId_, and builds that part of the graph.
+     */
+    CompactGraph collectComponent(const std::vector<int>& seeds);
+    void         writeBack(const std::vector<int>& localMates);
+
+    /* MaxCardinality repair: augments from the first of roots that has an augmenting path. */
+    void augment(const std::vector<int>& seeds, const std::vector<int>& roots);
+
+    /* MaxWeight repair: solves the seeds' components again. */
+    void resolve(const std::vector<int>& seeds);
+
+    MatchObjective                       objective_;
+    std::vector<std::string>             names_;
+    std::unordered_map<std::string, int> ids_;
+    std::vector<std::vector<Link>>       links_;
+    std::vector<int>                     mate_;
+    std::vector<int>                     freeIds_;   // Ids of removed people, for reuse.
+    int                                  numPeople_ = 0;
+    int                                  numPairs_ = 0;
+    long long                            weight_ = 0;
+
+    /* Scratch for repairs. */
+    std::vector<int>                     component_;
+    std::vector<int>                     localId_;   // -1 outside the current component.
+    Arena                                workspace_;
+};
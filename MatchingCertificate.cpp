@@ -0,0 +1,404 @@
+/*
+ * LP dual certificates for maximum-weight matchings, and a checker for them. See
+ * MatchingCertificate.h.
+ */
+
+#include "MatchingCertificate.h"
+#include <utility>
+#include "BipartiteMatching.h"
+#include "WeightedBlossomMatching.h"
+using namespace std;
+
+MatchingCertificate certificateOf(const WeightedBlossomMatching& solver) {
+    int n = solver.size();
+
+    /* Blossom ids run from n to 2n - 1, and only the ones someone is in count. */
+    vector<int> number(2 * n, -1);
+    for (int v = 0; v < n; v++) {
+        for (int b = solver.blossomParent(v); b != -1 && number[b] == -1; b = solver.blossomParent(b)) {
+            number[b] = 0;
+        }
+    }
+    int numBlossoms = 0;
+    for (int b = n; b < 2 * n; b++) {
+        if (number[b] == 0) number[b] = numBlossoms++;
+    }
+
+    MatchingCertificate certificate;
+    certificate.personDual.resize(n);
+    certificate.personBlossom.resize(n);
+    certificate.blossomDual.resize(numBlossoms);
+    certificate.blossomParent.resize(numBlossoms);
+    for (int v = 0; v < n; v++) {
+        certificate.personDual[v] = solver.dual(v);
+        int parent = solver.blossomParent(v);
+        certificate.personBlossom[v] = parent == -1 ? -1 : number[parent];
+    }
+    for (int b = n; b < 2 * n; b++) {
+        if (number[b] == -1) continue;
+        /* The solver keeps blossom duals at their LP value. */
+        certificate.blossomDual[number[b]] = 2 * solver.dual(b);
+        int parent = solver.blossomParent(b);
+        certificate.blossomParent[number[b]] = parent == -1 ? -1 : number[parent];
+    }
+    return certificate;
+}
+
+MatchingCertificate certificateOf(const BipartiteWeightedMatching& solver) {
+    MatchingCertificate certificate;
+    certificate.personDual.resize(solver.size());
+    certificate.personBlossom.assign(solver.size(), -1);
+    for (int v = 0; v < solver.size(); v++) {
+        certificate.personDual[v] = 2 * solver.dual(v);
+    }
+    return certificate;
+}
+
+vector<int> maximumWeightMatchingWithCertificate(const CompactGraph& graph, MatchingCertificate& certificate,
+                                                 Arena& workspace, SolverStats* stats) {
+    StatsTimer timer(stats, &SolverStats::secondsSolving);
+    vector<char> side;
+    if (findBipartition(graph, side)) {
+        BipartiteWeightedMatching engine(graph, side, workspace);
+        engine.setStats(stats);
+        engine.solve();
+        certificate = certificateOf(engine);
+        return engine.mates();
+    }
+
+    WeightedBlossomMatching engine(graph, workspace);
+    engine.setStats(stats);
+    engine.solve();
+    certificate = certificateOf(engine);
+    return engine.mates();
+}
+
+vector<int> maximumWeightMatchingWithCertificate(const CompactGraph& graph, MatchingCertificate& certificate,
+                                                 SolverStats* stats) {
+    Arena workspace;
+    return maximumWeightMatchingWithCertificate(graph, certificate, workspace, stats);
+}
+
+namespace {
+    CertificateProblem problemOf(CertificateProblem::Kind kind, vector<int> people = {}, int blossom = -1) {
+        CertificateProblem problem;
+        problem.kind = kind;
+        problem.people = move(people);
+        problem.blossom = blossom;
+        return problem;
+    }
+
+    /* Union-find by rank with path halving, for the offline ancestor queries. */
+    class DisjointSets {
+    public:
+        explicit DisjointSets(int size) : parent_(size), rank_(size, 0) {
+        }
+        void makeSet(int x) {
+            parent_[x] = x;
+        }
+        int find(int x) {
+            while (parent_[x] != x) {
+                parent_[x] = parent_[parent_[x]];
+                x = parent_[x];
+            }
+            return x;
+        }
+        /* Joins the sets of a and b; returns the representative of the result. */
+        int unite(int a, int b) {
+            a = find(a);
+            b = find(b);
+            if (a == b) return a;
+            if (rank_[a] < rank_[b]) swap(a, b);
+            parent_[b] = a;
+            if (rank_[a] == rank_[b]) rank_[a]++;
+            return a;
+        }
+
+    private:
+        vector<int>  parent_;
+        vector<char> rank_;
+    };
+}
+
+/* People and blossoms form a forest, people at the leaves, walked depth first. As
+ * each person is reached, their links to people reached before are checked: the
+ * blossoms containing both ends are the ancestors of their lowest common ancestor,
+ * which Tarjan's method has on hand for every earlier person in the same tree (and
+ * for people in finished trees there are none). Each blossom totals its doubled
+ * duals from the root down, its people and its pairs from the leaves up.
+ */
+CertificateProblem checkMatchingCertificate(const CompactGraph& graph, const vector<int>& mate,
+                                            const MatchingCertificate& certificate) {
+    int n = int(graph.numPeople());
+    int numBlossoms = int(certificate.blossomDual.size());
+    if (int(mate.size()) != n || int(certificate.personDual.size()) != n ||
+        int(certificate.personBlossom.size()) != n || int(certificate.blossomParent.size()) != numBlossoms) {
+        return problemOf(CertificateProblem::kMalformed);
+    }
+
+    for (int b = 0; b < numBlossoms; b++) {
+        int parent = certificate.blossomParent[b];
+        if (parent < -1 || parent >= numBlossoms || parent == b) return problemOf(CertificateProblem::kMalformed);
+        if (certificate.blossomDual[b] < 0) return problemOf(CertificateProblem::kNegativeDual, {}, b);
+    }
+    for (int v = 0; v < n; v++) {
+        int blossom = certificate.personBlossom[v];
+        if (blossom < -1 || blossom >= numBlossoms) return problemOf(CertificateProblem::kMalformed);
+        if (certificate.personDual[v] < 0) return problemOf(CertificateProblem::kNegativeDual, { v });
+        if (mate[v] < -1 || mate[v] >= n || mate[v] == v || (mate[v] != -1 && mate[mate[v]] != v)) {
+            return problemOf(CertificateProblem::kNotAMatching, { v });
+        }
+        if (mate[v] == -1 && certificate.personDual[v] > 0) {
+            return problemOf(CertificateProblem::kUnpairedWithDual, { v });
+        }
+    }
+
+    /* Nodes 0 .. n - 1 are people and n .. n + numBlossoms - 1 blossoms. */
+    int numNodes = n + numBlossoms;
+    auto parentOf = [&](int x) {
+        int blossom = x < n ? certificate.personBlossom[x] : certificate.blossomParent[x - n];
+        return blossom == -1 ? -1 : n + blossom;
+    };
+    vector<int> childStart(numBlossoms + 1, 0);
+    for (int x = 0; x < numNodes; x++) {
+        if (parentOf(x) != -1) childStart[parentOf(x) - n + 1]++;
+    }
+    for (int b = 0; b < numBlossoms; b++) {
+        childStart[b + 1] += childStart[b];
+    }
+    vector<int> children(childStart.back());
+    vector<int> fill(childStart.begin(), childStart.end() - 1);
+    for (int x = 0; x < numNodes; x++) {
+        if (parentOf(x) != -1) children[fill[parentOf(x) - n]++] = x;
+    }
+
+    DisjointSets sets(numNodes);
+    vector<int> ancestor(numNodes);          // For each set's representative; -1 once its tree is done.
+    vector<long long> enclosing(numNodes);   // Doubled duals of the blossoms containing the node, itself included.
+    vector<int> members(numNodes, 0);
+    vector<int> pairsInside(numNodes, 0);
+    vector<int> someMember(numNodes, -1);
+    vector<char> reached(n, false);
+    vector<char> mateLinked(n, false);
+    int numReached = 0;
+
+    auto enter = [&](int x) {
+        sets.makeSet(x);
+        ancestor[x] = x;
+        numReached++;
+        int parent = parentOf(x);
+        enclosing[x] = (parent == -1 ? 0 : enclosing[parent]) + (x < n ? 0 : certificate.blossomDual[x - n]);
+    };
+
+    vector<pair<int, int>> stack;   // Node, and how many of its children have been entered.
+    for (int root = 0; root < numNodes; root++) {
+        if (parentOf(root) != -1) continue;
+        enter(root);
+        stack.push_back({ root, 0 });
+        while (!stack.empty()) {
+            int x = stack.back().first;
+            if (x >= n && stack.back().second < childStart[x - n + 1] - childStart[x - n]) {
+                int child = children[childStart[x - n] + stack.back().second++];
+                enter(child);
+                stack.push_back({ child, 0 });
+                continue;
+            }
+            stack.pop_back();
+
+            if (x < n) {
+                int u = x;
+                reached[u] = true;
+                members[u] = 1;
+                someMember[u] = u;
+                const int32_t* weight = graph.weightsBegin(u);
+                for (const uint32_t* p = graph.neighboursBegin(u); p != graph.neighboursEnd(u); p++, weight++) {
+                    int v = int(*p);
+                    if (v == mate[u]) mateLinked[u] = mateLinked[v] = true;
+                    if (!reached[v]) continue;
+
+                    int common = ancestor[sets.find(v)];
+                    long long slack = certificate.personDual[u] + certificate.personDual[v] - 2LL * *weight +
+                                      (common == -1 ? 0 : enclosing[common]);
+                    if (slack < 0) return problemOf(CertificateProblem::kUncoveredLink, { u, v });
+                    if (v == mate[u]) {
+                        if (slack != 0) return problemOf(CertificateProblem::kLooseLink, { u, v });
+                        if (common != -1) pairsInside[common]++;
+                    }
+                }
+            } else if (certificate.blossomDual[x - n] > 0 &&
+                       (members[x] % 2 == 0 || pairsInside[x] != members[x] / 2)) {
+                return problemOf(CertificateProblem::kBadBlossom, someMember[x] == -1 ? vector<int>() :
+                                 vector<int>({ someMember[x] }), x - n);
+            }
+
+            int parent = parentOf(x);
+            if (parent == -1) {
+                ancestor[sets.find(x)] = -1;
+            } else {
+                ancestor[sets.unite(parent, x)] = parent;
+                members[parent] += members[x];
+                pairsInside[parent] += pairsInside[x];
+                if (someMember[parent] == -1) someMember[parent] = someMember[x];
+            }
+        }
+    }
+
+    /* Blossoms in a cycle are never reached from a root, and neither is anyone in them. */
+    if (numReached != numNodes) return problemOf(CertificateProblem::kMalformed);
+    for (int v = 0; v < n; v++) {
+        if (mate[v] != -1 && !mateLinked[v]) return problemOf(CertificateProblem::kNotAMatching, { v });
+    }
+    return CertificateProblem();
+}
+
+string CertificateProblem::describe(const CompactGraph& graph) const {
+    auto name = [&](int i) {
+        return string(graph.name(people[i]));
+    };
+    switch (kind) {
+    case kNone:
+        return "The certificate proves the matching is a heaviest one.";
+    case kMalformed:
+        return "The certificate doesn't fit the graph.";
+    case kNotAMatching:
+        return name(0) + "'s partner isn't linked to them, or isn't paired with them.";
+    case kNegativeDual:
+        return people.empty() ? "Blossom " + to_string(blossom) + " has a negative dual."
+                              : name(0) + " has a negative dual.";
+    case kUnpairedWithDual:
+        return name(0) + " is unpaired but has a positive dual.";
+    case kUncoveredLink:
+        return "The link between " + name(0) + " and " + name(1) + " weighs more than its duals cover.";
+    case kLooseLink:
+        return name(0) + " and " + name(1) + " are paired, but their duals more than cover their link.";
+    case kBadBlossom:
+        return "Blossom " + to_string(blossom) + (people.empty() ? "" : " (with " + name(0) + ")") +
+               " has a positive dual but isn't an odd group paired up within itself.";
+    }
+    return "";
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "ApproximateMatching.h"
+#include "MatchingScore.h"
+#include "Matchmaker.h"
+#include "TestGraphs.h"
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("Solvers' certificates check out, and match the weight maximumWeightMatchingById finds") {
+    mt19937 generator(61);
+    int withBlossoms = 0;
+    for (int trial = 0; trial < 60; trial++) {
+        int numPeople = 2 + int(generator() % 60);
+        int linkOdds = 1 + int(generator() % 6);
+        int highestWeight = int(generator() % 30) - 1;
+        /* Every third graph is two-sided, so the Hungarian method's duals get checked too. */
+        CompactGraph graph;
+        if (trial % 3 == 0) {
+            graph = randomTwoSidedGraph(generator, (numPeople + 1) / 2, numPeople / 2, linkOdds, -2, highestWeight, true);
+        } else {
+            graph = randomGraph(generator, numPeople, linkOdds, -2, highestWeight);
+        }
+        MatchingCertificate certificate;
+        vector<int> mate = maximumWeightMatchingWithCertificate(graph, certificate);
+        EXPECT_EQUAL(checkMatchingCertificate(graph, mate, certificate).describe(graph),
+                     "The certificate proves the matching is a heaviest one.");
+
+        MatchingScore found(graph);
+        found.assign(mate);
+        MatchingScore best(graph);
+        best.assign(maximumWeightMatchingById(graph));
+        EXPECT_EQUAL(found.total(), best.total());
+        if (!certificate.blossomDual.empty()) withBlossoms++;
+    }
+    EXPECT(withBlossoms > 0);
+}
+
+STUDENT_TEST("A triangle needs its blossom's dual, which has to be odd and paired up") {
+    /* A, B and C all rate each other 2, and C rates D 1. No person duals can prove 2
+     * is the best A, B and C manage for less than 3, but a blossom dual of 2 on the
+     * triangle can.
+     */
+    CompactGraph graph = CompactGraph::fromWeightedLinks({
+        { "A", { { "B", 2 }, { "C", 2 } } },
+        { "B", { { "C", 2 } } },
+        { "C", { } },
+        { "D", { { "C", 1 } } },
+    });
+    vector<int> mate = { 1, 0, 3, 2 };
+    MatchingCertificate certificate;
+    certificate.personDual = { 0, 0, 1, 1 };
+    certificate.personBlossom = { 0, 0, 0, -1 };
+    certificate.blossomDual = { 4 };
+    certificate.blossomParent = { -1 };
+    EXPECT(checkMatchingCertificate(graph, mate, certificate).ok());
+
+    /* Without the blossom's dual, A -- B isn't covered. */
+    certificate.blossomDual = { 0 };
+    CertificateProblem problem = checkMatchingCertificate(graph, mate, certificate);
+    EXPECT_EQUAL(problem.kind, CertificateProblem::kUncoveredLink);
+    EXPECT_EQUAL(problem.describe(graph), "The link between B and A weighs more than its duals cover.");
+
+    /* Splitting the dual with a blossom of just A and B covers every link, but that
+     * blossom is even.
+     */
+    certificate.personDual = { 0, 0, 2, 0 };
+    certificate.personBlossom = { 1, 1, 0, -1 };
+    certificate.blossomDual = { 2, 2 };
+    certificate.blossomParent = { -1, 0 };
+    problem = checkMatchingCertificate(graph, mate, certificate);
+    EXPECT_EQUAL(problem.kind, CertificateProblem::kBadBlossom);
+    EXPECT_EQUAL(problem.describe(graph),
+                 "Blossom 1 (with A) has a positive dual but isn't an odd group paired up within itself.");
+
+    /* Blossoms that contain each other in a cycle. */
+    certificate.personBlossom = { 0, 0, 0, -1 };
+    certificate.blossomDual = { 4, 0 };
+    certificate.blossomParent = { 1, 0 };
+    EXPECT_EQUAL(checkMatchingCertificate(graph, mate, certificate).kind, CertificateProblem::kMalformed);
+}
+
+STUDENT_TEST("Tampered matchings and duals are caught") {
+    mt19937 generator(9);
+    CompactGraph graph = randomGraph(generator, 80, 4, -2, 37);
+    MatchingCertificate certificate;
+    vector<int> mate = maximumWeightMatchingWithCertificate(graph, certificate);
+    EXPECT(checkMatchingCertificate(graph, mate, certificate).ok());
+
+    /* A worse matching under the same duals. */
+    ApproximateOptions greedyOnly;
+    greedyOnly.maxRounds = 0;
+    vector<int> greedy = approximateMaximumWeightMatchingById(graph, greedyOnly).mates;
+    MatchingScore greedyScore(graph);
+    greedyScore.assign(greedy);
+    MatchingScore bestScore(graph);
+    bestScore.assign(mate);
+    if (greedyScore.total() < bestScore.total()) {
+        EXPECT(!checkMatchingCertificate(graph, greedy, certificate).ok());
+    }
+
+    /* Breaking up a pair leaves two people with duals and nobody. */
+    int u = int(find_if(mate.begin(), mate.end(), [](int m) { return m != -1; }) - mate.begin());
+    vector<int> broken = mate;
+    broken[broken[u]] = -1;
+    broken[u] = -1;
+    CertificateProblem problem = checkMatchingCertificate(graph, broken, certificate);
+    EXPECT(problem.kind == CertificateProblem::kUnpairedWithDual || problem.kind == CertificateProblem::kLooseLink);
+
+    /* Half-pairs, and arrays that don't fit. */
+    broken = mate;
+    broken[mate[u]] = -1;
+    EXPECT_EQUAL(checkMatchingCertificate(graph, broken, certificate).kind, CertificateProblem::kNotAMatching);
+    MatchingCertificate shorter = certificate;
+    shorter.personDual.pop_back();
+    EXPECT_EQUAL(checkMatchingCertificate(graph, mate, shorter).kind, CertificateProblem::kMalformed);
+
+    /* Shaving one person's dual uncovers one of their links or loosens their pair. */
+    MatchingCertificate shaved = certificate;
+    shaved.personDual[u] -= 1;
+    problem = checkMatchingCertificate(graph, mate, shaved);
+    EXPECT(!problem.ok());
+}
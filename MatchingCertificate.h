@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Arena.h"
+#include "CompactGraph.h"
+#include "SolverStats.h"
+
+class BipartiteWeightedMatching;
+class WeightedBlossomMatching;
+
+/* LP dual variables proving that a matching is a maximum-weight one.
+ *
+ * The matching LP has a variable for every person and for every odd-sized group of
+ * people (a blossom); a certificate gives the ones that aren't 0. All values are
+ * doubled so that the halves the blossom algorithm works with stay integers. The
+ * duals prove a matching is the heaviest when
+ *
+ *  - every dual is >= 0;
+ *  - every link u -- v is covered: personDual[u] + personDual[v], plus the
+ *    blossomDual of every blossom containing both, is at least 2 * weight(u, v);
+ *  - paired links are covered exactly, and unpaired people have dual 0;
+ *  - every blossom with a positive dual has an odd number of people, all but one
+ *    paired with each other.
+ *
+ * Then the matching weighs as much as the duals' LP bound, which no matching can
+ * exceed. Blossoms nest: each is listed with the blossom directly containing it.
+ */
+struct MatchingCertificate {
+    std::vector<long long> personDual;
+    std::vector<int>       personBlossom;   // Innermost blossom containing each person, or -1.
+    std::vector<long long> blossomDual;
+    std::vector<int>       blossomParent;   // Blossom directly containing each blossom, or -1.
+};
+
+/* The first thing found wrong with a certificate. */
+struct CertificateProblem {
+    enum Kind {
+        kNone,              // The certificate proves the matching is a heaviest one.
+        kMalformed,         // Arrays of the wrong size, or blossom numbers out of range or in a cycle.
+        kNotAMatching,      // people[0]'s mate isn't linked to them, or doesn't have them as mate.
+        kNegativeDual,      // people[0], or blossom, has a negative dual.
+        kUnpairedWithDual,  // people[0] is unpaired but has a positive dual.
+        kUncoveredLink,     // The link people[0] -- people[1] weighs more than its duals cover.
+        kLooseLink,         // people[0] and people[1] are paired but their duals more than cover the link.
+        kBadBlossom         // blossom has a positive dual but is even, or not all but one of it is paired within.
+    };
+
+    Kind kind = kNone;
+    std::vector<int> people;
+    int blossom = -1;
+
+    bool ok() const {
+        return kind == kNone;
+    }
+
+    /* Says what is wrong, naming the people involved. */
+    std::string describe(const CompactGraph& graph) const;
+};
+
+/* The duals a solver finished with, as a certificate for its matching. Blossoms are
+ * numbered 0 .. B - 1 in the order of the solver's ids, keeping only the ones that
+ * contain someone.
+ */
+MatchingCertificate certificateOf(const WeightedBlossomMatching& solver);
+MatchingCertificate certificateOf(const BipartiteWeightedMatching& solver);
+
+/* maximumWeightMatchingById, along with a certificate proving the answer is optimal:
+ * two-sided graphs are solved by the Hungarian method and the rest by the blossom
+ * algorithm, since those are the solvers that keep duals.
+ */
+std::vector<int> maximumWeightMatchingWithCertificate(const CompactGraph& graph, MatchingCertificate& certificate,
+                                                      Arena& workspace, SolverStats* stats = nullptr);
+std::vector<int> maximumWeightMatchingWithCertificate(const CompactGraph& graph, MatchingCertificate& certificate,
+                                                      SolverStats* stats = nullptr);
+
+/* Checks that certificate proves mate (a mate array) is a maximum-weight matching of
+ * graph, without solving anything. One pass over the links, finding the innermost
+ * blossom containing both ends of each with Tarjan's offline lowest-common-ancestor
+ * method, so O(m + n) time up to an inverse-Ackermann factor, and O(n) space.
+ */
+CertificateProblem checkMatchingCertificate(const CompactGraph& graph, const std::vector<int>& mate,
+                                            const MatchingCertificate& certificate);
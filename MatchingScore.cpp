@@ -0,0 +1,108 @@
+/*
+ * Incrementally scored matchings. See MatchingScore.h.
+ */
+
+#include "MatchingScore.h"
+#include <algorithm>
+#include "error.h"
+using namespace std;
+
+MatchingScore::MatchingScore(const CompactGraph& graph)
+    : graph_(graph),
+      mate_(graph.numPeople(), -1),
+      pairWeight_(graph.numPeople(), 0) {
+}
+
+void MatchingScore::pair(uint32_t u, uint32_t v, long long weight) {
+    if (u == v || mate_[u] != -1 || mate_[v] != -1) {
+        error("MatchingScore: can't pair " + string(graph_.name(u)) + " with " + string(graph_.name(v)));
+    }
+    mate_[u] = int(v);
+    mate_[v] = int(u);
+    pairWeight_[u] = pairWeight_[v] = weight;
+    total_ += weight;
+}
+
+void MatchingScore::addNeighbour(uint32_t u, uint32_t i) {
+    pair(u, graph_.neighboursBegin(u)[i], graph_.weightsBegin(u)[i]);
+}
+
+void MatchingScore::add(uint32_t u, uint32_t v) {
+    pair(u, v, graph_.weight(u, v));
+}
+
+void MatchingScore::remove(uint32_t u) {
+    int v = mate_[u];
+    if (v == -1) return;
+
+    total_ -= pairWeight_[u];
+    mate_[u] = mate_[v] = -1;
+    pairWeight_[u] = pairWeight_[v] = 0;
+}
+
+long long MatchingScore::pairingGain(uint32_t u, uint32_t v, long long weight) const {
+    if (mate_[u] == int(v)) return 0;
+    return weight - pairWeight_[u] - pairWeight_[v];
+}
+
+void MatchingScore::assign(const vector<int>& mate) {
+    clear();
+    for (int v = 0; v < int(mate.size()); v++) {
+        if (mate[v] > v) add(v, mate[v]);
+    }
+}
+
+void MatchingScore::clear() {
+    fill(mate_.begin(), mate_.end(), -1);
+    fill(pairWeight_.begin(), pairWeight_.end(), 0);
+    total_ = 0;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("MatchingScore tracks the total through adds and removes") {
+    /*  A --- B --- C --- D
+     *     3     5     3
+     */
+    CompactGraph graph = CompactGraph::fromWeightedLinks({
+        { "A", { { "B", 3 } } },
+        { "B", { { "A", 3 }, { "C", 5 } } },
+        { "C", { { "B", 5 }, { "D", 3 } } },
+        { "D", { { "C", 3 } } },
+    });
+
+    MatchingScore score(graph);
+    score.add(1, 2);
+    EXPECT_EQUAL(score.total(), 5);
+
+    /* Swapping B--C for A--B and C--D gains 3 + 3 - 5. */
+    EXPECT_EQUAL(score.pairingGain(0, 1, 3), -2);
+    score.remove(2);
+    EXPECT_EQUAL(score.total(), 0);
+    EXPECT_EQUAL(score.mate(1), -1);
+
+    score.addNeighbour(0, 0);
+    score.add(2, 3);
+    EXPECT_EQUAL(score.total(), 6);
+    EXPECT_EQUAL(graph.toPairs(score.mates()), { { "A", "B" }, { "C", "D" } });
+}
+
+STUDENT_TEST("MatchingScore scores an existing matching and rejects double-booking") {
+    CompactGraph graph = CompactGraph::fromWeightedLinks({
+        { "A", { { "B", 4 }, { "C", 1 } } },
+        { "B", { { "A", 4 } } },
+        { "C", { { "A", 1 } } },
+    });
+
+    MatchingScore score(graph);
+    score.assign({ 1, 0, -1 });
+    EXPECT_EQUAL(score.total(), 4);
+    EXPECT_EQUAL(score.pairWeight(0), 4);
+    EXPECT_ERROR(score.add(0, 2));
+
+    score.clear();
+    EXPECT_EQUAL(score.total(), 0);
+}
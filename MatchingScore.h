@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "CompactGraph.h"
+
+/* A matching on a CompactGraph together with its running total weight.
+ *
+ * Every update adjusts the total by the weight of the pair added or removed, so
+ * the score never has to be recomputed from scratch and no copies of the matching
+ * are made. Each person's pair weight is remembered, which makes removing a pair
+ * and asking "what would this change be worth?" O(1) as well.
+ */
+class MatchingScore {
+public:
+    /* Starts with everyone unpaired. The graph must outlive the score. */
+    explicit MatchingScore(const CompactGraph& graph);
+
+    /* Pairs u with their i-th neighbour in the graph. O(1). Both must be unpaired. */
+    void addNeighbour(uint32_t u, uint32_t i);
+
+    /* Pairs u and v, who must both be unpaired. Looks up the link's weight, which
+     * is 0 if they aren't linked. O(log degree).
+     */
+    void add(uint32_t u, uint32_t v);
+
+    /* Unpairs u and their partner, if u is paired. O(1). */
+    void remove(uint32_t u);
+
+    /* Change in total if u and v were paired with each other via a link of the
+     * given weight, after breaking up any pairs they are currently in. O(1).
+     */
+    long long pairingGain(uint32_t u, uint32_t v, long long weight) const;
+
+    /* Replaces the matching with the one described by a mate array. */
+    void assign(const std::vector<int>& mate);
+
+    /* Unpairs everyone. */
+    void clear();
+
+    long long total() const {
+        return total_;
+    }
+    int mate(uint32_t v) const {
+        return mate_[v];
+    }
+    const std::vector<int>& mates() const {
+        return mate_;
+    }
+    /* Weight of the pair v is in, or 0 if v is unpaired. */
+    long long pairWeight(uint32_t v) const {
+        return pairWeight_[v];
+    }
+
+private:
+    void pair(uint32_t u, uint32_t v, long long weight);
+
+    const CompactGraph& graph_;
+    std::vector<int>       mate_;
+    std::vector<long long> pairWeight_;
+    long long              total_ = 0;
+};
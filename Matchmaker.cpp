@@ -5,90 +5,166 @@
  * */
 
 #include "Matchmaker.h"
+#include <algorithm>
+#include "Arena.h"
+#include "BipartiteMatching.h"
+#include "BlossomMatching.h"
+#include "CompactGraph.h"
+#include "ComponentMatching.h"
+#include "DenseMatching.h"
+#include "PerfectMatchingPrecheck.h"
+#include "SmallGroupMatching.h"
+#include "SolverStats.h"
+#include "WeightedBlossomMatching.h"
 #include "map.h"
 #include "set.h"
 using namespace std;
 
 /*
- * This function takes in a constant map, and a set of pairs and returns whether or not these pairs can be matched off perfectly
+ * This function takes in a preference graph and returns whether or not everyone can be matched off perfectly. If they
+ * can, mate is set to one perfect matching; otherwise everyone is left unpaired and why says who is to blame. Cheap
+ * linear-time checks run first and settle most hopeless cases, and pair off anyone with a single option; the rest is
+ * left to Hopcroft-Karp if the graph is two-sided and to Edmonds' blossom algorithm otherwise, so it runs in polynomial
+ * time rather than trying every way to pair people up.
  * */
-bool hasPerfectMatching(const Map<string, Set<string>>& possibleLinks, Set<Pair>& matching) {
-    if (possibleLinks.isEmpty()) { //base case
-        matching = {};
-        return true;
-    } else { //recursive case
-        string firstPerson = possibleLinks.firstKey();
-        Map<string, Set<string>> posLinksCopy = possibleLinks;
-        posLinksCopy.remove(firstPerson);
-        for (const string& possibleLink: posLinksCopy) {
-            Map<string, Set<string>> remainingLinks = posLinksCopy;
-            if (remainingLinks[possibleLink].contains(firstPerson)) { //see if first person wants to work with posLink
-                remainingLinks.remove(possibleLink);
-                Pair possiblePair (firstPerson, possibleLink);
-                if (hasPerfectMatching(remainingLinks, matching)) {
-                    matching += possiblePair;
-                    return true;
-                }
-            }
-        } return false;
+bool hasPerfectMatchingById(const CompactGraph& graph, vector<int>& mate, MatchingObstruction& why, SolverStats* stats) {
+    StatsTimer timer(stats, &SolverStats::secondsSolving);
+    PerfectMatchingPrecheck check = precheckPerfectMatching(graph);
+    why = check.obstruction;
+    if (!check.feasible()) {
+        mate.assign(graph.numPeople(), -1);
+        return false;
+    }
+
+    /* Forced pairs stay paired: augmenting paths never unpair anyone. Two-sided
+     * graphs don't need blossoms, so they get Hopcroft-Karp instead.
+     */
+    bool perfect;
+    vector<char> side;
+    if (findBipartition(graph, side)) {
+        HopcroftKarpMatching engine(graph, side);
+        engine.setStats(stats);
+        engine.setMates(check.forcedMate);
+        perfect = 2 * engine.maximumMatching() == int(graph.numPeople());
+        mate = engine.mates();
+    } else {
+        BlossomMatching engine(graph);
+        engine.setStats(stats);
+        engine.setMates(check.forcedMate);
+        perfect = engine.perfectMatching();
+        mate = engine.mates();
+    }
+
+    if (!perfect) {
+        /* The blossom search stops at the first person it can't pair, and has paired everyone before them.
+         * Hopcroft-Karp's matching is maximum, so whoever it leaves out can't all be paired either.
+         */
+        int unpaired = 0;
+        while (mate[unpaired] != -1) unpaired++;
+        why.kind = MatchingObstruction::kUnmatchable;
+        why.people = { unpaired };
+
+        mate.assign(graph.numPeople(), -1);
+        return false;
     }
+    return true;
+}
+
+bool hasPerfectMatchingById(const CompactGraph& graph, vector<int>& mate, SolverStats* stats) {
+    MatchingObstruction why;
+    return hasPerfectMatchingById(graph, mate, why, stats);
 }
 
 /*
- * This helper function takes in a set of pairs and a map of possibleLinks and returns
- * the total value of the pairs as a double.
- */
-double weight(Set<Pair> pairs, const Map<string, Map<string, int>>& possibleLinks) {
-    double result = 0;
-    for (const Pair& pair: pairs) {
-        result += possibleLinks[pair.first()][pair.second()];
+ * This function takes in a constant map, and a set of pairs and returns whether or not these pairs can be matched off perfectly.
+ * If they can, matching is set to one perfect matching; otherwise it is left empty. Each group of people with no links
+ * to anyone else is checked on its own (see ComponentMatching.h).
+ * */
+bool hasPerfectMatching(const Map<string, Set<string>>& possibleLinks, Set<Pair>& matching,
+                        Set<string>& offenders, SolverStats* stats) {
+    CompactGraph graph;
+    {
+        StatsTimer timer(stats, &SolverStats::secondsConverting);
+        graph = CompactGraph::fromLinks(possibleLinks);
+        MATCHING_STAT_INC(stats, mapConversions);
     }
-    return result;
+
+    vector<int> mate;
+    MatchingObstruction why;
+    bool perfect = hasPerfectMatchingByComponent(graph, mate, why, ComponentOptions(), stats);
+
+    StatsTimer timer(stats, &SolverStats::secondsConverting);
+    matching = graph.toPairs(mate);
+    MATCHING_STAT_INC(stats, mapConversions);
+    offenders.clear();
+    for (int person: why.people) {
+        offenders.add(string(graph.name(person)));
+    }
+    return perfect;
+}
+
+bool hasPerfectMatching(const Map<string, Set<string>>& possibleLinks, Set<Pair>& matching, SolverStats* stats) {
+    Set<string> offenders;
+    return hasPerfectMatching(possibleLinks, matching, offenders, stats);
 }
 
 /*
- * This recursive function takes in a map of possible links, a set of pairs so far, a vector of strings that have been looked
- * at and a set of pairs that have not been looked at. It returns the set of pairs that has the highest possible weight.
- */
-Set<Pair> maximumWeightMatchingRec(const Map<string, Map<string, int>>& possibleLinks, Set<Pair> pairsSoFar,
-                                   Vector<string> lookedAt, Set<string> notLookedAt) {
-    if (notLookedAt.isEmpty()) { //base case
-        return pairsSoFar;
-    } else {
-        Set<Pair> bestPairs = {}; //initialize bestPair values
-        int bestWeight = 0;
-        string firstName = notLookedAt.first();
-        lookedAt.add(firstName);
-        notLookedAt.remove(firstName);
-        Set<Pair> possibleSolution = (maximumWeightMatchingRec(possibleLinks, pairsSoFar, lookedAt, notLookedAt));
-        if (weight(possibleSolution, possibleLinks) > bestWeight) { //check to see if possibleSolution is bestSolution
-            bestPairs = possibleSolution;
-            bestWeight = weight(possibleSolution, possibleLinks);
-        }
+ * This function takes in a preference graph and returns the highest overall valued matching. People may be left
+ * unpaired, and a link with weight <= 0 is never used. Small groups are solved by memoized exhaustive search, which
+ * breaks ties the same way every time; larger two-sided ones by the Hungarian method (on a dense weight matrix if
+ * at least a third of possible pairs are linked), and the rest by the O(n^3) primal-dual blossom algorithm.
+ * */
+vector<int> maximumWeightMatchingById(const CompactGraph& graph, Arena& workspace, SolverStats* stats) {
+    StatsTimer timer(stats, &SolverStats::secondsSolving);
+    if (int(graph.numPeople()) <= kSmallGroupAutoLimit) {
+        SmallGroupMatching engine(graph, workspace);
+        engine.setStats(stats);
+        engine.solve();
+        return engine.mates();
+    }
 
-        for (const string& possibleCity: possibleLinks[firstName].keys()) { //now we check neighboring cities
-            if (notLookedAt.contains(possibleCity)) {
-                Pair possiblePair(firstName, possibleCity);
-                Set<Pair> restOfPairs = maximumWeightMatchingRec(possibleLinks,
-                      pairsSoFar + possiblePair, lookedAt + possibleCity, notLookedAt - possibleCity);
-                if (weight(restOfPairs, possibleLinks) > bestWeight) {
-                    bestPairs = restOfPairs;
-                    bestWeight = weight(restOfPairs, possibleLinks);
-                }
-            }
-        } return bestPairs;
+    vector<char> side;
+    if (findBipartition(graph, side)) {
+        if (preferDenseMatching(graph, side)) {
+            DenseMatching engine(graph, side, workspace);
+            engine.setStats(stats);
+            engine.solve();
+            return engine.mates();
+        }
+        BipartiteWeightedMatching engine(graph, side, workspace);
+        engine.setStats(stats);
+        engine.solve();
+        return engine.mates();
     }
+
+    WeightedBlossomMatching engine(graph, workspace);
+    engine.setStats(stats);
+    engine.solve();
+    return engine.mates();
+}
+
+vector<int> maximumWeightMatchingById(const CompactGraph& graph, SolverStats* stats) {
+    Arena workspace;
+    return maximumWeightMatchingById(graph, workspace, stats);
 }
 
 /*
- * This wrapper function takes in a map of possible Links and returns the highest overall valued set of pairs
+ * This wrapper function takes in a map of possible Links and returns the highest overall valued set of pairs. Like
+ * hasPerfectMatching, it solves each separate group of people on its own and puts the pairs together.
  * */
-Set<Pair> maximumWeightMatching(const Map<string, Map<string, int>>& possibleLinks) {
-    Set<string> notLookedAt = {};
-    for (const string& link: possibleLinks.keys()) {
-          notLookedAt.add(link);
+Set<Pair> maximumWeightMatching(const Map<string, Map<string, int>>& possibleLinks, SolverStats* stats) {
+    CompactGraph graph;
+    {
+        StatsTimer timer(stats, &SolverStats::secondsConverting);
+        graph = CompactGraph::fromWeightedLinks(possibleLinks);
+        MATCHING_STAT_INC(stats, mapConversions);
     }
-    return maximumWeightMatchingRec(possibleLinks, {}, {}, notLookedAt);
+
+    vector<int> mate = maximumWeightMatchingByComponent(graph, ComponentOptions(), stats);
+
+    StatsTimer timer(stats, &SolverStats::secondsConverting);
+    MATCHING_STAT_INC(stats, mapConversions);
+    return graph.toPairs(mate);
 }
 
 
@@ -187,6 +263,95 @@ STUDENT_TEST("hasPerfectMatching works on a septagon of people") {
     EXPECT(!hasPerfectMatching(links, unused));
 }
 
+STUDENT_TEST("hasPerfectMatching handles a millipede of 20,000 people quickly") {
+    /* Same shape as the positive stress test, but large enough that only a
+     * polynomial-time algorithm can finish.
+     */
+    const int kRowSize = 10000;
+
+    Vector<Pair> links;
+    for (int i = 0; i < kRowSize - 1; i++) {
+        links.add({ to_string(i), to_string(i + 1) });
+    }
+    for (int i = 0; i < kRowSize; i++) {
+        links.add({ to_string(i), to_string(i + kRowSize) });
+    }
+
+    Set<Pair> matching;
+    EXPECT(hasPerfectMatching(fromLinks(links), matching));
+    EXPECT(isPerfectMatching(fromLinks(links), matching));
+}
+
+STUDENT_TEST("hasPerfectMatching works on a strip of triangles") {
+    /* Triangles sharing edges, with a tail on each end:
+     *
+     *    T - A --- C --- E - U
+     *         \   / \   /
+     *          \ /   \ /
+     *           B --- D
+     *
+     * That's seven people, so there's no perfect matching. Giving U a
+     * partner V fixes that, but the search has to route through the odd
+     * cycles to find it.
+     */
+    auto links = fromLinks({
+        { "T", "A" },
+        { "A", "B" }, { "B", "C" }, { "C", "A" },
+        { "B", "D" },
+        { "C", "D" }, { "D", "E" }, { "E", "C" },
+        { "E", "U" }
+    });
+
+    Set<Pair> matching;
+    EXPECT(!hasPerfectMatching(links, matching));
+
+    links["V"].add("U");
+    links["U"].add("V");
+    EXPECT(hasPerfectMatching(links, matching));
+    EXPECT(isPerfectMatching(links, matching));
+}
+
+STUDENT_TEST("hasPerfectMatching names who is to blame when there is no perfect matching") {
+    /* The negative caterpillar again, at 30,000 people: the first two legs on
+     * the same body segment both need it, which the checks see without searching.
+     */
+    const int kRowSize = 10000;
+
+    Vector<Pair> pairs;
+    for (int i = 0; i < kRowSize - 1; i++) {
+        pairs.add({ to_string(i), to_string(i + 1) });
+    }
+    for (int i = 0; i < kRowSize; i++) {
+        pairs.add({ to_string(i), to_string(i + kRowSize) });
+        pairs.add({ to_string(i), to_string(i + 2 * kRowSize) });
+    }
+    auto links = fromLinks(pairs);
+
+    Set<Pair> matching;
+    Set<string> offenders;
+    EXPECT(!hasPerfectMatching(links, matching, offenders));
+    EXPECT(matching.isEmpty());
+    EXPECT_EQUAL(offenders.size(), 3);
+    for (const string& person: offenders) {
+        EXPECT(links.containsKey(person));
+    }
+
+    /* Three triangles hanging off one person: no one has a single option and
+     * everyone is connected, so only the search can tell.
+     */
+    links = fromLinks({
+        { "A1", "A2" }, { "A2", "A3" }, { "A3", "A1" },
+        { "B1", "B2" }, { "B2", "B3" }, { "B3", "B1" },
+        { "C1", "C2" }, { "C2", "C3" }, { "C3", "C1" },
+        { "X", "A1" }, { "X", "B1" }, { "X", "C1" },
+    });
+    EXPECT(!hasPerfectMatching(links, matching, offenders));
+    EXPECT_EQUAL(offenders.size(), 1);
+
+    EXPECT(hasPerfectMatching(fromLinks({ { "A", "B" } }), matching, offenders));
+    EXPECT(offenders.isEmpty());
+}
+
 STUDENT_TEST ("Returns empty pairs if everyone in group hates one another") {
 
     /* This world:
@@ -211,6 +376,43 @@ STUDENT_TEST ("Returns empty pairs if everyone in group hates one another") {
     EXPECT_EQUAL(maximumWeightMatching(links), {});
 }
 
+STUDENT_TEST("maximumWeightMatching gives up a heavy link for two lighter ones") {
+    /* This world:
+     *
+     *  A --- B --- C --- D
+     *     3     5     3
+     *
+     * B--C is the heaviest link, but A--B and C--D together are worth more.
+     */
+    auto links = fromWeightedLinks({
+        { "A", "B", 3 },
+        { "B", "C", 5 },
+        { "C", "D", 3 },
+    });
+
+    EXPECT_EQUAL(maximumWeightMatching(links), { {"A", "B"}, {"C", "D"} });
+}
+
+STUDENT_TEST("maximumWeightMatching counts a link only the alphabetically later person lists") {
+    /* Only Bo lists Ana. The original search never looked at this link. */
+    Map<string, Map<string, int>> links = {
+        { "Ana", {} },
+        { "Bo",  { { "Ana", 4 } } },
+    };
+    EXPECT_EQUAL(maximumWeightMatching(links), { { "Ana", "Bo" } });
+}
+
+STUDENT_TEST("maximumWeightMatching handles a chain of 2,001 people quickly") {
+    /* F(2001) possible matchings - far too many to enumerate. */
+    const int kNumPeople = 2001;
+    Vector<WeightedLink> links;
+    for (int i = 0; i < kNumPeople - 1; i++) {
+        links.add({ to_string(i), to_string(i + 1), 1 });
+    }
+
+    EXPECT_EQUAL(maximumWeightMatching(fromWeightedLinks(links)).size(), kNumPeople / 2);
+}
+
     PROVIDED_TEST("maximumWeightMatching: Works on a line of four people.") {
         /* This world:
          *
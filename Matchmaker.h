@@ -1,9 +1,15 @@
 #pragma once
 #include <string>
 #include <ostream>
+#include <vector>
 #include "map.h"
 #include "set.h"
 
+class Arena;
+class CompactGraph;
+struct MatchingObstruction;
+struct SolverStats;
+
 /* Unordered pair of strings. */
 class Pair {
 public:
@@ -58,7 +64,36 @@ private:
     std::string two_;
 };
 
-bool hasPerfectMatching(const Map<std::string, Set<std::string>>& possibleLinks, Set<Pair>& matching);
-Set<Pair> maximumWeightMatching(const Map<std::string, Map<std::string, int>>& possibleLinks);
+bool hasPerfectMatching(const Map<std::string, Set<std::string>>& possibleLinks, Set<Pair>& matching,
+                        SolverStats* stats = nullptr);
+
+/* Same, and if there is no perfect matching, offenders is set to the people who show it: someone
+ * with no links, an odd-sized group, or someone whose only options are taken by people with no
+ * other option. See PerfectMatchingPrecheck.h.
+ */
+bool hasPerfectMatching(const Map<std::string, Set<std::string>>& possibleLinks, Set<Pair>& matching,
+                        Set<std::string>& offenders, SolverStats* stats = nullptr);
+/* A link counts if either person lists the other, even if only one does; see
+ * CompactGraph::fromWeightedLinks.
+ */
+Set<Pair> maximumWeightMatching(const Map<std::string, Map<std::string, int>>& possibleLinks,
+                                SolverStats* stats = nullptr);
+
+/* Same as above, on a graph whose names have already been interned. Results are mate arrays:
+ * mate[v] is the id v is paired with, or -1. Use CompactGraph::toPairs to get names back.
+ */
+bool hasPerfectMatchingById(const CompactGraph& graph, std::vector<int>& mate, SolverStats* stats = nullptr);
+bool hasPerfectMatchingById(const CompactGraph& graph, std::vector<int>& mate, MatchingObstruction& why,
+                            SolverStats* stats = nullptr);
+std::vector<int> maximumWeightMatchingById(const CompactGraph& graph, SolverStats* stats = nullptr);
+
+/* Same again, with the solver's working memory carved out of workspace. Reset the arena
+ * between calls and reuse it, and solving a long run of graphs rarely touches the heap.
+ */
+std::vector<int> maximumWeightMatchingById(const CompactGraph& graph, Arena& workspace, SolverStats* stats = nullptr);
+
+/* Every function above takes an optional SolverStats, which the solver it picks counts into,
+ * along with the time spent converting names to ids and back. See SolverStats.h.
+ */
 
 std::ostream& operator<< (std::ostream& out, const Pair& pair);
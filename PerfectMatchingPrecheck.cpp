@@ -0,0 +1,197 @@
+/*
+ * Linear-time checks that can rule out a perfect matching. See PerfectMatchingPrecheck.h.
+ */
+
+#include "PerfectMatchingPrecheck.h"
+#include <algorithm>
+using namespace std;
+
+namespace {
+    /* Finds a connected group of odd size among the people not yet in a forced pair.
+     * Returns its members in id order, or nothing if every group is even.
+     */
+    vector<int> oddComponent(const CompactGraph& graph, const vector<int>& forcedMate) {
+        int n = int(graph.numPeople());
+        vector<char> seen(n, false);
+        vector<int> members;
+        for (int start = 0; start < n; start++) {
+            if (seen[start] || forcedMate[start] != -1) continue;
+
+            members.clear();
+            members.push_back(start);
+            seen[start] = true;
+            for (size_t head = 0; head < members.size(); head++) {
+                int v = members[head];
+                for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++) {
+                    if (!seen[*u] && forcedMate[*u] == -1) {
+                        seen[*u] = true;
+                        members.push_back(int(*u));
+                    }
+                }
+            }
+
+            if (members.size() % 2 != 0) {
+                sort(members.begin(), members.end());
+                return members;
+            }
+        }
+        return {};
+    }
+
+    string nameList(const CompactGraph& graph, const vector<int>& people) {
+        string result;
+        for (size_t i = 0; i < people.size(); i++) {
+            if (i > 0) result += ", ";
+            result += graph.name(people[i]);
+        }
+        return result;
+    }
+}
+
+PerfectMatchingPrecheck precheckPerfectMatching(const CompactGraph& graph) {
+    int n = int(graph.numPeople());
+    PerfectMatchingPrecheck result;
+    result.forcedMate.assign(n, -1);
+    vector<int>& forcedMate = result.forcedMate;
+    MatchingObstruction& why = result.obstruction;
+
+    for (int v = 0; v < n; v++) {
+        if (graph.degree(v) == 0) {
+            why.kind = MatchingObstruction::kIsolatedPerson;
+            why.people = { v };
+            return result;
+        }
+    }
+
+    /* Check the groups as given before forcing anything, since a whole group is an
+     * easier answer to act on than a chain of forced pairs.
+     */
+    why.people = oddComponent(graph, forcedMate);
+    if (!why.people.empty()) {
+        why.kind = MatchingObstruction::kOddComponent;
+        return result;
+    }
+
+    /* Someone with one possible partner left must pair with them. Doing so takes the
+     * partner away from everyone else, which may leave some of them with one option.
+     */
+    vector<uint32_t> optionsLeft(n);
+    vector<int> forced;
+    for (int v = 0; v < n; v++) {
+        optionsLeft[v] = graph.degree(v);
+        if (optionsLeft[v] == 1) forced.push_back(v);
+    }
+
+    while (!forced.empty()) {
+        int v = forced.back();
+        forced.pop_back();
+        if (forcedMate[v] != -1) continue;
+
+        if (optionsLeft[v] == 0) {
+            /* Everyone v could pair with is spoken for. */
+            why.kind = MatchingObstruction::kStranded;
+            why.people = { v };
+            for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++) {
+                why.people.push_back(int(*u));
+                why.people.push_back(forcedMate[*u]);
+            }
+            return result;
+        }
+
+        int partner = -1;
+        for (const uint32_t* u = graph.neighboursBegin(v); partner == -1; u++) {
+            if (forcedMate[*u] == -1) partner = int(*u);
+        }
+        forcedMate[v] = partner;
+        forcedMate[partner] = v;
+
+        /* v had no one else left, so only the partner's neighbours lose an option. */
+        for (const uint32_t* u = graph.neighboursBegin(partner); u != graph.neighboursEnd(partner); u++) {
+            if (forcedMate[*u] == -1 && --optionsLeft[*u] <= 1) {
+                forced.push_back(int(*u));
+            }
+        }
+    }
+
+    /* The forced pairs may have cut groups in two. */
+    why.people = oddComponent(graph, forcedMate);
+    if (!why.people.empty()) {
+        why.kind = MatchingObstruction::kOddComponent;
+    }
+    return result;
+}
+
+string MatchingObstruction::describe(const CompactGraph& graph) const {
+    switch (kind) {
+    case kNone:
+        return "No obstruction found.";
+    case kIsolatedPerson:
+        return string(graph.name(people[0])) + " has no one to pair with.";
+    case kOddComponent:
+        return nameList(graph, people) + " can only pair among themselves, and there are " +
+               to_string(people.size()) + " of them.";
+    case kStranded: {
+        string result = string(graph.name(people[0])) + " has no one left to pair with:";
+        for (size_t i = 1; i + 1 < people.size(); i += 2) {
+            result += string(i == 1 ? " " : ", ") + string(graph.name(people[i])) + " must pair with " +
+                      string(graph.name(people[i + 1]));
+        }
+        return result + ".";
+    }
+    case kUnmatchable:
+        return "No matching pairs everyone; the largest ones can leave out " + string(graph.name(people[0])) + ".";
+    }
+    return "";
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("precheckPerfectMatching finds isolated people and odd groups") {
+    CompactGraph graph = CompactGraph::fromLinks({
+        { "A", { "B" } }, { "B", { "A" } }, { "C", {} },
+    });
+    PerfectMatchingPrecheck check = precheckPerfectMatching(graph);
+    EXPECT_EQUAL(check.obstruction.kind, MatchingObstruction::kIsolatedPerson);
+    EXPECT(check.obstruction.people == vector<int>({ 2 }));
+
+    /* A pair and a triangle. */
+    graph = CompactGraph::fromLinks({
+        { "A", { "B" } }, { "B", {} }, { "C", { "D", "E" } }, { "D", { "E" } }, { "E", {} },
+    });
+    check = precheckPerfectMatching(graph);
+    EXPECT_EQUAL(check.obstruction.kind, MatchingObstruction::kOddComponent);
+    EXPECT(check.obstruction.people == vector<int>({ 2, 3, 4 }));
+    EXPECT_EQUAL(check.obstruction.describe(graph), "C, D, E can only pair among themselves, and there are 3 of them.");
+}
+
+STUDENT_TEST("precheckPerfectMatching forces pairs and catches people left stranded") {
+    /* F takes E, so D has to take A, and then B and C both need A too. */
+    CompactGraph graph = CompactGraph::fromLinks({
+        { "A", { "B", "C", "D" } }, { "B", {} }, { "C", {} }, { "D", { "E" } }, { "E", {} }, { "F", { "E" } },
+    });
+    PerfectMatchingPrecheck check = precheckPerfectMatching(graph);
+    EXPECT_EQUAL(check.obstruction.kind, MatchingObstruction::kStranded);
+    EXPECT_EQUAL(check.obstruction.people.size(), 3);
+    EXPECT_EQUAL(check.obstruction.people[1], 0);
+
+    /* A path pairs off from the ends inwards without any search. */
+    graph = CompactGraph::fromLinks({
+        { "A", { "B" } }, { "B", { "C" } }, { "C", { "D" } }, { "D", {} },
+    });
+    check = precheckPerfectMatching(graph);
+    EXPECT(check.feasible());
+    EXPECT(check.forcedMate == vector<int>({ 1, 0, 3, 2 }));
+
+    /* Two triangles joined through E, who has to take F: that splits them apart. */
+    graph = CompactGraph::fromLinks({
+        { "A", { "B", "C" } }, { "B", { "C" } }, { "C", { "E" } }, { "E", { "F", "G" } }, { "F", {} },
+        { "G", { "H", "I" } }, { "H", { "I" } }, { "I", {} },
+    });
+    check = precheckPerfectMatching(graph);
+    EXPECT_EQUAL(check.obstruction.kind, MatchingObstruction::kOddComponent);
+    EXPECT(check.obstruction.people == vector<int>({ 0, 1, 2 }));
+    EXPECT_EQUAL(check.forcedMate[3], 4);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "CompactGraph.h"
+
+/* Why a group has no perfect matching, when that can be shown cheaply. */
+struct MatchingObstruction {
+    enum Kind {
+        kNone,            // Nothing found; the group may or may not have a perfect matching.
+        kIsolatedPerson,  // people is one person with no links at all.
+        kOddComponent,    // people is an odd-sized group linked to no one outside it, except
+                          // perhaps people already in forced pairs.
+        kStranded,        // people[0] has no one left: everyone it links to is in a forced pair.
+                          // Then come those people, each followed by their forced partner.
+        kUnmatchable      // people[0] is left out by some maximum matching, as the full search showed.
+    };
+
+    Kind kind = kNone;
+    std::vector<int> people;
+
+    /* Names the people involved and says what is wrong with them, e.g. for an error message. */
+    std::string describe(const CompactGraph& graph) const;
+};
+
+/* What the linear-time checks learned before any search. */
+struct PerfectMatchingPrecheck {
+    /* Pairs that every perfect matching must contain, found by repeatedly pairing a
+     * person who has one possible partner left with that partner. forcedMate[v] is
+     * v's forced partner, or -1.
+     */
+    std::vector<int> forcedMate;
+
+    /* kNone unless the checks proved there is no perfect matching. */
+    MatchingObstruction obstruction;
+
+    bool feasible() const {
+        return obstruction.kind == MatchingObstruction::kNone;
+    }
+};
+
+/* Looks for the usual reasons a group can't be perfectly matched, in O(n + m):
+ * someone with no links, a connected group of odd size, and people whose only
+ * possible partners are all taken by people with no other option. What is left
+ * once the forced pairs are removed is split into groups again and each checked
+ * for parity. A feasible result doesn't mean a perfect matching exists, only that
+ * the search has to decide.
+ */
+PerfectMatchingPrecheck precheckPerfectMatching(const CompactGraph& graph);
@@ -0,0 +1,198 @@
+/*
+ * Streaming edge-list loader. See PreferenceLoader.h.
+ */
+
+#include "PreferenceLoader.h"
+#include <charconv>
+#include "MappedFile.h"
+#include "error.h"
+using namespace std;
+
+namespace {
+    bool isBlank(char ch) {
+        return ch == ' ' || ch == '\t';
+    }
+
+    string_view trim(string_view field) {
+        while (!field.empty() && isBlank(field.front())) field.remove_prefix(1);
+        while (!field.empty() && isBlank(field.back())) field.remove_suffix(1);
+        return field;
+    }
+
+    /* Splits a line into at most four fields, so that a line with too many is caught.
+     * Returns how many fields there were.
+     */
+    int splitFields(string_view line, EdgeListFormat format, string_view fields[4]) {
+        int count = 0;
+        if (format == EdgeListFormat::Csv) {
+            while (count < 4) {
+                size_t comma = line.find(',');
+                fields[count++] = trim(line.substr(0, comma));
+                if (comma == string_view::npos) break;
+                line.remove_prefix(comma + 1);
+            }
+        } else {
+            size_t pos = 0;
+            while (count < 4) {
+                while (pos < line.size() && isBlank(line[pos])) pos++;
+                if (pos == line.size()) break;
+                size_t start = pos;
+                while (pos < line.size() && !isBlank(line[pos])) pos++;
+                fields[count++] = line.substr(start, pos - start);
+            }
+        }
+        return count;
+    }
+
+    [[noreturn]] void badLine(size_t lineNumber, const string& why) {
+        error("Preferences, line " + to_string(lineNumber) + ": " + why);
+    }
+}
+
+CompactGraph parsePreferences(string_view text, EdgeListFormat format) {
+    if (format == EdgeListFormat::Detect) {
+        error("parsePreferences: can't detect the format of text without a file name");
+    }
+
+    CompactGraphBuilder builder;
+
+    /* Rough guess at the line count, so the link list doesn't keep regrowing. */
+    builder.reserveLinks(text.size() / 16);
+
+    /* Interning is bound by cache misses in the name table, so each parsed line waits in
+     * a small ring while the lookups of the lines after it are prefetched.
+     */
+    struct PendingLink {
+        string_view from, to;
+        uint64_t    fromHash, toHash;
+        int32_t     weight;
+    };
+    const size_t kLookahead = 16;
+    PendingLink pending[kLookahead];
+    size_t numParsed = 0;
+
+    auto intern = [&](const PendingLink& link) {
+        uint32_t from = builder.intern(link.from, link.fromHash);
+        uint32_t to = builder.intern(link.to, link.toHash);
+        builder.addLink(from, to, link.weight);
+    };
+
+    size_t lineNumber = 0;
+    bool firstLine = true;
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        string_view line = text.substr(0, newline);
+        text.remove_prefix(newline == string_view::npos ? text.size() : newline + 1);
+        lineNumber++;
+
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        string_view content = trim(line);
+        if (content.empty() || content.front() == '#') continue;
+
+        string_view fields[4];
+        int count = splitFields(content, format, fields);
+
+        if (firstLine && format == EdgeListFormat::Csv && fields[0] == "from" && count >= 2 && fields[1] == "to" &&
+            (count == 2 || (count == 3 && fields[2] == "weight"))) {
+            firstLine = false;
+            continue;
+        }
+        firstLine = false;
+
+        if (count < 2 || count > 3) {
+            badLine(lineNumber, "expected from, to and an optional weight");
+        }
+        if (fields[0].empty() || fields[1].empty()) {
+            badLine(lineNumber, "empty name");
+        }
+
+        int32_t weight = 1;
+        if (count == 3) {
+            const char* end = fields[2].data() + fields[2].size();
+            auto result = from_chars(fields[2].data(), end, weight);
+            if (result.ec != errc() || result.ptr != end) {
+                badLine(lineNumber, "weight \"" + string(fields[2]) + "\" isn't an integer");
+            }
+        }
+
+        PendingLink& slot = pending[numParsed % kLookahead];
+        if (numParsed >= kLookahead) intern(slot);
+        slot = { fields[0], fields[1], CompactGraphBuilder::hashName(fields[0]),
+                 CompactGraphBuilder::hashName(fields[1]), weight };
+        builder.prefetch(slot.fromHash);
+        builder.prefetch(slot.toHash);
+        numParsed++;
+    }
+
+    /* Drain the ring, oldest first, so people are still numbered in order of appearance. */
+    for (size_t i = numParsed > kLookahead ? numParsed - kLookahead : 0; i < numParsed; i++) {
+        intern(pending[i % kLookahead]);
+    }
+    return builder.build();
+}
+
+CompactGraph loadPreferenceFile(const string& path, EdgeListFormat format) {
+    if (format == EdgeListFormat::Detect) {
+        bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+        format = csv ? EdgeListFormat::Csv : EdgeListFormat::Whitespace;
+    }
+
+    MappedFile file(path);
+    return parsePreferences(file.text(), format);
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <cstdio>
+#include <fstream>
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("parsePreferences reads CSV with a header, comments and CRLF line endings") {
+    CompactGraph graph = parsePreferences(
+        "from,to,weight\r\n"
+        "# Weekly signups\r\n"
+        "Ann, Bob ,5\r\n"
+        "\r\n"
+        "Bob,Cat\r\n"
+        "Cat,Ann,-2",
+        EdgeListFormat::Csv);
+
+    EXPECT_EQUAL(graph.numPeople(), 3);
+    EXPECT_EQUAL(graph.numLinks(), 3);
+    EXPECT_EQUAL(graph.name(0), "Ann");
+    EXPECT_EQUAL(graph.name(1), "Bob");
+    EXPECT_EQUAL(graph.weight(0, 1), 5);
+    EXPECT_EQUAL(graph.weight(1, 2), 1);
+    EXPECT_EQUAL(graph.weight(2, 0), -2);
+}
+
+STUDENT_TEST("parsePreferences reads whitespace-separated edge lists") {
+    CompactGraph graph = parsePreferences("Ann\tBob 3\n  Bob   Cat\nDan Ann 4\n", EdgeListFormat::Whitespace);
+    EXPECT_EQUAL(graph.numPeople(), 4);
+    EXPECT_EQUAL(graph.weight(0, 1), 3);
+    EXPECT_EQUAL(graph.weight(1, 2), 1);
+    EXPECT_EQUAL(graph.weight(3, 0), 4);
+}
+
+STUDENT_TEST("parsePreferences reports malformed lines") {
+    EXPECT_ERROR(parsePreferences("Ann,Bob,lots\n", EdgeListFormat::Csv));
+    EXPECT_ERROR(parsePreferences("Ann,Bob,1,2\n", EdgeListFormat::Csv));
+    EXPECT_ERROR(parsePreferences("Ann\n", EdgeListFormat::Whitespace));
+    EXPECT_ERROR(parsePreferences("Ann,,3\n", EdgeListFormat::Csv));
+    EXPECT_ERROR(parsePreferences("Ann Bob", EdgeListFormat::Detect));
+}
+
+STUDENT_TEST("loadPreferenceFile maps a file and picks the format from its name") {
+    const string path = "preference-loader-test.csv";
+    {
+        ofstream out(path);
+        out << "from,to\nAnn,Bob\nBob,Cat\n";
+    }
+    CompactGraph graph = loadPreferenceFile(path);
+    remove(path.c_str());
+
+    EXPECT_EQUAL(graph.numPeople(), 3);
+    EXPECT_EQUAL(graph.numLinks(), 2);
+    EXPECT_ERROR(loadPreferenceFile("no-such-preference-file.txt"));
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "CompactGraph.h"
+
+/* Edge-list formats. Each line is one preference: `from` lists `to`, with an
+ * optional integer weight that defaults to 1.
+ *
+ *  - Csv:        from,to[,weight]   Spaces around fields are ignored. There is no
+ *                                   quoting, so names can't contain commas. A first
+ *                                   line of `from,to` or `from,to,weight` is taken
+ *                                   as a header and skipped.
+ *  - Whitespace: from to [weight]   Fields are separated by spaces or tabs.
+ *
+ * In both, blank lines and lines starting with # are skipped, and \r\n line
+ * endings are accepted.
+ */
+enum class EdgeListFormat {
+    Csv,
+    Whitespace,
+    Detect   // Csv if the file name ends in .csv, Whitespace otherwise. Files only.
+};
+
+/* Loads a preference dump straight into a CompactGraph.
+ *
+ * The file is memory-mapped and parsed in place: fields are string_views into the
+ * mapping, names are interned as they are first seen, and links go straight into
+ * a CompactGraphBuilder. Nothing passes through string-keyed maps, and no string
+ * is copied except the first time a name appears.
+ *
+ * People are numbered in order of first appearance. Links are undirected; if a
+ * pair is listed more than once, the rules of CompactGraphBuilder::addLink decide
+ * the weight. Malformed lines are reported with error(), giving the line number.
+ */
+CompactGraph loadPreferenceFile(const std::string& path, EdgeListFormat format = EdgeListFormat::Detect);
+
+/* Same, from text already in memory. format can't be Detect. */
+CompactGraph parsePreferences(std::string_view text, EdgeListFormat format);
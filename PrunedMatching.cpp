@@ -0,0 +1,183 @@
+/*
+ * Maximum-weight matching on a pruned graph, checked against the full one with LP
+ * duals. See PrunedMatching.h.
+ */
+
+#include "PrunedMatching.h"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include "ApproximateMatching.h"
+#include "Arena.h"
+#include "MatchingCertificate.h"
+#include "Matchmaker.h"
+#include "SmallGroupMatching.h"
+#include "error.h"
+using namespace std;
+
+namespace {
+    /* Each person's cut-off: the weight of their keep-th heaviest positive link, or 1
+     * (every positive link) if they have no more than keep of them.
+     */
+    vector<int32_t> keepThresholds(const CompactGraph& graph, int keep) {
+        vector<int32_t> threshold(graph.numPeople(), 1);
+        vector<int32_t> positive;
+        for (uint32_t v = 0; v < graph.numPeople(); v++) {
+            positive.clear();
+            for (const int32_t* w = graph.weightsBegin(v); w != graph.weightsBegin(v) + graph.degree(v); w++) {
+                if (*w > 0) positive.push_back(*w);
+            }
+            if (int(positive.size()) > keep) {
+                nth_element(positive.begin(), positive.begin() + (keep - 1), positive.end(), greater<int32_t>());
+                threshold[v] = positive[keep - 1];
+            }
+        }
+        return threshold;
+    }
+
+    /* The link arrays of a pruned graph. Names are shared with the original, which is
+     * kept alive alongside.
+     */
+    struct PrunedArrays {
+        CompactGraph     original;
+        vector<uint64_t> offsets;
+        vector<uint32_t> targets;
+        vector<int32_t>  weights;
+    };
+
+    /* The positive links that either end keeps, and the greedy matching's. */
+    CompactGraph pruneGraph(const CompactGraph& graph, const vector<int32_t>& threshold, const vector<int>& greedy) {
+        auto pruned = make_shared<PrunedArrays>();
+        pruned->original = graph;
+        pruned->offsets.assign(graph.numPeople() + 1, 0);
+        for (uint32_t v = 0; v < graph.numPeople(); v++) {
+            const int32_t* weight = graph.weightsBegin(v);
+            for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++, weight++) {
+                if (*weight > 0 && (*weight >= threshold[v] || *weight >= threshold[*u] || greedy[v] == int(*u))) {
+                    pruned->targets.push_back(*u);
+                    pruned->weights.push_back(*weight);
+                }
+            }
+            pruned->offsets[v + 1] = pruned->targets.size();
+        }
+
+        CompactGraph::Arrays arrays = graph.arrays();
+        arrays.numLinks = pruned->targets.size() / 2;
+        arrays.offsets = pruned->offsets.data();
+        arrays.targets = pruned->targets.data();
+        arrays.weights = pruned->weights.data();
+        return CompactGraph::fromArrays(arrays, pruned);
+    }
+}
+
+PruningResult prunedMaximumWeightMatchingById(const CompactGraph& graph, const PruningOptions& options,
+                                              SolverStats* stats) {
+    if (options.keepPerPerson < 1) error("prunedMaximumWeightMatching: keepPerPerson must be at least 1");
+
+    PruningResult result;
+    result.linksTotal = graph.numLinks();
+    Arena workspace;
+    if (int(graph.numPeople()) <= kSmallGroupAutoLimit) {
+        result.linksKept = result.linksTotal;
+        result.mates = maximumWeightMatchingById(graph, workspace, stats);
+    } else {
+        ApproximateOptions greedyOnly;
+        greedyOnly.maxRounds = 0;
+        vector<int> greedy = approximateMaximumWeightMatchingById(graph, greedyOnly).mates;
+        CompactGraph pruned = pruneGraph(graph, keepThresholds(graph, options.keepPerPerson), greedy);
+        result.linksKept = pruned.numLinks();
+
+        MatchingCertificate certificate;
+        result.mates = maximumWeightMatchingWithCertificate(pruned, certificate, workspace, stats);
+        if (!checkMatchingCertificate(graph, result.mates, certificate).ok()) {
+            result.fellBack = true;
+            workspace.reset();
+            result.mates = maximumWeightMatchingById(graph, workspace, stats);
+        }
+    }
+
+    for (uint32_t v = 0; v < graph.numPeople(); v++) {
+        if (result.mates[v] > int(v)) result.weight += graph.weight(v, result.mates[v]);
+    }
+    return result;
+}
+
+Set<Pair> prunedMaximumWeightMatching(const Map<string, Map<string, int>>& possibleLinks,
+                                      const PruningOptions& options, PruningResult* result) {
+    CompactGraph graph = CompactGraph::fromWeightedLinks(possibleLinks);
+    PruningResult found = prunedMaximumWeightMatchingById(graph, options);
+    Set<Pair> pairs = graph.toPairs(found.mates);
+    if (result != nullptr) *result = move(found);
+    return pairs;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "MatchingScore.h"
+#include "TestGraphs.h"
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("Pruned matchings weigh as much as full ones, certified or not") {
+    mt19937 generator(88);
+    int certified = 0;
+    for (int trial = 0; trial < 30; trial++) {
+        CompactGraph graph = randomGraph(generator, 21 + int(generator() % 40), 1 + int(generator() % 3),
+                                         -2, int(generator() % 40) - 1);
+        PruningOptions options;
+        options.keepPerPerson = 1 + int(generator() % 4);
+        PruningResult result = prunedMaximumWeightMatchingById(graph, options);
+
+        MatchingScore best(graph);
+        best.assign(maximumWeightMatchingById(graph));
+        MatchingScore found(graph);
+        found.assign(result.mates);
+        EXPECT_EQUAL(result.weight, best.total());
+        EXPECT_EQUAL(result.weight, found.total());
+        EXPECT(result.linksKept <= result.linksTotal);
+        if (!result.fellBack) certified++;
+    }
+    EXPECT(certified > 0);
+}
+
+STUDENT_TEST("Dense graphs keep only a few links per person and still pass the check") {
+    mt19937 generator(3);
+    CompactGraph graph = randomGraph(generator, 200, 1, -2, 997);
+    PruningResult result = prunedMaximumWeightMatchingById(graph);
+    EXPECT(!result.fellBack);
+    EXPECT(result.linksKept * 5 < result.linksTotal);
+    MatchingScore best(graph);
+    best.assign(maximumWeightMatchingById(graph));
+    EXPECT_EQUAL(result.weight, best.total());
+}
+
+STUDENT_TEST("A link nobody kept that the best matching needs makes it fall back") {
+    /* Ana, Bo and Cy each rate Hub 10, Ana and Bo rate each other 9, and Cy has no one
+     * else. Keeping one link each drops Ana -- Bo, and the greedy matching pairs Ana
+     * with Hub, so the pruned graph's best is 10 against the full graph's 19. Twenty
+     * more people in pairs push the group past the size solved outright.
+     */
+    Map<string, Map<string, int>> links = {
+        { "Ana", { { "Hub", 10 }, { "Bo", 9 } } },
+        { "Bo",  { { "Hub", 10 }, { "Ana", 9 } } },
+        { "Cy",  { { "Hub", 10 } } },
+        { "Hub", { { "Ana", 10 }, { "Bo", 10 }, { "Cy", 10 } } },
+    };
+    for (int i = 0; i < 10; i++) {
+        links["X" + to_string(i)]["Y" + to_string(i)] = 1;
+        links["Y" + to_string(i)]["X" + to_string(i)] = 1;
+    }
+
+    PruningOptions options;
+    options.keepPerPerson = 1;
+    PruningResult result;
+    Set<Pair> matching = prunedMaximumWeightMatching(links, options, &result);
+    EXPECT(result.fellBack);
+    EXPECT_EQUAL(result.weight, 29);
+    EXPECT(matching.contains({ "Ana", "Bo" }));
+    EXPECT(matching.contains({ "Cy", "Hub" }));
+
+    options.keepPerPerson = 0;
+    EXPECT_ERROR(prunedMaximumWeightMatching(links, options));
+}
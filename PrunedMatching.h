@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CompactGraph.h"
+#include "SolverStats.h"
+#include "map.h"
+#include "set.h"
+
+struct PruningOptions {
+    /* Links kept per person: their heaviest keepPerPerson, and any tied with the last
+     * of those. A link stays if either end keeps it.
+     */
+    int keepPerPerson = 8;
+};
+
+struct PruningResult {
+    std::vector<int> mates;
+    long long weight = 0;
+    uint64_t  linksKept = 0;
+    uint64_t  linksTotal = 0;
+    /* Whether the duals from the pruned graph failed to cover some pruned link, so the
+     * whole graph had to be solved after all.
+     */
+    bool      fellBack = false;
+};
+
+/* maximumWeightMatchingById, solved on a pruned copy of the graph where it can be.
+ *
+ * Dense preference graphs are full of links too light to ever be used. This keeps
+ * each person's heaviest few links, plus the pairs of a greedy matching so that the
+ * pruned graph always has at least that good a matching in it, and solves that
+ * instead. The answer is then checked against every link of the full graph using
+ * the LP duals the solver found: if every pruned link u -- v has
+ *
+ *     dual(u) + dual(v) + (duals of blossoms containing both) >= weight(u, v),
+ *
+ * the duals prove the pruned graph's matching is the heaviest in the full graph
+ * too. If some link isn't covered, the full graph is solved as usual and fellBack
+ * is set. Either way the result is exact.
+ *
+ * The check is checkMatchingCertificate (see MatchingCertificate.h), one pass over
+ * the links. Reports an error if keepPerPerson < 1.
+ */
+PruningResult prunedMaximumWeightMatchingById(const CompactGraph& graph,
+                                              const PruningOptions& options = PruningOptions(),
+                                              SolverStats* stats = nullptr);
+
+/* Convenience wrapper for callers holding a preference map. If result is given, it
+ * receives the details, including how many links were pruned.
+ */
+Set<Pair> prunedMaximumWeightMatching(const Map<std::string, Map<std::string, int>>& possibleLinks,
+                                      const PruningOptions& options = PruningOptions(),
+                                      PruningResult* result = nullptr);
@@ -0,0 +1,255 @@
+/*
+ * Memoized exhaustive search for maximum-weight matchings in small groups. See SmallGroupMatching.h.
+ */
+
+#include "SmallGroupMatching.h"
+#include "error.h"
+using namespace std;
+
+namespace {
+    int lowestBit(uint64_t mask) {
+        return __builtin_ctzll(mask);
+    }
+    uint64_t bit(int v) {
+        return uint64_t(1) << v;
+    }
+
+    /* Initial memo size. Small groups can't reach this many unpaired sets at all. */
+    const size_t kInitialMemoSlots = 1 << 12;
+
+    size_t initialMemoSlots(int numPeople) {
+        return numPeople >= 11 ? kInitialMemoSlots : max<size_t>(16, size_t(2) << numPeople);
+    }
+
+    int checkedSize(const CompactGraph& graph) {
+        int numPeople = int(graph.numPeople());
+        if (numPeople > SmallGroupMatching::kMaxPeople) {
+            error("SmallGroupMatching supports at most " + to_string(SmallGroupMatching::kMaxPeople) +
+                  " people, got " + to_string(numPeople));
+        }
+        return numPeople;
+    }
+}
+
+SmallGroupMatching::SmallGroupMatching(const CompactGraph& graph, Arena& arena)
+    : arena_(arena),
+      n_(checkedSize(graph)),
+      linked_(arena, n_, 0),
+      weights_(arena, size_t(n_) * n_, 0),
+      heaviest_(arena, n_, 0),
+      memoKeys_(arena, initialMemoSlots(n_), 0),
+      memoChoices_(arena, initialMemoSlots(n_)),
+      result_(graph) {
+
+    for (int v = 0; v < n_; v++) {
+        const int32_t* w = graph.weightsBegin(v);
+        for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++, w++) {
+            if (*w <= 0) continue;  // Never worth using.
+            linked_[v] |= bit(*u);
+            weights_[size_t(v) * n_ + *u] = *w;
+            heaviest_[v] = max(heaviest_[v], (long long) *w);
+        }
+    }
+}
+
+SmallGroupMatching::SmallGroupMatching(const CompactGraph& graph)
+    : SmallGroupMatching(graph, ownArena_) {
+}
+
+size_t SmallGroupMatching::slotFor(uint64_t unpaired) const {
+    /* Fibonacci hashing, then linear probing. */
+    size_t mask = memoKeys_.size() - 1;
+    size_t slot = size_t((unpaired * 0x9E3779B97F4A7C15ull) >> 20) & mask;
+    while (memoKeys_[slot] != 0 && memoKeys_[slot] != unpaired) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+const SmallGroupMatching::Choice* SmallGroupMatching::findChoice(uint64_t unpaired) const {
+    size_t slot = slotFor(unpaired);
+    return memoKeys_[slot] == 0 ? nullptr : &memoChoices_[slot];
+}
+
+void SmallGroupMatching::storeChoice(uint64_t unpaired, const Choice& choice) {
+    if (2 * (memoSize_ + 1) > memoKeys_.size()) {
+        /* Over half full: move everything to a table twice the size. */
+        ArenaArray<uint64_t> oldKeys = memoKeys_;
+        ArenaArray<Choice> oldChoices = memoChoices_;
+        memoKeys_ = ArenaArray<uint64_t>(arena_, 2 * oldKeys.size(), 0);
+        memoChoices_ = ArenaArray<Choice>(arena_, 2 * oldKeys.size());
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (oldKeys[i] != 0) {
+                size_t slot = slotFor(oldKeys[i]);
+                memoKeys_[slot] = oldKeys[i];
+                memoChoices_[slot] = oldChoices[i];
+            }
+        }
+    }
+
+    size_t slot = slotFor(unpaired);
+    if (memoKeys_[slot] == 0) memoSize_++;
+    memoKeys_[slot] = unpaired;
+    memoChoices_[slot] = choice;
+}
+
+long long SmallGroupMatching::bound(uint64_t unpaired) const {
+    /* Each pair (u, v) is worth at most (heaviest[u] + heaviest[v]) / 2. */
+    long long total = 0;
+    for (; unpaired != 0; unpaired &= unpaired - 1) {
+        total += heaviest_[lowestBit(unpaired)];
+    }
+    return total / 2;
+}
+
+long long SmallGroupMatching::best(uint64_t unpaired) {
+    if (unpaired == 0) return 0;
+
+    const Choice* found = findChoice(unpaired);
+    if (found != nullptr) {
+        MATCHING_STAT_INC(stats_, memoHits);
+        return found->weight;
+    }
+    MATCHING_STAT_INC(stats_, nodesExpanded);
+
+    int v = lowestBit(unpaired);
+    uint64_t rest = unpaired & ~bit(v);
+
+    /* Option 1: leave v out. */
+    Choice choice = { best(rest), -1 };
+
+    /* Option 2: pair v with someone. The running total for each option is just the
+     * link's weight plus the (memoized) best for whoever is left.
+     */
+    for (uint64_t partners = linked_[v] & rest; partners != 0; partners &= partners - 1) {
+        int u = lowestBit(partners);
+        long long weight = weights_[size_t(v) * n_ + u];
+        uint64_t remaining = rest & ~bit(u);
+
+        if (weight + bound(remaining) <= choice.weight) {
+            MATCHING_STAT_INC(stats_, prunes);
+            continue;
+        }
+
+        long long total = weight + best(remaining);
+        if (total > choice.weight) {
+            choice = { total, u };
+        }
+    }
+
+    storeChoice(unpaired, choice);
+    return choice.weight;
+}
+
+long long SmallGroupMatching::solve() {
+    memoKeys_.fill(0);
+    memoSize_ = 0;
+    result_.clear();
+
+    uint64_t everyone = n_ == kMaxPeople ? ~uint64_t(0) : bit(n_) - 1;
+    best(everyone);
+    MATCHING_STAT_MAX(stats_, peakWorkspaceBytes, arena_.peakBytes());
+
+    /* Walk the memoized choices to recover the matching itself. */
+    uint64_t unpaired = everyone;
+    while (unpaired != 0) {
+        int v = lowestBit(unpaired);
+        unpaired &= ~bit(v);
+
+        const Choice* found = findChoice(unpaired | bit(v));
+        int u = found == nullptr ? -1 : found->partner;
+        if (u != -1) {
+            result_.add(v, u);
+            unpaired &= ~bit(u);
+        }
+    }
+    return result_.total();
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "WeightedBlossomMatching.h"
+#include <random>
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("SmallGroupMatching agrees with the blossom solver on random groups") {
+    mt19937 generator(106);
+    for (int trial = 0; trial < 300; trial++) {
+        int numPeople = int(generator() % 14) + 1;
+        Map<string, Map<string, int>> links;
+        for (int i = 0; i < numPeople; i++) {
+            links[to_string(i)];
+            for (int j = i + 1; j < numPeople; j++) {
+                if (generator() % 3 == 0) {
+                    int weight = int(generator() % 20) - 5;
+                    links[to_string(i)][to_string(j)] = weight;
+                    links[to_string(j)][to_string(i)] = weight;
+                }
+            }
+        }
+
+        CompactGraph graph = CompactGraph::fromWeightedLinks(links);
+        SmallGroupMatching exhaustive(graph);
+        WeightedBlossomMatching blossom(graph);
+        EXPECT_EQUAL(exhaustive.solve(), blossom.solve());
+    }
+}
+
+STUDENT_TEST("SmallGroupMatching breaks ties by preferring earlier names") {
+    /* Every link in this square is worth 1, so AB/CD and AD/BC tie. */
+    CompactGraph graph = CompactGraph::fromWeightedLinks({
+        { "A", { { "B", 1 }, { "D", 1 } } },
+        { "B", { { "A", 1 }, { "C", 1 } } },
+        { "C", { { "B", 1 }, { "D", 1 } } },
+        { "D", { { "C", 1 }, { "A", 1 } } },
+    });
+
+    SmallGroupMatching solver(graph);
+    EXPECT_EQUAL(solver.solve(), 2);
+    EXPECT_EQUAL(graph.toPairs(solver.mates()), { { "A", "B" }, { "C", "D" } });
+}
+
+STUDENT_TEST("SmallGroupMatching handles a full 64-person chain") {
+    /* A chain has F(64) matchings, but only a few hundred distinct unpaired sets
+     * are reachable when the lowest person is always decided first.
+     */
+    CompactGraphBuilder builder;
+    for (int i = 0; i < SmallGroupMatching::kMaxPeople; i++) {
+        builder.intern(to_string(1000 + i));
+    }
+    for (int i = 0; i + 1 < SmallGroupMatching::kMaxPeople; i++) {
+        builder.addLink(i, i + 1, 1 + i % 3);
+    }
+    CompactGraph graph = builder.build();
+
+    SmallGroupMatching exhaustive(graph);
+    WeightedBlossomMatching blossom(graph);
+    EXPECT_EQUAL(exhaustive.solve(), blossom.solve());
+}
+
+STUDENT_TEST("SmallGroupMatching doesn't grow its arena while solving") {
+    CompactGraphBuilder builder;
+    for (int i = 0; i < SmallGroupMatching::kMaxPeople; i++) {
+        builder.intern(to_string(i));
+    }
+    for (int i = 0; i + 1 < SmallGroupMatching::kMaxPeople; i++) {
+        builder.addLink(i, i + 1, 1);
+    }
+    CompactGraph graph = builder.build();
+
+    Arena arena;
+    SmallGroupMatching solver(graph, arena);
+    size_t afterSetup = arena.heapAllocations();
+    EXPECT_EQUAL(solver.solve(), SmallGroupMatching::kMaxPeople / 2);
+    EXPECT_EQUAL(arena.heapAllocations(), afterSetup);
+}
+
+STUDENT_TEST("SmallGroupMatching rejects groups that don't fit in a mask") {
+    CompactGraphBuilder builder;
+    for (int i = 0; i <= SmallGroupMatching::kMaxPeople; i++) {
+        builder.intern(to_string(i));
+    }
+    CompactGraph graph = builder.build();
+    EXPECT_ERROR(SmallGroupMatching{graph});
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Arena.h"
+#include "CompactGraph.h"
+#include "MatchingScore.h"
+#include "SolverStats.h"
+
+/* Exact maximum-weight matching for groups of at most 64 people, by exhaustive
+ * search over which people are still unpaired.
+ *
+ * The unpaired set is a single uint64_t mask, and the best weight for each mask
+ * is memoized, so a subset of people that can be reached along several branches
+ * is only solved once. Branches whose optimistic bound can't beat the best option
+ * found so far are cut off.
+ *
+ * The memo is an open-addressing table in an Arena, sized when the solver is set
+ * up. It only goes back to the arena for more room if the search reaches more
+ * distinct unpaired sets than expected.
+ *
+ * Ties are broken the same way every time: people are considered in id order, the
+ * lowest unpaired person is first left out, then paired with each possible partner
+ * in id order, and a later option only replaces an earlier one if it is strictly
+ * better.
+ */
+class SmallGroupMatching {
+public:
+    /* Largest group the mask can represent. */
+    static const int kMaxPeople = 64;
+
+    /* Reports an error if the graph has more than kMaxPeople people. The arena
+     * must outlive the solver.
+     */
+    SmallGroupMatching(const CompactGraph& graph, Arena& arena);
+    explicit SmallGroupMatching(const CompactGraph& graph);
+
+    /* Runs the search. Returns the total weight of the matching. */
+    long long solve();
+
+    /* Counts what the search does into stats from now on (see SolverStats.h).
+     * Pass nullptr to stop.
+     */
+    void setStats(SolverStats* stats) {
+        stats_ = stats;
+    }
+
+    std::vector<int> mates() const {
+        return result_.mates();
+    }
+
+private:
+    struct Choice {
+        long long weight;
+        int partner;  // Who the lowest person in the mask is paired with, or -1.
+    };
+
+    long long best(uint64_t unpaired);
+
+    /* Memo lookups. An empty unpaired set is never stored, so key 0 marks a free slot. */
+    const Choice* findChoice(uint64_t unpaired) const;
+    void storeChoice(uint64_t unpaired, const Choice& choice);
+    size_t slotFor(uint64_t unpaired) const;
+
+    /* Upper bound on the weight of any matching among the people in the mask. */
+    long long bound(uint64_t unpaired) const;
+
+    Arena                 ownArena_;
+    Arena&                arena_;
+    SolverStats*          stats_ = nullptr;
+    int                   n_;
+    ArenaArray<uint64_t>  linked_;     // Positive-weight neighbours of each person, as a mask.
+    ArenaArray<long long> weights_;    // Dense n x n weight table.
+    ArenaArray<long long> heaviest_;   // Each person's heaviest positive link.
+    ArenaArray<uint64_t>  memoKeys_;
+    ArenaArray<Choice>    memoChoices_;
+    size_t                memoSize_ = 0;
+    MatchingScore         result_;
+};
+
+/* maximumWeightMatchingById uses SmallGroupMatching for groups up to this size.
+ * The memo can grow exponentially with the group size on dense graphs, so this is
+ * well below kMaxPeople.
+ */
+const int kSmallGroupAutoLimit = 20;
@@ -0,0 +1,90 @@
+/*
+ * Solver statistics. See SolverStats.h.
+ */
+
+#include "SolverStats.h"
+#include <algorithm>
+using namespace std;
+
+void SolverStats::merge(const SolverStats& other) {
+    nodesExpanded += other.nodesExpanded;
+    prunes += other.prunes;
+    memoHits += other.memoHits;
+    augmentations += other.augmentations;
+    blossomsShrunk += other.blossomsShrunk;
+    blossomsExpanded += other.blossomsExpanded;
+    stages += other.stages;
+    dualAdjustments += other.dualAdjustments;
+    mapConversions += other.mapConversions;
+    secondsConverting += other.secondsConverting;
+    secondsSolving += other.secondsSolving;
+    peakWorkspaceBytes = max(peakWorkspaceBytes, other.peakWorkspaceBytes);
+}
+
+vector<pair<string, double>> SolverStats::entries() const {
+    return {
+        { "nodes_expanded",       double(nodesExpanded) },
+        { "prunes",               double(prunes) },
+        { "memo_hits",            double(memoHits) },
+        { "augmentations",        double(augmentations) },
+        { "blossoms_shrunk",      double(blossomsShrunk) },
+        { "blossoms_expanded",    double(blossomsExpanded) },
+        { "stages",               double(stages) },
+        { "dual_adjustments",     double(dualAdjustments) },
+        { "map_conversions",      double(mapConversions) },
+        { "seconds_converting",   secondsConverting },
+        { "seconds_solving",      secondsSolving },
+        { "peak_workspace_bytes", double(peakWorkspaceBytes) },
+    };
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "Matchmaker.h"
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("SolverStats counts what the solvers do, or stays zeroed when compiled out") {
+    /* An odd ring with a chord, every link weighing the same: too big for the
+     * small-group solver and not two-sided, so it goes to the weighted blossom solver,
+     * which has to shrink odd cycles to prove one person must go unpaired.
+     */
+    Map<string, Map<string, int>> links;
+    for (int i = 0; i < 31; i++) {
+        string me = to_string(i), next = to_string((i + 1) % 31);
+        links[me][next] = links[next][me] = 2;
+    }
+    links["0"]["15"] = links["15"]["0"] = 2;
+
+    SolverStats stats;
+    Set<Pair> matching = maximumWeightMatching(links, &stats);
+    EXPECT_EQUAL(matching, maximumWeightMatching(links));
+
+    Set<Pair> perfect;
+    Map<string, Set<string>> square = {
+        { "A", { "B", "D" } }, { "B", { "A", "C" } }, { "C", { "B", "D" } }, { "D", { "A", "C" } }
+    };
+    EXPECT(hasPerfectMatching(square, perfect, &stats));
+
+    if (SolverStats::kEnabled) {
+        EXPECT_EQUAL(stats.mapConversions, 4);
+        EXPECT(stats.nodesExpanded > 0);
+        EXPECT(stats.augmentations > 0);
+        EXPECT(stats.stages > 0);
+        EXPECT(stats.dualAdjustments > 0);
+        EXPECT(stats.blossomsShrunk > 0);
+        EXPECT(stats.peakWorkspaceBytes > 0);
+        EXPECT(stats.secondsSolving > 0);
+    } else {
+        for (const auto& entry: stats.entries()) {
+            EXPECT_EQUAL(entry.second, 0);
+        }
+    }
+
+    SolverStats total;
+    total.merge(stats);
+    total.merge(stats);
+    EXPECT_EQUAL(total.nodesExpanded, 2 * stats.nodesExpanded);
+    EXPECT_EQUAL(total.peakWorkspaceBytes, stats.peakWorkspaceBytes);
+    EXPECT_EQUAL(total.entries().size(), stats.entries().size());
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Define MATCHING_STATS as 1 when compiling to have the solvers count what they
+ * do. Left at 0, every counting statement below compiles to nothing, so solvers
+ * handed a SolverStats pay nothing and just leave it zeroed.
+ */
+#ifndef MATCHING_STATS
+#define MATCHING_STATS 0
+#endif
+
+/* What a solver did while it ran. Pass one to a solver's setStats(), or to the
+ * functions in Matchmaker.h, and it is added to (not reset), so one object can
+ * gather the totals over many calls. Counters a solver has no use for stay at 0.
+ */
+struct SolverStats {
+    static constexpr bool kEnabled = MATCHING_STATS != 0;
+
+    uint64_t nodesExpanded = 0;      // Search nodes: tree vertices in the blossom solvers,
+                                     // subproblems in the exhaustive ones.
+    uint64_t prunes = 0;             // Branches cut off by a bound.
+    uint64_t memoHits = 0;           // Subproblems answered from a memo.
+    uint64_t augmentations = 0;      // Augmenting paths flipped.
+    uint64_t blossomsShrunk = 0;
+    uint64_t blossomsExpanded = 0;
+    uint64_t stages = 0;             // Stages of the weighted blossom algorithm.
+    uint64_t dualAdjustments = 0;    // Dual variable updates, likewise.
+    uint64_t mapConversions = 0;     // Preference maps turned into graphs, and back into pairs.
+    double   secondsConverting = 0;
+    double   secondsSolving = 0;
+    size_t   peakWorkspaceBytes = 0; // Largest solver workspace (arena) seen.
+
+    /* Adds other's counts to these. */
+    void merge(const SolverStats& other);
+
+    /* Every counter as a (snake_case name, value) pair, for exporting as metrics. */
+    std::vector<std::pair<std::string, double>> entries() const;
+};
+
+#if MATCHING_STATS
+#define MATCHING_STAT_ADD(stats, field, amount) do { if (stats) (stats)->field += (amount); } while (0)
+#define MATCHING_STAT_MAX(stats, field, value) \
+    do { if ((stats) && (stats)->field < (value)) (stats)->field = (value); } while (0)
+#else
+#define MATCHING_STAT_ADD(stats, field, amount) do { } while (0)
+#define MATCHING_STAT_MAX(stats, field, value) do { } while (0)
+#endif
+#define MATCHING_STAT_INC(stats, field) MATCHING_STAT_ADD(stats, field, 1)
+
+/* Adds the time until it goes out of scope to one of the seconds fields of stats. */
+class StatsTimer {
+public:
+#if MATCHING_STATS
+    StatsTimer(SolverStats* stats, double SolverStats::* seconds)
+        : stats_(stats), seconds_(seconds), start_(std::chrono::steady_clock::now()) {
+    }
+    ~StatsTimer() {
+        if (stats_ != nullptr) {
+            stats_->*seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        }
+    }
+#else
+    StatsTimer(SolverStats*, double SolverStats::*) {
+    }
+#endif
+
+    StatsTimer(const StatsTimer&) = delete;
+    StatsTimer& operator= (const StatsTimer&) = delete;
+
+#if MATCHING_STATS
+private:
+    SolverStats*                          stats_;
+    double SolverStats::*                 seconds_;
+    std::chrono::steady_clock::time_point start_;
+#endif
+};
@@ -0,0 +1,596 @@
+/*
+ * Splitting people into teams of k. See TeamPartitioning.h.
+ */
+
+#include "TeamPartitioning.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <thread>
+#include "error.h"
+using namespace std;
+
+namespace {
+    /* ceil(n / teamSize) teams, as even as possible. The first numBig teams have
+     * base + 1 people and the rest have base.
+     */
+    struct TeamSizes {
+        int numTeams = 0;
+        int base = 0;
+        int numBig = 0;
+
+        TeamSizes(int numPeople, int teamSize) {
+            numTeams = (numPeople + teamSize - 1) / teamSize;
+            if (numTeams == 0) return;
+            base = numPeople / numTeams;
+            numBig = numPeople % numTeams;
+        }
+        int of(int team) const {
+            return team < numBig ? base + 1 : base;
+        }
+        int largest() const {
+            return numBig > 0 ? base + 1 : base;
+        }
+    };
+
+    /* Who is in which team, in flat arrays. Each team's members sit in a row of
+     * fixed width, so a team is one short run of memory, and each person knows
+     * their team and their slot in its row, so people swap places in O(1).
+     */
+    class Teams {
+    public:
+        Teams(const CompactGraph& graph, const TeamSizes& sizes)
+            : graph_(graph), width_(sizes.largest()),
+              teamOf_(graph.numPeople()), slot_(graph.numPeople()),
+              members_(size_t(sizes.numTeams) * width_), size_(sizes.numTeams, 0) {
+        }
+
+        void assign(const vector<int>& teamOf) {
+            fill(size_.begin(), size_.end(), 0);
+            weight_ = 0;
+            for (uint32_t v = 0; v < teamOf.size(); v++) {
+                int t = teamOf[v];
+                teamOf_[v] = t;
+                slot_[v] = size_[t];
+                members_[size_t(t) * width_ + size_[t]++] = v;
+            }
+            for (uint32_t v = 0; v < teamOf.size(); v++) {
+                const uint32_t* neighbours = graph_.neighboursBegin(v);
+                const int32_t*  weights    = graph_.weightsBegin(v);
+                for (uint32_t i = 0; i < graph_.degree(v); i++) {
+                    if (neighbours[i] > v && teamOf_[neighbours[i]] == teamOf_[v]) weight_ += weights[i];
+                }
+            }
+        }
+
+        /* Change in weight if v and w traded teams. */
+        long long swapGain(uint32_t v, uint32_t w) const {
+            int a = teamOf_[v], b = teamOf_[w];
+            if (a == b) return 0;
+            long long vToA = 0, vToB = 0, wToA = 0, wToB = 0, between = 0;
+            linksInto(v, a, b, vToA, vToB, w, between);
+            linksInto(w, a, b, wToA, wToB, v, between);
+            return (vToB - between) - vToA + (wToA - between) - wToB;
+        }
+
+        /* Change in weight if v moved to team b. */
+        long long moveGain(uint32_t v, int b) const {
+            long long toA = 0, toB = 0, unused = 0;
+            linksInto(v, teamOf_[v], b, toA, toB, UINT32_MAX, unused);
+            return toB - toA;
+        }
+
+        void swap(uint32_t v, uint32_t w, long long gain) {
+            int a = teamOf_[v], b = teamOf_[w];
+            std::swap(members_[size_t(a) * width_ + slot_[v]], members_[size_t(b) * width_ + slot_[w]]);
+            std::swap(teamOf_[v], teamOf_[w]);
+            std::swap(slot_[v], slot_[w]);
+            weight_ += gain;
+        }
+
+        void move(uint32_t v, int b, long long gain) {
+            int a = teamOf_[v];
+            uint32_t last = members_[size_t(a) * width_ + --size_[a]];
+            members_[size_t(a) * width_ + slot_[v]] = last;
+            slot_[last] = slot_[v];
+
+            teamOf_[v] = b;
+            slot_[v] = size_[b];
+            members_[size_t(b) * width_ + size_[b]++] = v;
+            weight_ += gain;
+        }
+
+        long long weight() const {
+            return weight_;
+        }
+        int team(uint32_t v) const {
+            return teamOf_[v];
+        }
+        int size(int t) const {
+            return size_[t];
+        }
+        uint32_t member(int t, int j) const {
+            return members_[size_t(t) * width_ + j];
+        }
+        const vector<int>& teamOf() const {
+            return teamOf_;
+        }
+
+    private:
+        /* Adds v's links into teams a and b to toA and toB, and v's link to other,
+         * if any, to between.
+         */
+        void linksInto(uint32_t v, int a, int b, long long& toA, long long& toB,
+                       uint32_t other, long long& between) const {
+            const uint32_t* neighbours = graph_.neighboursBegin(v);
+            const int32_t*  weights    = graph_.weightsBegin(v);
+            for (uint32_t i = 0; i < graph_.degree(v); i++) {
+                int t = teamOf_[neighbours[i]];
+                if (t == a) toA += weights[i];
+                else if (t == b) toB += weights[i];
+                if (neighbours[i] == other && v < other) between += weights[i];
+            }
+        }
+
+        const CompactGraph& graph_;
+        int              width_;
+        vector<int>      teamOf_;
+        vector<int>      slot_;
+        vector<uint32_t> members_;   // Row t holds team t's members in its first size_[t] slots.
+        vector<int>      size_;
+        long long        weight_ = 0;
+    };
+
+    /* Grows one team at a time: start from the best-connected person left, then keep
+     * adding whoever has the heaviest links into the team, or the next best-connected
+     * person if nobody left is drawn to it.
+     */
+    vector<int> greedyTeams(const CompactGraph& graph, const TeamSizes& sizes) {
+        uint32_t n = graph.numPeople();
+        vector<long long> strength(n, 0);
+        for (uint32_t v = 0; v < n; v++) {
+            for (const int32_t* w = graph.weightsBegin(v); w != graph.weightsBegin(v) + graph.degree(v); w++) {
+                if (*w > 0) strength[v] += *w;
+            }
+        }
+        vector<uint32_t> byStrength(n);
+        for (uint32_t v = 0; v < n; v++) {
+            byStrength[v] = v;
+        }
+        stable_sort(byStrength.begin(), byStrength.end(), [&](uint32_t a, uint32_t b) {
+            return strength[a] > strength[b];
+        });
+
+        vector<int> teamOf(n, -1);
+        vector<long long> pull(n, 0);
+        vector<uint32_t> touched;
+        size_t nextSeed = 0;
+        auto nextFree = [&] {
+            while (teamOf[byStrength[nextSeed]] != -1) nextSeed++;
+            return byStrength[nextSeed];
+        };
+
+        for (int t = 0; t < sizes.numTeams; t++) {
+            uint32_t chosen = nextFree();
+            for (int filled = 0; ; ) {
+                teamOf[chosen] = t;
+                if (++filled == sizes.of(t)) break;
+
+                const uint32_t* neighbours = graph.neighboursBegin(chosen);
+                const int32_t*  weights    = graph.weightsBegin(chosen);
+                for (uint32_t i = 0; i < graph.degree(chosen); i++) {
+                    if (teamOf[neighbours[i]] != -1) continue;
+                    if (pull[neighbours[i]] == 0) touched.push_back(neighbours[i]);
+                    pull[neighbours[i]] += weights[i];
+                }
+
+                /* Ties go to the lower id. A pull that cancelled out to 0 counts as untouched. */
+                long long best = 0;
+                int pick = -1;
+                for (uint32_t x: touched) {
+                    if (teamOf[x] != -1 || pull[x] <= 0) continue;
+                    if (pull[x] > best || (pull[x] == best && int(x) < pick)) {
+                        best = pull[x];
+                        pick = int(x);
+                    }
+                }
+                chosen = pick != -1 ? uint32_t(pick) : nextFree();
+            }
+
+            for (uint32_t x: touched) {
+                pull[x] = 0;
+            }
+            touched.clear();
+        }
+        return teamOf;
+    }
+
+    /* Swaps (and moves between teams one apart in size) while any of them helps.
+     * Only swaps with the teams of v's neighbours can gain anything.
+     */
+    void improve(Teams& teams, const CompactGraph& graph) {
+        const int kMaxPasses = 50;
+        for (int pass = 0; pass < kMaxPasses; pass++) {
+            bool changed = false;
+            for (uint32_t v = 0; v < graph.numPeople(); v++) {
+                const uint32_t* neighbours = graph.neighboursBegin(v);
+                bool moved = false;
+                for (uint32_t i = 0; i < graph.degree(v) && !moved; i++) {
+                    int a = teams.team(v), b = teams.team(neighbours[i]);
+                    if (a == b) continue;
+
+                    if (teams.size(a) == teams.size(b) + 1) {
+                        long long gain = teams.moveGain(v, b);
+                        if (gain > 0) {
+                            teams.move(v, b, gain);
+                            moved = true;
+                            break;
+                        }
+                    }
+                    for (int j = 0; j < teams.size(b); j++) {
+                        uint32_t w = teams.member(b, j);
+                        long long gain = teams.swapGain(v, w);
+                        if (gain > 0) {
+                            teams.swap(v, w, gain);
+                            moved = true;
+                            break;
+                        }
+                    }
+                }
+                changed = changed || moved;
+            }
+            if (!changed) break;
+        }
+    }
+
+    /* One simulated annealing run from start, ending with improve(). Returns the
+     * best split seen. Swaps are mostly proposed with someone in the team of one of
+     * v's neighbours, since that's where the gains are.
+     */
+    vector<int> anneal(const CompactGraph& graph, const TeamSizes& sizes, const vector<int>& start,
+                       int sweeps, uint32_t seed, uint64_t& proposals) {
+        uint32_t n = graph.numPeople();
+        Teams teams(graph, sizes);
+        teams.assign(start);
+
+        long long positive = 0, numPositive = 0;
+        for (uint32_t v = 0; v < n; v++) {
+            for (const int32_t* w = graph.weightsBegin(v); w != graph.weightsBegin(v) + graph.degree(v); w++) {
+                if (*w > 0) {
+                    positive += *w;
+                    numPositive++;
+                }
+            }
+        }
+
+        vector<int> best = start;
+        long long bestWeight = teams.weight();
+        uint64_t numSteps = uint64_t(max(0, sweeps)) * n;
+        if (numPositive > 0 && sizes.numTeams > 1 && numSteps > 0) {
+            mt19937 generator(seed);
+            uniform_real_distribution<double> coin(0.0, 1.0);
+            double temperature = double(positive) / double(numPositive);
+            double cooling = pow(0.001, 1.0 / double(numSteps));
+
+            for (uint64_t step = 0; step < numSteps; step++, temperature *= cooling) {
+                /* Keep the best split seen, checked once a sweep since copying it is O(n). */
+                if (step % n == 0 && teams.weight() > bestWeight) {
+                    bestWeight = teams.weight();
+                    best = teams.teamOf();
+                }
+
+                uint32_t v = generator() % n;
+                uint32_t w;
+                if (graph.degree(v) > 0 && generator() % 8 != 0) {
+                    uint32_t x = graph.neighboursBegin(v)[generator() % graph.degree(v)];
+                    int b = teams.team(x);
+                    w = teams.member(b, int(generator() % uint32_t(teams.size(b))));
+                } else {
+                    w = generator() % n;
+                }
+                int a = teams.team(v), b = teams.team(w);
+                if (a == b) continue;
+
+                bool moveOnly = teams.size(a) == teams.size(b) + 1 && generator() % 2 == 0;
+                long long gain = moveOnly ? teams.moveGain(v, b) : teams.swapGain(v, w);
+                if (gain < 0 && coin(generator) >= exp(double(gain) / temperature)) continue;
+
+                if (moveOnly) {
+                    teams.move(v, b, gain);
+                } else {
+                    teams.swap(v, w, gain);
+                }
+            }
+            proposals += numSteps;
+
+            if (teams.weight() > bestWeight) best = teams.teamOf();
+            teams.assign(best);
+        }
+
+        improve(teams, graph);
+        return teams.teamOf();
+    }
+
+    /* Exact search for small groups. The state is the set of people placed so far
+     * and how many of the big teams are among the teams made; the lowest unplaced
+     * person always goes in the next team, which is big or small as allowed.
+     */
+    class ExactTeams {
+    public:
+        ExactTeams(const CompactGraph& graph, const TeamSizes& sizes, SolverStats* stats)
+            : n_(int(graph.numPeople())), sizes_(sizes), stats_(stats),
+              weight_(size_t(n_) * n_, 0),
+              memo_((size_t(1) << n_) * (sizes.numBig + 1), LLONG_MIN),
+              choice_(memo_.size(), 0) {
+            for (int v = 0; v < n_; v++) {
+                const uint32_t* neighbours = graph.neighboursBegin(v);
+                const int32_t*  weights    = graph.weightsBegin(v);
+                for (uint32_t i = 0; i < graph.degree(v); i++) {
+                    weight_[size_t(v) * n_ + neighbours[i]] = weights[i];
+                }
+            }
+        }
+
+        long long solve(vector<int>& teamOf) {
+            long long total = best(0, 0);
+            teamOf.assign(n_, -1);
+            uint32_t placed = 0;
+            int bigsUsed = 0;
+            for (int t = 0; t < sizes_.numTeams; t++) {
+                uint32_t team = choice_[key(placed, bigsUsed)];
+                for (int v = 0; v < n_; v++) {
+                    if (team & (1u << v)) teamOf[v] = t;
+                }
+                placed |= team;
+                if (__builtin_popcount(team) > sizes_.base) bigsUsed++;
+            }
+            return total;
+        }
+
+    private:
+        size_t key(uint32_t placed, int bigsUsed) const {
+            return size_t(placed) * (sizes_.numBig + 1) + bigsUsed;
+        }
+
+        long long best(uint32_t placed, int bigsUsed) {
+            if (placed == (1u << n_) - 1) return 0;
+            long long& memo = memo_[key(placed, bigsUsed)];
+            if (memo != LLONG_MIN) {
+                MATCHING_STAT_INC(stats_, memoHits);
+                return memo;
+            }
+            MATCHING_STAT_INC(stats_, nodesExpanded);
+
+            int smallsUsed = (__builtin_popcount(placed) - bigsUsed * (sizes_.base + 1)) / sizes_.base;
+            int first = __builtin_ctz(~placed);
+            long long result = LLONG_MIN;
+            uint32_t bestTeam = 0;
+
+            /* Enumerate the rest of the team in increasing id order, keeping the
+             * team's own weight as people are added.
+             */
+            vector<int> chosen = { first };
+            auto extend = [&](auto& self, int size, int from, long long inside) -> void {
+                if (int(chosen.size()) == size) {
+                    uint32_t team = 0;
+                    for (int v: chosen) {
+                        team |= 1u << v;
+                    }
+                    long long total = inside + best(placed | team, bigsUsed + (size > sizes_.base));
+                    if (total > result) {
+                        result = total;
+                        bestTeam = team;
+                    }
+                    return;
+                }
+                for (int v = from; v < n_; v++) {
+                    if (placed & (1u << v)) continue;
+                    long long added = 0;
+                    for (int u: chosen) {
+                        added += weight_[size_t(u) * n_ + v];
+                    }
+                    chosen.push_back(v);
+                    self(self, size, v + 1, inside + added);
+                    chosen.pop_back();
+                }
+            };
+            if (bigsUsed < sizes_.numBig) extend(extend, sizes_.base + 1, first + 1, 0);
+            if (smallsUsed < sizes_.numTeams - sizes_.numBig) extend(extend, sizes_.base, first + 1, 0);
+
+            memo = result;
+            choice_[key(placed, bigsUsed)] = bestTeam;
+            return result;
+        }
+
+        int               n_;
+        TeamSizes         sizes_;
+        SolverStats*      stats_;
+        vector<long long> weight_;   // n x n.
+        vector<long long> memo_;     // Best weight for the people left, by key(); LLONG_MIN if unknown.
+        vector<uint32_t>  choice_;   // The next team in that best split.
+    };
+
+    /* Renumbers teams in order of their lowest member. */
+    void numberByFirstMember(vector<int>& teamOf, int numTeams) {
+        vector<int> renamed(numTeams, -1);
+        int next = 0;
+        for (int& t: teamOf) {
+            if (renamed[t] == -1) renamed[t] = next++;
+            t = renamed[t];
+        }
+    }
+
+    long long teamWeight(const CompactGraph& graph, const vector<int>& teamOf) {
+        long long total = 0;
+        for (uint32_t v = 0; v < graph.numPeople(); v++) {
+            const uint32_t* neighbours = graph.neighboursBegin(v);
+            const int32_t*  weights    = graph.weightsBegin(v);
+            for (uint32_t i = 0; i < graph.degree(v); i++) {
+                if (neighbours[i] > v && teamOf[neighbours[i]] == teamOf[v]) total += weights[i];
+            }
+        }
+        return total;
+    }
+}
+
+TeamResult partitionIntoTeamsById(const CompactGraph& graph, int teamSize, const TeamOptions& options,
+                                  SolverStats* stats) {
+    if (teamSize < 1) error("partitionIntoTeams: teams need room for at least one person");
+    StatsTimer timer(stats, &SolverStats::secondsSolving);
+
+    int n = int(graph.numPeople());
+    TeamSizes sizes(n, teamSize);
+    TeamResult result;
+    result.numTeams = sizes.numTeams;
+    if (n == 0) {
+        result.optimal = true;
+        return result;
+    }
+
+    result.teamOf = greedyTeams(graph, sizes);
+    result.greedyWeight = teamWeight(graph, result.teamOf);
+
+    if (n <= kExactTeamLimit) {
+        ExactTeams exact(graph, sizes, stats);
+        result.weight = exact.solve(result.teamOf);
+        result.optimal = true;
+    } else {
+        int numChains = max(1, options.numChains);
+        int numThreads = options.numThreads > 0 ? options.numThreads : int(thread::hardware_concurrency());
+        numThreads = max(1, min(numThreads, numChains));
+
+        vector<vector<int>> chainResults(numChains);
+        vector<uint64_t> proposals(numThreads, 0);
+        atomic<int> next { 0 };
+        auto work = [&](int worker) {
+            for (int chain = next++; chain < numChains; chain = next++) {
+                chainResults[chain] = anneal(graph, sizes, result.teamOf, options.sweeps,
+                                             options.seed + uint32_t(chain), proposals[worker]);
+            }
+        };
+        if (numThreads == 1) {
+            work(0);
+        } else {
+            vector<thread> workers;
+            for (int worker = 0; worker < numThreads; worker++) {
+                workers.emplace_back(work, worker);
+            }
+            for (thread& worker: workers) {
+                worker.join();
+            }
+        }
+        MATCHING_STAT_ADD(stats, nodesExpanded, accumulate(proposals.begin(), proposals.end(), uint64_t(0)));
+
+        result.weight = LLONG_MIN;
+        for (const vector<int>& teamOf: chainResults) {
+            long long weight = teamWeight(graph, teamOf);
+            if (weight > result.weight) {
+                result.weight = weight;
+                result.teamOf = teamOf;
+            }
+        }
+    }
+
+    numberByFirstMember(result.teamOf, result.numTeams);
+    return result;
+}
+
+Vector<Set<string>> partitionIntoTeams(const Map<string, Map<string, int>>& possibleLinks, int teamSize,
+                                       const TeamOptions& options) {
+    CompactGraph graph = CompactGraph::fromWeightedLinks(possibleLinks);
+    TeamResult found = partitionIntoTeamsById(graph, teamSize, options);
+
+    Vector<Set<string>> teams;
+    for (int t = 0; t < found.numTeams; t++) {
+        teams.add({});
+    }
+    for (uint32_t v = 0; v < graph.numPeople(); v++) {
+        teams[found.teamOf[v]] += string(graph.name(v));
+    }
+    return teams;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include "TestGraphs.h"
+#include "GUI/SimpleTest.h"
+
+namespace {
+    bool balanced(const TeamResult& result, int teamSize) {
+        vector<int> counts(result.numTeams, 0);
+        for (int t: result.teamOf) {
+            counts[t]++;
+        }
+        auto range = minmax_element(counts.begin(), counts.end());
+        return *range.second <= teamSize && *range.second - *range.first <= 1;
+    }
+}
+
+STUDENT_TEST("partitionIntoTeams keeps friends together") {
+    /* Two tight triangles, lightly linked to each other. */
+    Map<string, Map<string, int>> links = {
+        { "A", { { "B", 5 }, { "C", 5 }, { "D", 1 } } },
+        { "B", { { "A", 5 }, { "C", 5 } } },
+        { "C", { { "A", 5 }, { "B", 5 } } },
+        { "D", { { "A", 1 }, { "E", 4 }, { "F", 4 } } },
+        { "E", { { "D", 4 }, { "F", 4 } } },
+        { "F", { { "D", 4 }, { "E", 4 } } },
+    };
+    Vector<Set<string>> expected = { { "A", "B", "C" }, { "D", "E", "F" } };
+    EXPECT_EQUAL(partitionIntoTeams(links, 3), expected);
+    EXPECT_EQUAL(partitionIntoTeams(links, 6).size(), 1);
+    EXPECT_EQUAL(partitionIntoTeams(links, 4).size(), 2);
+    EXPECT_EQUAL(partitionIntoTeams({}, 3).size(), 0);
+    EXPECT_ERROR(partitionIntoTeams(links, 0));
+}
+
+STUDENT_TEST("Exact team search beats or matches every other split on small groups") {
+    mt19937 generator(29);
+    for (int trial = 0; trial < 30; trial++) {
+        int numPeople = 4 + int(generator() % 10);
+        int teamSize = 2 + int(generator() % 4);
+        CompactGraph graph = randomGraph(generator, numPeople, 2, -2, 9);
+
+        TeamResult exact = partitionIntoTeamsById(graph, teamSize);
+        EXPECT(exact.optimal);
+        EXPECT(balanced(exact, teamSize));
+        EXPECT_EQUAL(teamWeight(graph, exact.teamOf), exact.weight);
+        EXPECT(exact.weight >= exact.greedyWeight);
+
+        /* Random balanced splits never do better. */
+        for (int shuffle = 0; shuffle < 20; shuffle++) {
+            vector<int> teamOf = exact.teamOf;
+            std::shuffle(teamOf.begin(), teamOf.end(), generator);
+            EXPECT(teamWeight(graph, teamOf) <= exact.weight);
+        }
+    }
+}
+
+STUDENT_TEST("Annealing is balanced, consistent, and the same on any number of threads") {
+    mt19937 generator(31);
+    CompactGraph graph = randomGraph(generator, 200, 12, -2, 17);
+
+    TeamOptions options;
+    options.numThreads = 1;
+    TeamResult one = partitionIntoTeamsById(graph, 5, options);
+    options.numThreads = 3;
+    TeamResult three = partitionIntoTeamsById(graph, 5, options);
+
+    EXPECT(!one.optimal);
+    EXPECT_EQUAL(one.numTeams, 40);
+    EXPECT(balanced(one, 5));
+    EXPECT_EQUAL(teamWeight(graph, one.teamOf), one.weight);
+    EXPECT(one.weight >= one.greedyWeight);
+    EXPECT(one.teamOf == three.teamOf);
+
+    /* Uneven sizes: 203 people in teams of at most 4 is 51 teams, of 3 and 4. */
+    CompactGraph uneven = randomGraph(generator, 203, 12, -2, 17);
+    TeamResult result = partitionIntoTeamsById(uneven, 4);
+    EXPECT_EQUAL(result.numTeams, 51);
+    EXPECT(balanced(result, 4));
+    EXPECT_EQUAL(teamWeight(uneven, result.teamOf), result.weight);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CompactGraph.h"
+#include "SolverStats.h"
+#include "map.h"
+#include "set.h"
+#include "vector.h"
+
+struct TeamOptions {
+    /* Worker threads. 0 means one per hardware thread. Never more than numChains. */
+    int numThreads = 0;
+
+    /* Independent annealing runs, each from the same greedy start with its own
+     * random numbers. The best one wins, lowest-numbered on ties, so the answer
+     * doesn't depend on the number of threads.
+     */
+    int numChains = 4;
+
+    /* Swaps each annealing run tries, per person. */
+    int sweeps = 20;
+
+    uint32_t seed = 1;
+};
+
+struct TeamResult {
+    std::vector<int> teamOf;   // teamOf[v] is the team v is in, 0 .. numTeams - 1.
+    int       numTeams = 0;
+    long long weight = 0;      // Total weight of the links within teams.
+    long long greedyWeight = 0;
+    bool      optimal = false; // Solved exactly.
+};
+
+/* Largest group partitionIntoTeamsById solves exactly. */
+const int kExactTeamLimit = 16;
+
+/* Splits everyone into teams of at most teamSize people so as to make the total
+ * weight of the links within teams as large as possible.
+ *
+ * There are ceil(n / teamSize) teams, as even in size as they can be: if teamSize
+ * doesn't divide n, some teams have one person fewer. Weights are taken as given,
+ * so negative links push people apart.
+ *
+ * Groups of up to kExactTeamLimit people are solved exactly, by search over the
+ * set of people still to be placed with each set's best split memoized. Bigger
+ * groups start from a greedy split, which grows one team at a time around the
+ * best-connected person left, always adding whoever has the heaviest links into
+ * the team so far. Several simulated annealing runs then swap people between
+ * teams in parallel, each ending with plain improving swaps, and the best run is
+ * kept. The state is a few flat arrays (each person's team and slot, and each
+ * team's members in fixed-size rows), and a swap's effect is worked out from the
+ * two people's links alone, so it scales to tens of thousands of people.
+ *
+ * Reports an error if teamSize is less than 1.
+ */
+TeamResult partitionIntoTeamsById(const CompactGraph& graph, int teamSize,
+                                  const TeamOptions& options = TeamOptions(),
+                                  SolverStats* stats = nullptr);
+
+/* Convenience wrapper for callers holding a preference map. Returns the teams'
+ * members by name, in order of each team's first member.
+ */
+Vector<Set<std::string>> partitionIntoTeams(const Map<std::string, Map<std::string, int>>& possibleLinks,
+                                            int teamSize, const TeamOptions& options = TeamOptions());
@@ -0,0 +1,50 @@
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+#include "CompactGraph.h"
+
+/* Random graphs for the test cases. People are named "100", "101", ... in id order,
+ * each possible link is present with odds 1 in linkOdds, and links weigh from
+ * lowestWeight to highestWeight.
+ */
+
+inline CompactGraph randomGraph(std::mt19937& generator, int numPeople, int linkOdds,
+                                int lowestWeight, int highestWeight) {
+    CompactGraphBuilder builder;
+    for (int i = 0; i < numPeople; i++) {
+        builder.intern(std::to_string(100 + i));
+    }
+    for (int u = 0; u < numPeople; u++) {
+        for (int v = u + 1; v < numPeople; v++) {
+            if (generator() % linkOdds == 0) {
+                builder.addLink(u, v, lowestWeight + int(generator() % (highestWeight - lowestWeight + 1)));
+            }
+        }
+    }
+    return builder.build();
+}
+
+/* A two-sided graph: numOne people on one side and numTwo on the other, with links
+ * only between the sides. The first numOne ids are side one, unless interleaved,
+ * when the sides alternate by id (until one is full) so they aren't id ranges.
+ */
+inline CompactGraph randomTwoSidedGraph(std::mt19937& generator, int numOne, int numTwo, int linkOdds,
+                                        int lowestWeight, int highestWeight, bool interleaved = false) {
+    CompactGraphBuilder builder;
+    std::vector<uint32_t> one, two;
+    for (int i = 0; i < numOne + numTwo; i++) {
+        uint32_t id = builder.intern(std::to_string(100 + i));
+        bool sideOne = interleaved ? (i % 2 == 0 && int(one.size()) < numOne) || int(two.size()) == numTwo
+                                   : i < numOne;
+        (sideOne ? one : two).push_back(id);
+    }
+    for (uint32_t u: one) {
+        for (uint32_t v: two) {
+            if (generator() % linkOdds == 0) {
+                builder.addLink(u, v, lowestWeight + int(generator() % (highestWeight - lowestWeight + 1)));
+            }
+        }
+    }
+    return builder.build();
+}
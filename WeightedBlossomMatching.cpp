@@ -0,0 +1,657 @@
+/*
+ * Primal-dual blossom algorithm for maximum-weight matching. See WeightedBlossomMatching.h.
+ *
+ * This follows the structure of Galil's presentation ("Efficient Algorithms for Finding
+ * Maximum Matching in Graphs", 1986): each stage grows alternating trees from all unpaired
+ * vertices over tight edges (slack zero), contracting odd cycles into blossoms, and when it
+ * gets stuck it changes the dual variables by the largest amount that keeps every edge's
+ * slack non-negative. Endpoints are numbered 2k and 2k + 1 for edge k so that p ^ 1 is the
+ * other end of the same edge.
+ */
+
+#include "WeightedBlossomMatching.h"
+#include <algorithm>
+using namespace std;
+
+WeightedBlossomMatching::WeightedBlossomMatching(int numVertices, const vector<WeightedEdge>& edges, Arena& arena)
+    : arena_(arena),
+      numVertices_(numVertices),
+      edges_(arena, edges.size()),
+      incidentStart_(arena, numVertices + 1, 0),
+      incident_(arena, 2 * edges.size()),
+      mate_(arena, numVertices, -1),
+      label_(arena, 2 * numVertices, 0),
+      labelEnd_(arena, 2 * numVertices, -1),
+      inBlossom_(arena, numVertices),
+      blossomParent_(arena, 2 * numVertices, -1),
+      blossomBase_(arena, 2 * numVertices, -1),
+      /* Children and endpoints: at most 2n entries each are live at once, since every vertex
+       * and blossom is a child of at most one blossom. Best-edge lists: each edge appears in
+       * at most the lists of its two endpoints' blossoms. The pool is twice that.
+       */
+      lists_(arena, 6 * numVertices, 2 * (4 * size_t(numVertices) + 2 * edges.size()) + 1),
+      bestEdge_(arena, 2 * numVertices, -1),
+      hasBestEdges_(arena, 2 * numVertices, false),
+      unusedBlossoms_(arena, numVertices),
+      dual_(arena, 2 * numVertices, 0),
+      allowEdge_(arena, edges.size(), false),
+      queue_(arena, 2 * size_t(numVertices) + 1),
+      leaves_(arena, numVertices),
+      subLeaves_(arena, numVertices),
+      scanPath_(arena, 2 * numVertices),
+      tracedChildren_(arena, 2 * numVertices),
+      tracedEndpoints_(arena, 2 * numVertices),
+      touchedTargets_(arena, 2 * numVertices),
+      bestEdgeTo_(arena, 2 * numVertices, -1) {
+    copy(edges.begin(), edges.end(), edges_.begin());
+
+    /* Lay out each vertex's incident endpoints contiguously. */
+    long long maxWeight = 0;
+    for (const WeightedEdge& edge: edges) {
+        incidentStart_[edge.u + 1]++;
+        incidentStart_[edge.v + 1]++;
+        maxWeight = max(maxWeight, edge.weight);
+    }
+    for (int v = 0; v < numVertices_; v++) {
+        incidentStart_[v + 1] += incidentStart_[v];
+    }
+    for (int k = 0; k < int(edges.size()); k++) {
+        incident_[incidentStart_[edges[k].u]++] = 2 * k + 1;
+        incident_[incidentStart_[edges[k].v]++] = 2 * k;
+    }
+    for (int v = numVertices_; v > 0; v--) {
+        incidentStart_[v] = incidentStart_[v - 1];
+    }
+    incidentStart_[0] = 0;
+
+    for (int v = 0; v < numVertices_; v++) {
+        inBlossom_[v] = v;
+        blossomBase_[v] = v;
+        dual_[v] = maxWeight;
+    }
+    for (int b = 2 * numVertices_ - 1; b >= numVertices_; b--) {
+        unusedBlossoms_.push_back(b);
+    }
+}
+
+WeightedBlossomMatching::WeightedBlossomMatching(int numVertices, const vector<WeightedEdge>& edges)
+    : WeightedBlossomMatching(numVertices, edges, ownArena_) {
+}
+
+namespace {
+    vector<WeightedEdge> positiveEdges(const CompactGraph& graph) {
+        vector<WeightedEdge> edges;
+        for (uint32_t v = 0; v < graph.numPeople(); v++) {
+            const int32_t* w = graph.weightsBegin(v);
+            for (const uint32_t* u = graph.neighboursBegin(v); u != graph.neighboursEnd(v); u++, w++) {
+                if (*u > v && *w > 0) {
+                    edges.push_back({ int(v), int(*u), *w });
+                }
+            }
+        }
+        return edges;
+    }
+}
+
+WeightedBlossomMatching::WeightedBlossomMatching(const CompactGraph& graph, Arena& arena)
+    : WeightedBlossomMatching(int(graph.numPeople()), positiveEdges(graph), arena) {
+}
+
+WeightedBlossomMatching::WeightedBlossomMatching(const CompactGraph& graph)
+    : WeightedBlossomMatching(graph, ownArena_) {
+}
+
+vector<int> WeightedBlossomMatching::mates() const {
+    vector<int> result(numVertices_);
+    for (int v = 0; v < numVertices_; v++) {
+        result[v] = mate(v);
+    }
+    return result;
+}
+
+void WeightedBlossomMatching::collectLeaves(int b, ArenaStack<int>& out) const {
+    if (b < numVertices_) {
+        out.push_back(b);
+        return;
+    }
+    const int* children = childrenOf(b);
+    for (int i = 0; i < numChildren(b); i++) {
+        collectLeaves(children[i], out);
+    }
+}
+
+int WeightedBlossomMatching::childIndex(int b, int child) const {
+    const int* children = childrenOf(b);
+    return int(find(children, children + numChildren(b), child) - children);
+}
+
+/* Labels the top-level blossom containing w with t (1 = S, 2 = T), reached through endpoint p.
+ * A T-blossom's mate is labelled S in turn.
+ */
+void WeightedBlossomMatching::assignLabel(int w, int t, int p) {
+    MATCHING_STAT_INC(stats_, nodesExpanded);
+    int b = inBlossom_[w];
+    label_[w] = label_[b] = t;
+    labelEnd_[w] = labelEnd_[b] = p;
+    bestEdge_[w] = bestEdge_[b] = -1;
+
+    if (t == 1) {
+        leaves_.clear();
+        collectLeaves(b, leaves_);
+        for (int leaf: leaves_) {
+            queue_.push_back(leaf);
+        }
+    } else {
+        int base = blossomBase_[b];
+        assignLabel(endpoint(mate_[base]), 1, mate_[base] ^ 1);
+    }
+}
+
+/* Traces back from S-vertices v and w to discover either a new blossom (returns its base)
+ * or an augmenting path (returns -1).
+ */
+int WeightedBlossomMatching::scanBlossom(int v, int w) {
+    auto& path = scanPath_;
+    path.clear();
+    int base = -1;
+    while (v != -1 || w != -1) {
+        int b = inBlossom_[v];
+        if (label_[b] & 4) {
+            base = blossomBase_[b];
+            break;
+        }
+        path.push_back(b);
+        label_[b] = 5;
+
+        if (labelEnd_[b] == -1) {
+            /* Reached the root of this tree. */
+            v = -1;
+        } else {
+            v = endpoint(labelEnd_[b]);
+            b = inBlossom_[v];
+            v = endpoint(labelEnd_[b]);
+        }
+
+        /* Alternate between the two paths. */
+        if (w != -1) swap(v, w);
+    }
+
+    for (int b: path) {
+        label_[b] = 1;
+    }
+    return base;
+}
+
+/* Builds a new blossom from the cycle closed by edge k, with the given base. */
+void WeightedBlossomMatching::addBlossom(int base, int k) {
+    MATCHING_STAT_INC(stats_, blossomsShrunk);
+    int v = edges_[k].u;
+    int w = edges_[k].v;
+    int bb = inBlossom_[base];
+    int bv = inBlossom_[v];
+    int bw = inBlossom_[w];
+
+    int b = unusedBlossoms_.back();
+    unusedBlossoms_.pop_back();
+    blossomBase_[b] = base;
+    blossomParent_[b] = -1;
+    blossomParent_[bb] = b;
+
+    /* Trace the cycle into scratch space first, since its length isn't known yet. */
+    auto& path = tracedChildren_;
+    auto& endps = tracedEndpoints_;
+    path.clear();
+    endps.clear();
+
+    /* Trace back from v to the base. */
+    while (bv != bb) {
+        blossomParent_[bv] = b;
+        path.push_back(bv);
+        endps.push_back(labelEnd_[bv]);
+        v = endpoint(labelEnd_[bv]);
+        bv = inBlossom_[v];
+    }
+    path.push_back(bb);
+    reverse(path.begin(), path.end());
+    reverse(endps.begin(), endps.end());
+    endps.push_back(2 * k);
+
+    /* Trace back from w to the base. */
+    while (bw != bb) {
+        blossomParent_[bw] = b;
+        path.push_back(bw);
+        endps.push_back(labelEnd_[bw] ^ 1);
+        w = endpoint(labelEnd_[bw]);
+        bw = inBlossom_[w];
+    }
+
+    copy(path.begin(), path.end(), lists_.allocate(b, int(path.size())));
+    copy(endps.begin(), endps.end(), lists_.allocate(endpointsList(b), int(endps.size())));
+
+    label_[b] = 1;
+    labelEnd_[b] = labelEnd_[bb];
+    dual_[b] = 0;
+
+    leaves_.clear();
+    collectLeaves(b, leaves_);
+    for (int leaf: leaves_) {
+        if (label_[inBlossom_[leaf]] == 2) {
+            /* This T-vertex now becomes an S-vertex. */
+            queue_.push_back(leaf);
+        }
+        inBlossom_[leaf] = b;
+    }
+
+    /* Compute the least-slack edge from the new blossom to every neighbouring S-blossom. */
+    auto& touchedTargets = touchedTargets_;
+    touchedTargets.clear();
+    auto consider = [&](int edge) {
+        int i = edges_[edge].u;
+        int j = edges_[edge].v;
+        if (inBlossom_[j] == b) swap(i, j);
+        int bj = inBlossom_[j];
+        if (bj != b && label_[bj] == 1 &&
+            (bestEdgeTo_[bj] == -1 || slack(edge) < slack(bestEdgeTo_[bj]))) {
+            if (bestEdgeTo_[bj] == -1) touchedTargets.push_back(bj);
+            bestEdgeTo_[bj] = edge;
+        }
+    };
+
+    for (int child: path) {
+        if (!hasBestEdges_[child]) {
+            /* No cached list for this sub-blossom: scan all edges of its leaves. */
+            subLeaves_.clear();
+            collectLeaves(child, subLeaves_);
+            for (int leaf: subLeaves_) {
+                for (int i = incidentStart_[leaf]; i < incidentStart_[leaf + 1]; i++) {
+                    consider(incident_[i] / 2);
+                }
+            }
+        } else {
+            const int* edges = lists_.data(bestEdgesList(child));
+            for (int i = 0; i < lists_.length(bestEdgesList(child)); i++) {
+                consider(edges[i]);
+            }
+        }
+        lists_.release(bestEdgesList(child));
+        hasBestEdges_[child] = false;
+        bestEdge_[child] = -1;
+    }
+
+    sort(touchedTargets.begin(), touchedTargets.end());
+    int* best = lists_.allocate(bestEdgesList(b), int(touchedTargets.size()));
+    for (size_t i = 0; i < touchedTargets.size(); i++) {
+        best[i] = bestEdgeTo_[touchedTargets[i]];
+        bestEdgeTo_[touchedTargets[i]] = -1;
+    }
+    hasBestEdges_[b] = true;
+
+    bestEdge_[b] = -1;
+    for (size_t i = 0; i < touchedTargets.size(); i++) {
+        if (bestEdge_[b] == -1 || slack(best[i]) < slack(bestEdge_[b])) {
+            bestEdge_[b] = best[i];
+        }
+    }
+}
+
+/* Dissolves blossom b, either mid-stage (its dual hit zero while it was a T-blossom)
+ * or at the end of a stage (endStage, for S-blossoms whose dual is zero).
+ */
+void WeightedBlossomMatching::expandBlossom(int b, bool endStage) {
+    MATCHING_STAT_INC(stats_, blossomsExpanded);
+    for (int i = 0; i < numChildren(b); i++) {
+        int s = childrenOf(b)[i];
+        blossomParent_[s] = -1;
+        if (s < numVertices_) {
+            inBlossom_[s] = s;
+        } else if (endStage && dual_[s] == 0) {
+            expandBlossom(s, endStage);
+        } else {
+            leaves_.clear();
+            collectLeaves(s, leaves_);
+            for (int leaf: leaves_) {
+                inBlossom_[leaf] = s;
+            }
+        }
+    }
+
+    if (!endStage && label_[b] == 2) {
+        /* Relabel the sub-blossoms on the even-length path from the entry child to the base. */
+        const int* children = childrenOf(b);
+        const int* endps = lists_.data(endpointsList(b));
+        int length = numChildren(b);
+        auto childAt = [&](int j) { return children[((j % length) + length) % length]; };
+        auto endpAt  = [&](int j) { return endps[((j % length) + length) % length]; };
+
+        int entryChild = inBlossom_[endpoint(labelEnd_[b] ^ 1)];
+        int j = childIndex(b, entryChild);
+        int jStep, endpTrick;
+        if (j & 1) {
+            j -= length;
+            jStep = 1;
+            endpTrick = 0;
+        } else {
+            jStep = -1;
+            endpTrick = 1;
+        }
+
+        int p = labelEnd_[b];
+        while (j != 0) {
+            label_[endpoint(p ^ 1)] = 0;
+            label_[endpoint(endpAt(j - endpTrick) ^ endpTrick ^ 1)] = 0;
+            assignLabel(endpoint(p ^ 1), 2, p);
+            allowEdge_[endpAt(j - endpTrick) / 2] = true;
+            j += jStep;
+            p = endpAt(j - endpTrick) ^ endpTrick;
+            allowEdge_[p / 2] = true;
+            j += jStep;
+        }
+
+        /* The base child becomes a T-blossom without relabelling its mate. */
+        int bv = childAt(j);
+        label_[endpoint(p ^ 1)] = label_[bv] = 2;
+        labelEnd_[endpoint(p ^ 1)] = labelEnd_[bv] = p;
+        bestEdge_[bv] = -1;
+
+        /* Children on the odd path keep no label, unless one of their vertices was
+         * reached from outside, in which case that vertex is relabelled T.
+         */
+        j += jStep;
+        while (childAt(j) != entryChild) {
+            bv = childAt(j);
+            if (label_[bv] == 1) {
+                j += jStep;
+                continue;
+            }
+            leaves_.clear();
+            collectLeaves(bv, leaves_);
+            int labelled = -1;
+            for (int leaf: leaves_) {
+                if (label_[leaf] != 0) {
+                    labelled = leaf;
+                    break;
+                }
+            }
+            if (labelled != -1) {
+                label_[labelled] = 0;
+                label_[endpoint(mate_[blossomBase_[bv]])] = 0;
+                assignLabel(labelled, 2, labelEnd_[labelled]);
+            }
+            j += jStep;
+        }
+    }
+
+    label_[b] = labelEnd_[b] = -1;
+    lists_.release(b);
+    lists_.release(endpointsList(b));
+    blossomBase_[b] = -1;
+    lists_.release(bestEdgesList(b));
+    hasBestEdges_[b] = false;
+    bestEdge_[b] = -1;
+    unusedBlossoms_.push_back(b);
+}
+
+/* Swaps matched and unmatched edges along the even path through blossom b from vertex v
+ * to the base, then rotates b so that v becomes its new base.
+ */
+void WeightedBlossomMatching::augmentBlossom(int b, int v) {
+    int t = v;
+    while (blossomParent_[t] != b) {
+        t = blossomParent_[t];
+    }
+    if (t >= numVertices_) augmentBlossom(t, v);
+
+    int* children = childrenOf(b);
+    int* endps = lists_.data(endpointsList(b));
+    int length = numChildren(b);
+    auto wrap = [&](int j) { return ((j % length) + length) % length; };
+
+    int i = childIndex(b, t);
+    int j = i;
+    int jStep, endpTrick;
+    if (i & 1) {
+        j -= length;
+        jStep = 1;
+        endpTrick = 0;
+    } else {
+        jStep = -1;
+        endpTrick = 1;
+    }
+
+    while (j != 0) {
+        j += jStep;
+        t = children[wrap(j)];
+        int p = endps[wrap(j - endpTrick)] ^ endpTrick;
+        if (t >= numVertices_) augmentBlossom(t, endpoint(p));
+        j += jStep;
+        t = children[wrap(j)];
+        if (t >= numVertices_) augmentBlossom(t, endpoint(p ^ 1));
+        mate_[endpoint(p)] = p ^ 1;
+        mate_[endpoint(p ^ 1)] = p;
+    }
+
+    rotate(children, children + i, children + length);
+    rotate(endps, endps + i, endps + length);
+    blossomBase_[b] = blossomBase_[children[0]];
+}
+
+/* Flips the augmenting path through edge k, which joins two S-vertices in different trees. */
+void WeightedBlossomMatching::augmentMatching(int k) {
+    MATCHING_STAT_INC(stats_, augmentations);
+    const int starts[2][2] = { { edges_[k].u, 2 * k + 1 }, { edges_[k].v, 2 * k } };
+    for (const auto& start: starts) {
+        int s = start[0];
+        int p = start[1];
+        while (true) {
+            int bs = inBlossom_[s];
+            if (bs >= numVertices_) augmentBlossom(bs, s);
+            mate_[s] = p;
+
+            /* Stop at the root of the tree. */
+            if (labelEnd_[bs] == -1) break;
+
+            int t = endpoint(labelEnd_[bs]);
+            int bt = inBlossom_[t];
+            s = endpoint(labelEnd_[bt]);
+            int j = endpoint(labelEnd_[bt] ^ 1);
+            if (bt >= numVertices_) augmentBlossom(bt, j);
+            mate_[j] = labelEnd_[bt];
+            p = labelEnd_[bt] ^ 1;
+        }
+    }
+}
+
+bool WeightedBlossomMatching::runStage() {
+    label_.fill(0);
+    bestEdge_.fill(-1);
+    for (int b = numVertices_; b < 2 * numVertices_; b++) {
+        lists_.release(bestEdgesList(b));
+        hasBestEdges_[b] = false;
+    }
+    allowEdge_.fill(false);
+    queue_.clear();
+
+    for (int v = 0; v < numVertices_; v++) {
+        if (mate_[v] == -1 && label_[inBlossom_[v]] == 0) {
+            assignLabel(v, 1, -1);
+        }
+    }
+
+    while (true) {
+        /* Grow the trees along tight edges. */
+        while (!queue_.empty()) {
+            int v = queue_.back();
+            queue_.pop_back();
+
+            for (int i = incidentStart_[v]; i < incidentStart_[v + 1]; i++) {
+                int p = incident_[i];
+                int k = p / 2;
+                int w = endpoint(p);
+                if (inBlossom_[v] == inBlossom_[w]) continue;
+
+                long long kSlack = 0;
+                if (!allowEdge_[k]) {
+                    kSlack = slack(k);
+                    if (kSlack <= 0) allowEdge_[k] = true;
+                }
+
+                if (allowEdge_[k]) {
+                    if (label_[inBlossom_[w]] == 0) {
+                        assignLabel(w, 2, p ^ 1);
+                    } else if (label_[inBlossom_[w]] == 1) {
+                        int base = scanBlossom(v, w);
+                        if (base >= 0) {
+                            addBlossom(base, k);
+                        } else {
+                            augmentMatching(k);
+                            return true;
+                        }
+                    } else if (label_[w] == 0) {
+                        /* w is inside a T-blossom but hasn't been reached yet. */
+                        label_[w] = 2;
+                        labelEnd_[w] = p ^ 1;
+                    }
+                } else if (label_[inBlossom_[w]] == 1) {
+                    int b = inBlossom_[v];
+                    if (bestEdge_[b] == -1 || kSlack < slack(bestEdge_[b])) {
+                        bestEdge_[b] = k;
+                    }
+                } else if (label_[w] == 0) {
+                    if (bestEdge_[w] == -1 || kSlack < slack(bestEdge_[w])) {
+                        bestEdge_[w] = k;
+                    }
+                }
+            }
+        }
+
+        /* Stuck: pick the largest dual change that keeps every slack non-negative. */
+        int deltaType = 1;
+        long long delta = *min_element(dual_.begin(), dual_.begin() + numVertices_);
+        int deltaEdge = -1;
+        int deltaBlossom = -1;
+
+        for (int v = 0; v < numVertices_; v++) {
+            if (label_[inBlossom_[v]] == 0 && bestEdge_[v] != -1) {
+                long long d = slack(bestEdge_[v]);
+                if (d < delta) {
+                    delta = d;
+                    deltaType = 2;
+                    deltaEdge = bestEdge_[v];
+                }
+            }
+        }
+        for (int b = 0; b < 2 * numVertices_; b++) {
+            if (blossomParent_[b] == -1 && label_[b] == 1 && bestEdge_[b] != -1) {
+                long long d = slack(bestEdge_[b]) / 2;
+                if (d < delta) {
+                    delta = d;
+                    deltaType = 3;
+                    deltaEdge = bestEdge_[b];
+                }
+            }
+        }
+        for (int b = numVertices_; b < 2 * numVertices_; b++) {
+            if (blossomBase_[b] >= 0 && blossomParent_[b] == -1 && label_[b] == 2 && dual_[b] < delta) {
+                delta = dual_[b];
+                deltaType = 4;
+                deltaBlossom = b;
+            }
+        }
+
+        MATCHING_STAT_INC(stats_, dualAdjustments);
+        for (int v = 0; v < numVertices_; v++) {
+            int label = label_[inBlossom_[v]];
+            if (label == 1) {
+                dual_[v] -= delta;
+            } else if (label == 2) {
+                dual_[v] += delta;
+            }
+        }
+        for (int b = numVertices_; b < 2 * numVertices_; b++) {
+            if (blossomBase_[b] >= 0 && blossomParent_[b] == -1) {
+                if (label_[b] == 1) {
+                    dual_[b] += delta;
+                } else if (label_[b] == 2) {
+                    dual_[b] -= delta;
+                }
+            }
+        }
+
+        if (deltaType == 1) {
+            /* Some vertex dual hit zero: no further augmentation can add weight. */
+            return false;
+        } else if (deltaType == 2) {
+            allowEdge_[deltaEdge] = true;
+            int i = edges_[deltaEdge].u;
+            if (label_[inBlossom_[i]] == 0) i = edges_[deltaEdge].v;
+            queue_.push_back(i);
+        } else if (deltaType == 3) {
+            allowEdge_[deltaEdge] = true;
+            queue_.push_back(edges_[deltaEdge].u);
+        } else {
+            expandBlossom(deltaBlossom, false);
+        }
+    }
+}
+
+long long WeightedBlossomMatching::solve() {
+    MATCHING_STAT_MAX(stats_, peakWorkspaceBytes, arena_.peakBytes());
+    finished_ = true;
+    if (edges_.size() == 0) return 0;
+
+    for (int stage = 0; stage < numVertices_; stage++) {
+        if (shouldStop_ && shouldStop_()) {
+            finished_ = false;
+            break;
+        }
+        MATCHING_STAT_INC(stats_, stages);
+        if (!runStage()) break;
+
+        /* Expand S-blossoms whose dual dropped to zero. */
+        for (int b = numVertices_; b < 2 * numVertices_; b++) {
+            if (blossomParent_[b] == -1 && blossomBase_[b] >= 0 && label_[b] == 1 && dual_[b] == 0) {
+                expandBlossom(b, true);
+            }
+        }
+    }
+
+    long long total = 0;
+    for (int v = 0; v < numVertices_; v++) {
+        if (mate(v) > v) total += edges_[mate_[v] / 2].weight;
+    }
+    return total;
+}
+
+
+/* * * * * Test Cases Below This Point * * * * */
+
+#include <random>
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("WeightedBlossomMatching doesn't grow its arena while solving") {
+    /* Random weights force plenty of blossoms to be built and torn down. */
+    mt19937 generator(2024);
+    const int kNumPeople = 400;
+    vector<WeightedEdge> edges;
+    for (int u = 0; u < kNumPeople; u++) {
+        for (int v = u + 1; v < kNumPeople; v++) {
+            if (generator() % 40 == 0) {
+                edges.push_back({ u, v, (long long)(generator() % 50) + 1 });
+            }
+        }
+    }
+
+    Arena arena;
+    WeightedBlossomMatching engine(kNumPeople, edges, arena);
+    size_t afterSetup = arena.heapAllocations();
+
+    EXPECT(engine.solve() > 0);
+    EXPECT_EQUAL(arena.heapAllocations(), afterSetup);
+
+    /* The same arena, reset, holds a second solver without growing. */
+    arena.reset();
+    size_t afterReset = arena.heapAllocations();
+    WeightedBlossomMatching again(kNumPeople, edges, arena);
+    again.solve();
+    EXPECT_EQUAL(arena.heapAllocations(), afterReset);
+}
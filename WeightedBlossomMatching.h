@@ -0,0 +1,160 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include "Arena.h"
+#include "CompactGraph.h"
+#include "SolverStats.h"
+
+/* One undirected, weighted link between people u and v (numbered 0 .. n - 1). */
+struct WeightedEdge {
+    int u;
+    int v;
+    long long weight;
+};
+
+/* Maximum-weight matching in a general graph using the primal-dual blossom
+ * algorithm (Edmonds, with Galil's O(n^3) bookkeeping).
+ *
+ * The matching found need not be perfect: a link is only used if it increases
+ * the total weight, so links with weight <= 0 are never chosen. All arithmetic
+ * is done on integers; vertex duals are kept at twice their LP value so that
+ * halving a slack never loses precision.
+ *
+ * All working state, including the variable-length lists each blossom keeps, is
+ * allocated from an Arena when the solver is constructed, and solving doesn't grow
+ * the arena.
+ */
+class WeightedBlossomMatching {
+public:
+    /* Edges must not be self-loops and must not repeat a pair. The arena must
+     * outlive the solver.
+     */
+    WeightedBlossomMatching(int numVertices, const std::vector<WeightedEdge>& edges, Arena& arena);
+    WeightedBlossomMatching(int numVertices, const std::vector<WeightedEdge>& edges);
+
+    /* Uses every link in the graph with positive weight. */
+    WeightedBlossomMatching(const CompactGraph& graph, Arena& arena);
+    explicit WeightedBlossomMatching(const CompactGraph& graph);
+
+    /* Runs the algorithm. Returns the total weight of the matching. */
+    long long solve();
+
+    /* Makes solve() check shouldStop between stages and return early once it says
+     * so. The matching is still valid then, just possibly not the heaviest. Each
+     * stage adds at most one pair, so a graph of n people is checked up to n / 2
+     * times.
+     */
+    void setStopCondition(std::function<bool()> shouldStop) {
+        shouldStop_ = std::move(shouldStop);
+    }
+    /* Whether the last solve() ran to the end, so its matching is the heaviest. */
+    bool finished() const {
+        return finished_;
+    }
+
+    /* Counts what the solver does into stats from now on (see SolverStats.h).
+     * Pass nullptr to stop.
+     */
+    void setStats(SolverStats* stats) {
+        stats_ = stats;
+    }
+
+    int mate(int v) const {
+        return mate_[v] == -1 ? -1 : endpoint(mate_[v]);
+    }
+    int size() const {
+        return numVertices_;
+    }
+    std::vector<int> mates() const;
+
+    /* The LP duals that prove the matching is the heaviest, once solve() has finished.
+     * Nodes 0 .. size() - 1 are people and size() .. 2 size() - 1 are blossoms, which
+     * nest: blossomParent(x) is the blossom directly containing person or blossom x,
+     * or -1. Duals are doubled like the solver's: for every link u -- v,
+     *
+     *     dual(u) + dual(v) + 2 * (sum of dual(b) over blossoms b containing both) >= 2 * weight,
+     *
+     * with equality on paired links, and unpaired people have dual 0.
+     */
+    long long dual(int node) const {
+        return dual_[node];
+    }
+    int blossomParent(int node) const {
+        return blossomParent_[node];
+    }
+
+private:
+    int endpoint(int p) const {
+        return (p & 1) ? edges_[p / 2].v : edges_[p / 2].u;
+    }
+    long long slack(int k) const {
+        return dual_[edges_[k].u] + dual_[edges_[k].v] - 2 * edges_[k].weight;
+    }
+
+    /* Each blossom b owns three lists in lists_: its children in cycle order, the
+     * endpoints of the edges joining consecutive children, and its least-slack
+     * edges to neighbouring S-blossoms.
+     */
+    int endpointsList(int b) const {
+        return 2 * numVertices_ + b;
+    }
+    int bestEdgesList(int b) const {
+        return 4 * numVertices_ + b;
+    }
+    int* childrenOf(int b) {
+        return lists_.data(b);
+    }
+    const int* childrenOf(int b) const {
+        return lists_.data(b);
+    }
+    int numChildren(int b) const {
+        return lists_.length(b);
+    }
+
+    void collectLeaves(int b, ArenaStack<int>& out) const;
+    void assignLabel(int w, int t, int p);
+    int  scanBlossom(int v, int w);
+    void addBlossom(int base, int k);
+    void expandBlossom(int b, bool endStage);
+    void augmentBlossom(int b, int v);
+    void augmentMatching(int k);
+    int  childIndex(int b, int child) const;
+
+    /* Runs one stage: grows alternating trees from every unpaired person and
+     * adjusts duals until it either augments or proves no augmentation helps.
+     */
+    bool runStage();
+
+    Arena                    ownArena_;
+    Arena&                   arena_;
+    SolverStats*             stats_ = nullptr;
+    std::function<bool()>    shouldStop_;
+    bool                     finished_ = false;
+    int                      numVertices_;
+    ArenaArray<WeightedEdge> edges_;
+    ArenaArray<int>          incidentStart_;   // CSR offsets into incident_.
+    ArenaArray<int>          incident_;        // Remote endpoint ids (2k or 2k + 1) per vertex.
+
+    ArenaArray<int>          mate_;            // Remote endpoint of each vertex's matched edge.
+    ArenaArray<int>          label_;           // 0 free, 1 S (outer), 2 T (inner), 5 scan mark.
+    ArenaArray<int>          labelEnd_;
+    ArenaArray<int>          inBlossom_;       // Top-level blossom containing each vertex.
+    ArenaArray<int>          blossomParent_;
+    ArenaArray<int>          blossomBase_;
+    SlicePool                lists_;
+    ArenaArray<int>          bestEdge_;
+    ArenaArray<char>         hasBestEdges_;
+    ArenaStack<int>          unusedBlossoms_;
+    ArenaArray<long long>    dual_;
+    ArenaArray<char>         allowEdge_;
+    ArenaStack<int>          queue_;
+
+    /* Scratch space. */
+    ArenaStack<int>          leaves_;
+    ArenaStack<int>          subLeaves_;
+    ArenaStack<int>          scanPath_;
+    ArenaStack<int>          tracedChildren_;
+    ArenaStack<int>          tracedEndpoints_;
+    ArenaStack<int>          touchedTargets_;
+    ArenaArray<int>          bestEdgeTo_;
+};
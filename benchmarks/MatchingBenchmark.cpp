@@ -0,0 +1,545 @@
+/*
+ * Benchmarks for the matching functions and the solvers behind them.
+ *
+ * This is its own program, with its own main(), so it lives outside the main
+ * project. Build it against the same sources and the Stanford library, with
+ * optimization on, for example:
+ *
+ *     g++ -std=c++17 -O2 -pthread -I.. -I<stanford-lib>/include \
+ *         MatchingBenchmark.cpp ../Arena.cpp ../AuctionMatching.cpp ../BipartiteMatching.cpp \
+ *         ../BlossomMatching.cpp ../CompactGraph.cpp ../ComponentMatching.cpp ../DenseKernels.cpp \
+ *         ../DenseMatching.cpp ../MatchingScore.cpp ../Matchmaker.cpp ../PerfectMatchingPrecheck.cpp \
+ *         ../SmallGroupMatching.cpp ../SolverStats.cpp ../WeightedBlossomMatching.cpp \
+ *         -L<stanford-lib>/lib -lstanfordcpplib
+ *
+ * No -m flags are needed: DenseKernels.cpp compiles its AVX2 and AVX-512 versions
+ * with per-function target attributes and picks one at run time.
+ *
+ * Every benchmark is one solver run on one graph family at one size. Families go
+ * from 10 up to 100,000 people; see the table of families below. Solvers for
+ * two-sided graphs only run on families whose graphs are two-sided. For each run it
+ * reports the time per call, the heap allocations and bytes per call (counted by
+ * replacing the global operator new), and the peak extra heap a single call
+ * needed. Results go to stdout as JSON, shaped like Google Benchmark's output so
+ * the same tools can compare two runs; a readable table goes to stderr. Built with
+ * -DMATCHING_STATS=1, each entry also carries the solver's SolverStats counters
+ * from one untimed call.
+ *
+ * Options:
+ *     --filter=TEXT      Only run benchmarks whose name contains TEXT.
+ *     --max-nodes=N      Skip sizes above N (default 100000).
+ *     --min-time=S       Repeat each benchmark for at least S seconds (default 0.5).
+ *     --max-seconds=S    Skip a size if a call at the size before it, scaled up as if
+ *                        the solver were quadratic, would take longer than S seconds
+ *                        (default 10). The larger sizes of that family are skipped too.
+ */
+
+#include <sys/resource.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AuctionMatching.h"
+#include "BipartiteMatching.h"
+#include "BlossomMatching.h"
+#include "CompactGraph.h"
+#include "DenseMatching.h"
+#include "Matchmaker.h"
+#include "SmallGroupMatching.h"
+#include "SolverStats.h"
+#include "WeightedBlossomMatching.h"
+#include "map.h"
+#include "set.h"
+using namespace std;
+
+/* * * * * Heap accounting * * * * */
+
+namespace {
+    /* Every block carries its size in front of it, so frees can be counted too. */
+    const size_t kHeaderBytes = alignof(max_align_t);
+
+    atomic<uint64_t> gAllocations { 0 };
+    atomic<uint64_t> gBytesAllocated { 0 };
+    atomic<int64_t>  gLiveBytes { 0 };
+    atomic<int64_t>  gPeakLiveBytes { 0 };
+
+    void* countedAllocate(size_t size, size_t alignment) {
+        size_t header = max(kHeaderBytes, alignment);
+        void* block = alignment > kHeaderBytes
+                    ? aligned_alloc(alignment, (header + size + alignment - 1) / alignment * alignment)
+                    : malloc(header + size);
+        if (block == nullptr) throw bad_alloc();
+
+        *static_cast<size_t*>(block) = size;
+        gAllocations++;
+        gBytesAllocated += size;
+        int64_t live = gLiveBytes += int64_t(size);
+        int64_t peak = gPeakLiveBytes.load();
+        while (live > peak && !gPeakLiveBytes.compare_exchange_weak(peak, live)) {
+        }
+        return static_cast<char*>(block) + header;
+    }
+
+    void countedFree(void* memory, size_t alignment) {
+        if (memory == nullptr) return;
+        char* block = static_cast<char*>(memory) - max(kHeaderBytes, alignment);
+        gLiveBytes -= int64_t(*reinterpret_cast<size_t*>(block));
+        free(block);
+    }
+}
+
+void* operator new(size_t size) {
+    return countedAllocate(size, 0);
+}
+void* operator new[](size_t size) {
+    return countedAllocate(size, 0);
+}
+void* operator new(size_t size, align_val_t alignment) {
+    return countedAllocate(size, size_t(alignment));
+}
+void* operator new[](size_t size, align_val_t alignment) {
+    return countedAllocate(size, size_t(alignment));
+}
+void operator delete(void* memory) noexcept {
+    countedFree(memory, 0);
+}
+void operator delete[](void* memory) noexcept {
+    countedFree(memory, 0);
+}
+void operator delete(void* memory, size_t) noexcept {
+    countedFree(memory, 0);
+}
+void operator delete[](void* memory, size_t) noexcept {
+    countedFree(memory, 0);
+}
+void operator delete(void* memory, align_val_t alignment) noexcept {
+    countedFree(memory, size_t(alignment));
+}
+void operator delete[](void* memory, align_val_t alignment) noexcept {
+    countedFree(memory, size_t(alignment));
+}
+void operator delete(void* memory, size_t, align_val_t alignment) noexcept {
+    countedFree(memory, size_t(alignment));
+}
+void operator delete[](void* memory, size_t, align_val_t alignment) noexcept {
+    countedFree(memory, size_t(alignment));
+}
+
+/* * * * * Graph families * * * * */
+
+namespace {
+    struct Edge {
+        int u;
+        int v;
+        int weight;
+    };
+
+    struct Family {
+        string name;
+        int    maxNodes;   // Larger sizes would have too many links to be worth building.
+        function<vector<Edge>(int n, mt19937& generator)> edges;
+    };
+
+    /* Caterpillars and millipedes have a spine of segments with legs hanging off it.
+     * If n isn't a whole number of segments, the people left over have no links.
+     */
+    vector<Edge> legs(int n, int legsPerSegment) {
+        int segments = n / (legsPerSegment + 1);
+        vector<Edge> result;
+        for (int i = 0; i + 1 < segments; i++) {
+            result.push_back({ i, i + 1, 1 });
+        }
+        for (int leg = 1; leg <= legsPerSegment; leg++) {
+            for (int i = 0; i < segments; i++) {
+                result.push_back({ i, i + leg * segments, 1 });
+            }
+        }
+        return result;
+    }
+
+    /* Links between the first half and the second, each there with odds 1 in linkOdds,
+     * weighing from 1 to highestWeight.
+     */
+    vector<Edge> twoSidedEdges(int n, int linkOdds, int highestWeight, mt19937& generator) {
+        vector<Edge> result;
+        uniform_int_distribution<int> weight(1, highestWeight);
+        for (int u = 0; u < n / 2; u++) {
+            for (int v = n / 2; v < n; v++) {
+                if (generator() % linkOdds == 0) result.push_back({ u, v, weight(generator) });
+            }
+        }
+        return result;
+    }
+
+    /* About averageDegree links per person, between random people. If bipartite, links
+     * only ever join the first half to the second.
+     */
+    vector<Edge> randomEdges(int n, double averageDegree, bool bipartite, mt19937& generator) {
+        vector<Edge> result;
+        if (n < 2) return result;
+
+        size_t count = size_t(averageDegree * n / 2);
+        uniform_int_distribution<int> weight(1, 100);
+        for (size_t i = 0; i < count; i++) {
+            int u, v;
+            if (bipartite) {
+                u = int(generator() % (n / 2));
+                v = n / 2 + int(generator() % (n - n / 2));
+            } else {
+                u = int(generator() % n);
+                v = int(generator() % n);
+            }
+            if (u != v) result.push_back({ u, v, weight(generator) });
+        }
+        return result;
+    }
+
+    const vector<Family> kFamilies = {
+        { "chain", 100000, [](int n, mt19937&) {
+            vector<Edge> result;
+            for (int i = 0; i + 1 < n; i++) {
+                result.push_back({ i, i + 1, 1 });
+            }
+            return result;
+        }},
+        { "millipede", 100000, [](int n, mt19937&) {
+            return legs(n, 1);
+        }},
+        { "caterpillar", 100000, [](int n, mt19937&) {
+            return legs(n, 2);
+        }},
+        { "random", 100000, [](int n, mt19937& generator) {
+            return randomEdges(n, 8, false, generator);
+        }},
+        { "bipartite", 100000, [](int n, mt19937& generator) {
+            return randomEdges(n, 8, true, generator);
+        }},
+        { "dense", 1000, [](int n, mt19937& generator) {
+            vector<Edge> result;
+            uniform_int_distribution<int> weight(1, 100);
+            for (int u = 0; u < n; u++) {
+                for (int v = u + 1; v < n; v++) {
+                    if (generator() % 2 == 0) result.push_back({ u, v, weight(generator) });
+                }
+            }
+            return result;
+        }},
+        { "two-sided-dense", 1000, [](int n, mt19937& generator) {
+            return twoSidedEdges(n, 2, 100, generator);
+        }},
+        { "two-sided-ties", 1000, [](int n, mt19937& generator) {
+            return twoSidedEdges(n, 1, 1, generator);
+        }},
+    };
+
+    const vector<int> kSizes = { 10, 100, 1000, 10000, 100000 };
+
+    /* One family at one size, in every form the solvers take. */
+    struct Instance {
+        int                           numPeople;
+        size_t                        numLinks;
+        Map<string, Set<string>>      links;
+        Map<string, Map<string, int>> weightedLinks;
+        CompactGraph                  graph;
+        bool                          twoSided;
+        vector<char>                  side;   // If twoSided; see findBipartition.
+    };
+
+    Instance makeInstance(int n, const vector<Edge>& edges) {
+        Instance instance;
+        instance.numPeople = n;
+        for (int i = 0; i < n; i++) {
+            instance.links[to_string(i)];
+            instance.weightedLinks[to_string(i)];
+        }
+        for (const Edge& edge: edges) {
+            string u = to_string(edge.u), v = to_string(edge.v);
+            instance.links[u] += v;
+            instance.links[v] += u;
+            instance.weightedLinks[u][v] = edge.weight;
+            instance.weightedLinks[v][u] = edge.weight;
+        }
+        instance.graph = CompactGraph::fromWeightedLinks(instance.weightedLinks);
+        instance.numLinks = instance.graph.numLinks();
+        instance.twoSided = findBipartition(instance.graph, instance.side);
+        return instance;
+    }
+
+    /* * * * * Solvers * * * * */
+
+    struct Solver {
+        string name;
+        int    maxNodes;
+        bool   twoSided;   // Only for two-sided graphs.
+        /* Returns something derived from the answer, so the call can't be optimized away.
+         * Counts into stats unless it is nullptr.
+         */
+        function<size_t(const Instance&, SolverStats*)> run;
+    };
+
+    const vector<Solver> kSolvers = {
+        { "hasPerfectMatching", 100000, false, [](const Instance& instance, SolverStats* stats) {
+            Set<Pair> matching;
+            return size_t(hasPerfectMatching(instance.links, matching, stats)) + matching.size();
+        }},
+        { "maximumWeightMatching", 100000, false, [](const Instance& instance, SolverStats* stats) {
+            return size_t(maximumWeightMatching(instance.weightedLinks, stats).size());
+        }},
+        /* The same dispatch without the conversions to and from maps. */
+        { "maximumWeightMatchingById", 100000, false, [](const Instance& instance, SolverStats* stats) {
+            return maximumWeightMatchingById(instance.graph, stats).size();
+        }},
+        { "BlossomMatching", 100000, false, [](const Instance& instance, SolverStats* stats) {
+            BlossomMatching engine(instance.graph);
+            engine.setStats(stats);
+            return size_t(engine.maximumMatching());
+        }},
+        { "WeightedBlossomMatching", 100000, false, [](const Instance& instance, SolverStats* stats) {
+            WeightedBlossomMatching engine(instance.graph);
+            engine.setStats(stats);
+            return size_t(engine.solve());
+        }},
+        { "SmallGroupMatching", kSmallGroupAutoLimit, false, [](const Instance& instance, SolverStats* stats) {
+            SmallGroupMatching engine(instance.graph);
+            engine.setStats(stats);
+            return size_t(engine.solve());
+        }},
+        { "HopcroftKarpMatching", 100000, true, [](const Instance& instance, SolverStats* stats) {
+            HopcroftKarpMatching engine(instance.graph, instance.side);
+            engine.setStats(stats);
+            return size_t(engine.maximumMatching());
+        }},
+        { "BipartiteWeightedMatching", 100000, true, [](const Instance& instance, SolverStats* stats) {
+            BipartiteWeightedMatching engine(instance.graph, instance.side);
+            engine.setStats(stats);
+            return size_t(engine.solve());
+        }},
+        { "auction", 100000, true, [](const Instance& instance, SolverStats* stats) {
+            return size_t(auctionMaximumWeightMatchingById(instance.graph, instance.side, AuctionOptions(), stats).weight);
+        }},
+        /* The matrix has a weight for every possible pair, so only for small sizes. */
+        { "DenseMatching", 10000, true, [](const Instance& instance, SolverStats* stats) {
+            DenseMatching engine(instance.graph, instance.side);
+            engine.setStats(stats);
+            return size_t(engine.solve());
+        }},
+    };
+
+    /* * * * * Running * * * * */
+
+    struct Options {
+        string filter;
+        int    maxNodes = 100000;
+        double minTime = 0.5;
+        double maxSeconds = 10;
+    };
+
+    struct Result {
+        string   name;
+        string   solver;
+        string   family;
+        int      numPeople;
+        size_t   numLinks;
+        uint64_t iterations;
+        double   secondsPerIteration;
+        double   allocationsPerIteration;
+        double   bytesPerIteration;
+        int64_t  peakHeapBytes;   // Most extra heap in use at once during one call.
+        SolverStats stats;        // From one call; all zero unless built with MATCHING_STATS.
+    };
+
+    double secondsSince(chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    volatile size_t gSink;
+
+    Result measure(const Solver& solver, const string& family, const Instance& instance, const Options& options) {
+        Result result;
+        result.solver = solver.name;
+        result.family = family;
+        result.name = solver.name + "/" + family + "/" + to_string(instance.numPeople);
+        result.numPeople = instance.numPeople;
+        result.numLinks = instance.numLinks;
+
+        /* One call on its own first, for the peak, and to find out how long a call takes. */
+        int64_t liveBefore = gLiveBytes;
+        gPeakLiveBytes = liveBefore;
+        auto start = chrono::steady_clock::now();
+        gSink = solver.run(instance, nullptr);
+        double first = secondsSince(start);
+        result.peakHeapBytes = gPeakLiveBytes - liveBefore;
+
+        if (SolverStats::kEnabled) {
+            gSink = solver.run(instance, &result.stats);
+        }
+
+        /* Then as many as fit in the minimum time, unless one call already took that long. */
+        if (first >= options.minTime) {
+            result.iterations = 1;
+            result.secondsPerIteration = first;
+            uint64_t allocations = gAllocations, bytes = gBytesAllocated;
+            gSink = solver.run(instance, nullptr);
+            result.allocationsPerIteration = double(gAllocations - allocations);
+            result.bytesPerIteration = double(gBytesAllocated - bytes);
+            return result;
+        }
+
+        uint64_t allocations = gAllocations, bytes = gBytesAllocated;
+        uint64_t iterations = 0;
+        start = chrono::steady_clock::now();
+        double elapsed;
+        do {
+            gSink = solver.run(instance, nullptr);
+            iterations++;
+            elapsed = secondsSince(start);
+        } while (elapsed < options.minTime && iterations < 1000000);
+
+        result.iterations = iterations;
+        result.secondsPerIteration = elapsed / iterations;
+        result.allocationsPerIteration = double(gAllocations - allocations) / iterations;
+        result.bytesPerIteration = double(gBytesAllocated - bytes) / iterations;
+        return result;
+    }
+
+    long peakResidentKilobytes() {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;   // Bytes on macOS, kilobytes elsewhere.
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+
+    string jsonString(const string& text) {
+        ostringstream out;
+        out << '"';
+        for (char ch: text) {
+            if (ch == '"' || ch == '\\') out << '\\';
+            out << ch;
+        }
+        out << '"';
+        return out.str();
+    }
+
+    void writeJson(ostream& out, const vector<Result>& results) {
+        char date[64];
+        time_t now = time(nullptr);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+        out << "{\n";
+        out << "  \"context\": {\n";
+        out << "    \"date\": " << jsonString(date) << ",\n";
+        out << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n";
+        out << "    \"max_rss_kb\": " << peakResidentKilobytes() << "\n";
+        out << "  },\n";
+        out << "  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& result = results[i];
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    {\n";
+            out << "      \"name\": " << jsonString(result.name) << ",\n";
+            out << "      \"solver\": " << jsonString(result.solver) << ",\n";
+            out << "      \"family\": " << jsonString(result.family) << ",\n";
+            out << "      \"people\": " << result.numPeople << ",\n";
+            out << "      \"links\": " << result.numLinks << ",\n";
+            out << "      \"iterations\": " << result.iterations << ",\n";
+            out << "      \"real_time\": " << result.secondsPerIteration * 1e9 << ",\n";
+            out << "      \"time_unit\": \"ns\",\n";
+            out << "      \"allocations_per_iteration\": " << result.allocationsPerIteration << ",\n";
+            out << "      \"bytes_allocated_per_iteration\": " << result.bytesPerIteration << ",\n";
+            out << "      \"peak_heap_bytes\": " << result.peakHeapBytes;
+            if (SolverStats::kEnabled) {
+                for (const auto& entry: result.stats.entries()) {
+                    out << ",\n      " << jsonString(entry.first) << ": " << entry.second;
+                }
+            }
+            out << "\n";
+            out << "    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            auto value = [&](const string& flag) {
+                return arg.compare(0, flag.size(), flag) == 0 ? arg.substr(flag.size()) : string();
+            };
+            if (!value("--filter=").empty()) {
+                options.filter = value("--filter=");
+            } else if (!value("--max-nodes=").empty()) {
+                options.maxNodes = stoi(value("--max-nodes="));
+            } else if (!value("--min-time=").empty()) {
+                options.minTime = stod(value("--min-time="));
+            } else if (!value("--max-seconds=").empty()) {
+                options.maxSeconds = stod(value("--max-seconds="));
+            } else {
+                cerr << "Unknown option " << arg << endl;
+                exit(1);
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+    vector<Result> results;
+
+    cerr << left << setw(52) << "Benchmark" << right << setw(14) << "Time (us)" << setw(12) << "Iterations"
+         << setw(14) << "Allocs/iter" << setw(16) << "Peak heap (KB)" << endl;
+
+    for (const Family& family: kFamilies) {
+        vector<bool> tooSlow(kSolvers.size(), false);
+        for (size_t i = 0; i < kSizes.size(); i++) {
+            int n = kSizes[i];
+            if (n > options.maxNodes || n > family.maxNodes) continue;
+
+            /* Build each instance once, and only if some solver wants it. */
+            Instance instance;
+            bool built = false;
+            for (size_t s = 0; s < kSolvers.size(); s++) {
+                const Solver& solver = kSolvers[s];
+                string name = solver.name + "/" + family.name + "/" + to_string(n);
+                if (n > solver.maxNodes || name.find(options.filter) == string::npos) continue;
+                if (tooSlow[s]) {
+                    cerr << left << setw(52) << name << right << "   skipped: a smaller size was too slow" << endl;
+                    continue;
+                }
+
+                if (!built) {
+                    mt19937 generator(n);
+                    instance = makeInstance(n, family.edges(n, generator));
+                    built = true;
+                }
+                if (solver.twoSided && !instance.twoSided) continue;
+
+                Result result = measure(solver, family.name, instance, options);
+                results.push_back(result);
+                double scale = i + 1 < kSizes.size() ? double(kSizes[i + 1]) / n : 1;
+                tooSlow[s] = result.secondsPerIteration * scale * scale > options.maxSeconds;
+
+                cerr << left << setw(52) << result.name << right << fixed << setprecision(1)
+                     << setw(14) << result.secondsPerIteration * 1e6 << setw(12) << result.iterations
+                     << setw(14) << result.allocationsPerIteration
+                     << setw(16) << result.peakHeapBytes / 1024.0 << endl;
+            }
+        }
+    }
+
+    writeJson(cout, results);
+    return 0;
+}